@@ -0,0 +1,163 @@
+#include "asyncprojectmanager.h"
+#include <QThread>
+#include <QDebug>
+
+// === Constants ===
+namespace {
+const QString WORKER_CONNECTION_NAME = "project_db_worker";
+const QString WORKER_THREAD_NAME = "Catalog";
+}
+
+// === Constructor & Destructor ===
+
+AsyncProjectManager::AsyncProjectManager(ProjectManager *projectManager, QObject *parent)
+    : QObject(parent)
+    , m_projectManager(projectManager)
+    , m_worker(new ProjectManager(WORKER_CONNECTION_NAME))
+    , m_thread(new QThread(this))
+    , m_attachingPrimary(false)
+    , m_stopping(0)
+{
+    m_thread->setObjectName(WORKER_THREAD_NAME);
+    m_worker->moveToThread(m_thread);
+
+    // The worker closes its connection on its own thread when the thread ends
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &ProjectManager::syncCompleted, this, &AsyncProjectManager::syncCompleted);
+
+    if (m_projectManager) {
+        connect(m_projectManager, &ProjectManager::projectOpened,
+                this, &AsyncProjectManager::onProjectOpened);
+        connect(m_projectManager, &ProjectManager::projectClosed,
+                this, &AsyncProjectManager::onProjectClosed);
+    }
+
+    m_thread->start();
+
+    if (m_projectManager && m_projectManager->hasOpenProject()) {
+        onProjectOpened();
+    }
+}
+
+AsyncProjectManager::~AsyncProjectManager()
+{
+    // Running syncs poll this; queued calls are dropped with the event loop
+    m_stopping.storeRelaxed(1);
+    m_thread->quit();
+    m_thread->wait();
+}
+
+// === Project Operations ===
+
+QFuture<bool> AsyncProjectManager::openProject(const QString &projectPath)
+{
+    return invoke<bool>([projectPath](ProjectManager *worker, QPromise<bool> &) {
+        return worker->openProject(projectPath);
+    }).then(this, [this, projectPath](bool opened) {
+        if (!opened || !m_projectManager) {
+            return false;
+        }
+
+        // Schema work is done; attaching the primary is only a connection open
+        m_attachingPrimary = true;
+        const bool attached = m_projectManager->attachProject(projectPath);
+        m_attachingPrimary = false;
+        return attached;
+    });
+}
+
+void AsyncProjectManager::setThumbnailService(ThumbnailService *thumbnailService)
+{
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, thumbnailService]() {
+        worker->setThumbnailService(thumbnailService);
+    }, Qt::QueuedConnection);
+}
+
+// === Image Operations ===
+
+QFuture<QList<AsyncProjectManager::ImageRecord>> AsyncProjectManager::getImagesInFolder(
+    const QString &folderPath)
+{
+    return invoke<QList<ImageRecord>>([folderPath](ProjectManager *worker,
+                                                   QPromise<QList<ImageRecord>> &) {
+        return worker->getImagesInFolder(folderPath);
+    });
+}
+
+QFuture<QList<AsyncProjectManager::ImageRecord>> AsyncProjectManager::getAllImages()
+{
+    return invoke<QList<ImageRecord>>([](ProjectManager *worker, QPromise<QList<ImageRecord>> &) {
+        return worker->getAllImages();
+    });
+}
+
+QFuture<AsyncProjectManager::ImageRecord> AsyncProjectManager::getImageRecord(const QString &filePath)
+{
+    return invoke<ImageRecord>([filePath](ProjectManager *worker, QPromise<ImageRecord> &) {
+        return worker->getImageRecord(filePath);
+    });
+}
+
+QFuture<AsyncProjectManager::DuplicateFilePage> AsyncProjectManager::getDuplicateFiles(
+    const QString &afterHash, qint64 afterSize, int limit)
+{
+    return invoke<DuplicateFilePage>([afterHash, afterSize, limit](ProjectManager *worker,
+                                                                   QPromise<DuplicateFilePage> &) {
+        return worker->getDuplicateFiles(afterHash, afterSize, limit);
+    });
+}
+
+// === Synchronization ===
+
+QFuture<AsyncProjectManager::SyncResult> AsyncProjectManager::synchronizeProject()
+{
+    return invoke<SyncResult>([this](ProjectManager *worker, QPromise<SyncResult> &promise) {
+        // The worker emits progress on this thread, so forward it directly
+        const QMetaObject::Connection progress = QObject::connect(
+            worker, &ProjectManager::syncProgress, worker,
+            [&promise](int current, int total, const QString &currentFile) {
+                promise.setProgressRange(0, total);
+                promise.setProgressValueAndText(current, currentFile);
+            }, Qt::DirectConnection);
+
+        const SyncResult result = worker->synchronizeProject([this, &promise]() {
+            return promise.isCanceled() || m_stopping.loadRelaxed() != 0;
+        });
+
+        QObject::disconnect(progress);
+        return result;
+    });
+}
+
+// === Private Slots ===
+
+void AsyncProjectManager::onProjectOpened()
+{
+    if (m_attachingPrimary || !m_projectManager) {
+        return;
+    }
+
+    const QString projectPath = m_projectManager->currentProjectPath();
+    invoke<bool>([projectPath](ProjectManager *worker, QPromise<bool> &) {
+        if (worker->hasOpenProject() && worker->currentProjectPath() == projectPath) {
+            return true;
+        }
+
+        const bool opened = worker->openProject(projectPath);
+        if (!opened) {
+            qWarning() << "Catalog thread failed to open project:" << projectPath;
+        }
+        return opened;
+    });
+}
+
+void AsyncProjectManager::onProjectClosed()
+{
+    if (m_attachingPrimary) {
+        return;
+    }
+
+    invoke<bool>([](ProjectManager *worker, QPromise<bool> &) {
+        return worker->closeProject();
+    });
+}
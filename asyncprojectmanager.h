@@ -0,0 +1,221 @@
+#ifndef ASYNCPROJECTMANAGER_H
+#define ASYNCPROJECTMANAGER_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QPromise>
+#include <memory>
+#include <type_traits>
+#include "projectmanager.h"
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+class QThread;
+class ThumbnailService;
+
+/**
+ * @brief Non-blocking facade over the project catalog
+ *
+ * Owns a second ProjectManager with its own database connection, living on
+ * a dedicated catalog thread. Every call is queued to that thread and
+ * returns a QFuture, so UI code can chain catalog work with
+ * QFuture::then(this, ...) instead of blocking the event loop:
+ * - cancellation: QFuture::cancel() stops queued calls and a running sync
+ * - progress: synchronization reports progress range, value and the
+ *   current folder on its future (observe it with a QFutureWatcher)
+ * - coroutines: with C++20, co_await awaitFuture(future, context) resumes
+ *   the coroutine on the context's thread once the future finishes
+ *
+ * The facade follows the primary (GUI thread) project manager: the worker
+ * opens and closes the same project whenever the primary does.
+ */
+class AsyncProjectManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    using ImageRecord = ProjectManager::ImageRecord;
+    using SyncResult = ProjectManager::SyncResult;
+    using DuplicateFilePage = ProjectManager::DuplicateFilePage;
+
+    /**
+     * @brief Create the facade and its catalog thread
+     * @param projectManager Primary project manager to follow
+     * @param parent Parent object
+     */
+    explicit AsyncProjectManager(ProjectManager *projectManager, QObject *parent = nullptr);
+    ~AsyncProjectManager();
+
+    // === Project Operations ===
+
+    /**
+     * @brief Open a project without blocking the caller
+     *
+     * Validation and schema migration run on the catalog thread; the
+     * primary project manager then attaches on the GUI thread.
+     * @param projectPath Directory path containing project files
+     * @return Future with true if the project opened
+     */
+    QFuture<bool> openProject(const QString &projectPath);
+
+    /**
+     * @brief Attach the thumbnail service used by asynchronous ingestion
+     * @param thumbnailService Thumbnail service, or nullptr to disable
+     */
+    void setThumbnailService(ThumbnailService *thumbnailService);
+
+    // === Image Operations ===
+
+    /**
+     * @brief Get all images in a folder
+     * @param folderPath Path to folder
+     * @return Future with the image records
+     */
+    QFuture<QList<ImageRecord>> getImagesInFolder(const QString &folderPath);
+
+    /**
+     * @brief Get all images in the project
+     * @return Future with the image records
+     */
+    QFuture<QList<ImageRecord>> getAllImages();
+
+    /**
+     * @brief Get the record of one image
+     * @param filePath Path to image file
+     * @return Future with the record (empty if not found)
+     */
+    QFuture<ImageRecord> getImageRecord(const QString &filePath);
+
+    /**
+     * @brief Get a page of exact duplicate files from the catalog
+     * @param afterHash lastHash of the previous page (empty for the first page)
+     * @param afterSize lastSize of the previous page
+     * @param limit Maximum number of catalog groups to examine
+     * @return Future with the page
+     */
+    QFuture<DuplicateFilePage> getDuplicateFiles(const QString &afterHash, qint64 afterSize, int limit);
+
+    // === Synchronization ===
+
+    /**
+     * @brief Synchronize the project with the filesystem
+     *
+     * Progress range and value count scanned folders; progress text is the
+     * folder being scanned. Canceling the future stops the sync at the next
+     * folder or file.
+     * @return Future with the synchronization results
+     */
+    QFuture<SyncResult> synchronizeProject();
+
+#if defined(__cpp_impl_coroutine)
+    /**
+     * @brief Awaiter resuming a coroutine when a future finishes
+     *
+     * The coroutine is never resumed if the context is destroyed first.
+     */
+    template <typename T>
+    class FutureAwaiter
+    {
+    public:
+        FutureAwaiter(QFuture<T> future, QObject *context)
+            : m_future(std::move(future)), m_context(context) {}
+
+        bool await_ready() const { return m_future.isFinished(); }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            // Resumed on the context's thread; finished is also emitted on
+            // cancel, and right away for a future that finished meanwhile
+            auto *watcher = new QFutureWatcher<T>(m_context);
+            QObject::connect(watcher, &QFutureWatcherBase::finished, watcher, [watcher, handle]() {
+                watcher->deleteLater();
+                handle.resume();
+            });
+            watcher->setFuture(m_future);
+        }
+
+        T await_resume() const
+        {
+            if constexpr (!std::is_void_v<T>) {
+                return (m_future.isCanceled() || m_future.resultCount() == 0) ? T() : m_future.result();
+            }
+        }
+
+    private:
+        QFuture<T> m_future;
+        QObject *m_context;
+    };
+
+    /**
+     * @brief Make a future awaitable from a C++20 coroutine
+     * @param future Future to await
+     * @param context Object whose thread resumes the coroutine
+     * @return Awaiter yielding the result (default value if canceled)
+     */
+    template <typename T>
+    static FutureAwaiter<T> awaitFuture(QFuture<T> future, QObject *context)
+    {
+        return FutureAwaiter<T>(std::move(future), context);
+    }
+#endif
+
+signals:
+    /**
+     * @brief Emitted on the GUI thread when an asynchronous sync completes
+     * @param result Synchronization results
+     */
+    void syncCompleted(const ProjectManager::SyncResult &result);
+
+private slots:
+    /**
+     * @brief Open the primary's project on the worker connection
+     */
+    void onProjectOpened();
+
+    /**
+     * @brief Close the worker connection with the primary's project
+     */
+    void onProjectClosed();
+
+private:
+    /**
+     * @brief Queue a call on the catalog thread
+     * @param function Called as function(worker, promise) on the catalog thread
+     * @return Future receiving the function's result
+     */
+    template <typename T, typename Function>
+    QFuture<T> invoke(Function function);
+
+    QPointer<ProjectManager> m_projectManager; ///< Primary project manager (GUI thread)
+    ProjectManager *m_worker;                  ///< Project manager on the catalog thread
+    QThread *m_thread;                         ///< Catalog thread
+    bool m_attachingPrimary;                   ///< Primary is opening a project the worker already has
+    QAtomicInt m_stopping;                     ///< Set on destruction to end running syncs
+};
+
+// === Template Implementation ===
+
+template <typename T, typename Function>
+QFuture<T> AsyncProjectManager::invoke(Function function)
+{
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+
+    QMetaObject::invokeMethod(m_worker, [worker = m_worker, promise, function]() {
+        // Calls canceled while still queued never touch the catalog
+        if (!promise->isCanceled()) {
+            promise->addResult(function(worker, *promise));
+        }
+        promise->finish();
+    }, Qt::QueuedConnection);
+
+    return future;
+}
+
+#endif // ASYNCPROJECTMANAGER_H
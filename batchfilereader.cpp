@@ -0,0 +1,798 @@
+#include "batchfilereader.h"
+#include "pagecacheadvisor.h"
+#include "ioconcurrencycontroller.h"
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QFile>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+#if defined(Q_OS_LINUX) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <vector>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define PHOTOMANAGER_HAS_IO_URING 1
+#endif
+#endif
+
+// === Constants ===
+namespace {
+constexpr int RING_BUFFER_SIZE = 128 * 1024;   // One registered buffer per queue slot
+constexpr int POOL_READ_CHUNK = 1024 * 1024;   // Chunk size of blocking reads
+constexpr int POOL_MAX_THREADS = 16;
+constexpr int MIN_QUEUE_DEPTH = 4;
+constexpr int MAX_QUEUE_DEPTH = 256;
+constexpr int SUB_BATCH_PER_SLOT = 4;          // Jobs per sub-batch for each request in flight
+constexpr int MIN_SUB_BATCH = 32;              // Re-read the volume's limit at most this often
+
+/**
+ * @brief Sort key of a job in physical issue order
+ */
+struct PhysicalKey {
+    int sweep;                       // 0 = reads from the start, 1 = reads from the end
+    quint64 device;
+    quint64 position;                // Physical byte offset, or inode if unknown
+    int index;
+
+    bool operator<(const PhysicalKey &other) const
+    {
+        if (sweep != other.sweep) {
+            return sweep < other.sweep;
+        }
+        if (device != other.device) {
+            return device < other.device;
+        }
+        if (position != other.position) {
+            return position < other.position;
+        }
+        return index < other.index;
+    }
+};
+
+#ifdef Q_OS_LINUX
+/**
+ * @brief Map a logical file offset to its physical disk offset
+ * @return True if the filesystem reported a mapped extent
+ */
+bool physicalOffset(int fd, quint64 logical, quint64 &physical)
+{
+    // fiemap ends in a flexible array; room for exactly one extent
+    alignas(struct fiemap) char buffer[sizeof(struct fiemap) + sizeof(struct fiemap_extent)];
+    memset(buffer, 0, sizeof(buffer));
+
+    struct fiemap *map = reinterpret_cast<struct fiemap *>(buffer);
+    map->fm_start = logical;
+    map->fm_length = 1;
+    map->fm_extent_count = 1;
+
+    if (ioctl(fd, FS_IOC_FIEMAP, map) != 0 || map->fm_mapped_extents == 0) {
+        return false;
+    }
+
+    const fiemap_extent &extent = map->fm_extents[0];
+    physical = extent.fe_physical + (logical - qMin<quint64>(logical, extent.fe_logical));
+    return true;
+}
+#endif
+}
+
+// === io_uring Queue ===
+
+#ifdef PHOTOMANAGER_HAS_IO_URING
+
+namespace {
+int ioUringSetup(unsigned entries, io_uring_params *params)
+{
+    return int(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return int(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int ringFd, unsigned opcode, const void *arg, unsigned argCount)
+{
+    return int(syscall(__NR_io_uring_register, ringFd, opcode, arg, argCount));
+}
+}
+
+/**
+ * @brief Minimal io_uring submission/completion queue for positional reads
+ *
+ * Talks to the kernel through the raw system calls so no liburing is
+ * needed. Each queue slot owns one buffer, registered with the kernel
+ * when allowed (READ_FIXED), otherwise used through READV.
+ */
+class IoUringQueue
+{
+public:
+    IoUringQueue() = default;
+
+    ~IoUringQueue()
+    {
+        // Closing the ring first cancels what is still pending in the kernel
+        if (m_ringFd >= 0) {
+            close(m_ringFd);
+        }
+        if (m_buffers) {
+            munmap(m_buffers, m_buffersSize);
+        }
+        if (m_sqes) {
+            munmap(m_sqes, m_sqesSize);
+        }
+        if (m_cqRing && m_cqRing != m_sqRing) {
+            munmap(m_cqRing, m_cqRingSize);
+        }
+        if (m_sqRing) {
+            munmap(m_sqRing, m_sqRingSize);
+        }
+    }
+
+    bool initialize(unsigned entries, unsigned bufferSize)
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+
+        m_ringFd = ioUringSetup(entries, &params);
+        if (m_ringFd < 0) {
+            return false;
+        }
+
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap) {
+            m_sqRingSize = m_cqRingSize = qMax(m_sqRingSize, m_cqRingSize);
+        }
+
+        m_sqRing = mapRing(m_sqRingSize, IORING_OFF_SQ_RING);
+        m_cqRing = singleMmap ? m_sqRing : mapRing(m_cqRingSize, IORING_OFF_CQ_RING);
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = static_cast<io_uring_sqe *>(mapRing(m_sqesSize, IORING_OFF_SQES));
+        if (!m_sqRing || !m_cqRing || !m_sqes) {
+            return false;
+        }
+
+        char *sq = static_cast<char *>(m_sqRing);
+        m_sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        m_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+        char *cq = static_cast<char *>(m_cqRing);
+        m_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        m_entries = params.sq_entries;
+        m_bufferSize = bufferSize;
+        m_buffersSize = size_t(m_entries) * bufferSize;
+        void *buffers = mmap(nullptr, m_buffersSize, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buffers == MAP_FAILED) {
+            return false;
+        }
+        m_buffers = static_cast<char *>(buffers);
+
+        m_iovecs.resize(m_entries);
+        for (unsigned i = 0; i < m_entries; ++i) {
+            m_iovecs[i].iov_base = buffer(i);
+            m_iovecs[i].iov_len = m_bufferSize;
+        }
+
+        // Registration pins the buffers; it can fail under a low RLIMIT_MEMLOCK
+        m_fixedBuffers = ioUringRegister(m_ringFd, IORING_REGISTER_BUFFERS,
+                                         m_iovecs.data(), m_entries) == 0;
+        return true;
+    }
+
+    unsigned depth() const { return m_entries; }
+    unsigned bufferSize() const { return m_bufferSize; }
+    char *buffer(unsigned index) const { return m_buffers + size_t(index) * m_bufferSize; }
+
+    bool queueRead(int fd, unsigned bufferIndex, quint64 offset, unsigned length, quint64 userData)
+    {
+        const unsigned tail = *m_sqTail;
+        const unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+        if (tail - head >= m_entries) {
+            return false;
+        }
+
+        const unsigned index = tail & m_sqMask;
+        io_uring_sqe *sqe = &m_sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+
+        if (m_fixedBuffers) {
+            sqe->opcode = IORING_OP_READ_FIXED;
+            sqe->addr = reinterpret_cast<quint64>(buffer(bufferIndex));
+            sqe->len = length;
+            sqe->buf_index = quint16(bufferIndex);
+        } else {
+            m_iovecs[bufferIndex].iov_len = length;
+            sqe->opcode = IORING_OP_READV;
+            sqe->addr = reinterpret_cast<quint64>(&m_iovecs[bufferIndex]);
+            sqe->len = 1;
+        }
+        sqe->fd = fd;
+        sqe->off = offset;
+        sqe->user_data = userData;
+
+        m_sqArray[index] = index;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+        m_toSubmit++;
+        return true;
+    }
+
+    int submitAndWait(unsigned minComplete)
+    {
+        int submitted;
+        do {
+            submitted = ioUringEnter(m_ringFd, m_toSubmit, minComplete, IORING_ENTER_GETEVENTS);
+        } while (submitted < 0 && errno == EINTR);
+
+        if (submitted < 0) {
+            return -errno;
+        }
+
+        m_toSubmit -= qMin(unsigned(submitted), m_toSubmit);
+        return submitted;
+    }
+
+    bool nextCompletion(quint64 &userData, int &result)
+    {
+        const unsigned head = *m_cqHead;
+        if (head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+
+        const io_uring_cqe &cqe = m_cqes[head & m_cqMask];
+        userData = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void *mapRing(size_t size, qint64 offset) const
+    {
+        void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         m_ringFd, offset);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    int m_ringFd = -1;
+    void *m_sqRing = nullptr;
+    void *m_cqRing = nullptr;
+    size_t m_sqRingSize = 0;
+    size_t m_cqRingSize = 0;
+    io_uring_sqe *m_sqes = nullptr;
+    size_t m_sqesSize = 0;
+
+    unsigned *m_sqHead = nullptr;
+    unsigned *m_sqTail = nullptr;
+    unsigned *m_sqArray = nullptr;
+    unsigned m_sqMask = 0;
+    unsigned *m_cqHead = nullptr;
+    unsigned *m_cqTail = nullptr;
+    unsigned m_cqMask = 0;
+    io_uring_cqe *m_cqes = nullptr;
+
+    unsigned m_entries = 0;
+    unsigned m_toSubmit = 0;
+    unsigned m_bufferSize = 0;
+    char *m_buffers = nullptr;
+    size_t m_buffersSize = 0;
+    std::vector<iovec> m_iovecs;
+    bool m_fixedBuffers = false;
+};
+
+#else
+
+class IoUringQueue
+{
+};
+
+#endif
+
+// === Constructor & Destructor ===
+
+BatchFileReader::BatchFileReader(Backend backend, int queueDepth)
+    : m_requestedBackend(backend)
+    , m_queueDepth(qBound(MIN_QUEUE_DEPTH, queueDepth, MAX_QUEUE_DEPTH))
+    , m_ring(nullptr)
+    , m_ringFailed(false)
+    , m_ordering(Ordering::Auto)
+    , m_dropBehind(true)
+{
+    m_pool.setMaxThreadCount(qMin(m_queueDepth, POOL_MAX_THREADS));
+}
+
+BatchFileReader::~BatchFileReader()
+{
+    delete m_ring;
+}
+
+// === Reading ===
+
+QList<BatchFileReader::ReadResult> BatchFileReader::read(const QList<ReadRequest> &requests)
+{
+    QList<Job> jobs;
+    jobs.reserve(requests.size());
+    for (const ReadRequest &request : requests) {
+        Job job;
+        job.filePath = request.filePath;
+        job.requestOffset = request.offset;
+        job.requestLength = qMax<qint64>(0, request.length);
+        jobs.append(job);
+    }
+
+    runJobs(jobs);
+
+    QList<ReadResult> results;
+    results.reserve(jobs.size());
+    for (const Job &job : std::as_const(jobs)) {
+        ReadResult result;
+        result.data = job.data;
+        result.fileSize = job.fileSize;
+        result.ok = job.ok;
+        results.append(result);
+    }
+    return results;
+}
+
+QStringList BatchFileReader::hashFiles(const QStringList &filePaths)
+{
+    QList<QCryptographicHash *> hashes;
+    QList<Job> jobs;
+    jobs.reserve(filePaths.size());
+    for (const QString &filePath : filePaths) {
+        Job job;
+        job.filePath = filePath;
+        job.requestLength = -1;
+        job.hash = new QCryptographicHash(QCryptographicHash::Md5);
+        job.dropBehind = m_dropBehind;
+        hashes.append(job.hash);
+        jobs.append(job);
+    }
+
+    runJobs(jobs);
+
+    QStringList results;
+    results.reserve(jobs.size());
+    for (const Job &job : std::as_const(jobs)) {
+        results.append(job.ok ? QString(job.hash->result().toHex()) : QString());
+    }
+
+    qDeleteAll(hashes);
+    return results;
+}
+
+// === Information ===
+
+BatchFileReader::Backend BatchFileReader::activeBackend() const
+{
+    if (m_requestedBackend == Backend::ThreadPool || m_ringFailed) {
+        return Backend::ThreadPool;
+    }
+    return isIoUringAvailable() ? Backend::IoUring : Backend::ThreadPool;
+}
+
+bool BatchFileReader::isIoUringAvailable()
+{
+#ifdef PHOTOMANAGER_HAS_IO_URING
+    static const bool available = []() {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        const int ringFd = ioUringSetup(1, &params);
+        if (ringFd < 0) {
+            return false;
+        }
+        close(ringFd);
+        return true;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+// === Private Methods ===
+
+void BatchFileReader::runJobs(QList<Job> &jobs)
+{
+    if (jobs.isEmpty()) {
+        return;
+    }
+
+    QList<int> order = physicalOrder(jobs);
+    if (order.isEmpty()) {
+        order.reserve(jobs.size());
+        for (int i = 0; i < jobs.size(); ++i) {
+            order.append(i);
+        }
+    }
+
+    // Split by volume (keeping issue order) so each gets its own concurrency
+    IoConcurrencyController *controller = IoConcurrencyController::instance();
+    QStringList volumes;
+    QHash<QString, QList<int>> volumeJobs;
+    for (int index : std::as_const(order)) {
+        Job &job = jobs[index];
+        job.volume = controller->volumeFor(job.filePath);
+        if (!volumeJobs.contains(job.volume)) {
+            volumes.append(job.volume);
+        }
+        volumeJobs[job.volume].append(index);
+    }
+
+    for (const QString &volume : std::as_const(volumes)) {
+        const QList<int> &indices = volumeJobs[volume];
+
+        // Sub-batches let the limit adapt while a large batch is running
+        int start = 0;
+        while (start < indices.size()) {
+            const int concurrency = qMin(m_queueDepth, controller->concurrency(
+                                             volume, IoConcurrencyController::Channel::Chunks));
+            const int count = qMin<int>(indices.size() - start,
+                                        qMax(MIN_SUB_BATCH, concurrency * SUB_BATCH_PER_SLOT));
+
+            QList<Job> batch;
+            batch.reserve(count);
+            for (int i = start; i < start + count; ++i) {
+                batch.append(jobs.at(indices.at(i)));
+            }
+
+            runJobsInOrder(batch, concurrency);
+
+            for (int i = 0; i < count; ++i) {
+                jobs[indices.at(start + i)] = batch.at(i);
+            }
+            start += count;
+        }
+    }
+}
+
+void BatchFileReader::runJobsInOrder(QList<Job> &jobs, int concurrency)
+{
+    if (activeBackend() == Backend::IoUring && runJobsOnRing(jobs, concurrency)) {
+        return;
+    }
+
+    runJobsOnPool(jobs, concurrency);
+}
+
+QList<int> BatchFileReader::physicalOrder(const QList<Job> &jobs)
+{
+#ifdef Q_OS_LINUX
+    if (m_ordering == Ordering::Submitted || jobs.size() < 2) {
+        return QList<int>();
+    }
+
+    QList<PhysicalKey> keys;
+    keys.reserve(jobs.size());
+    bool anyRotational = false;
+
+    for (int i = 0; i < jobs.size(); ++i) {
+        const Job &job = jobs.at(i);
+        PhysicalKey key = {job.requestOffset < 0 ? 1 : 0, 0, 0, i};
+
+        const QByteArray path = QFile::encodeName(job.filePath);
+        struct stat fileStat;
+        if (stat(path.constData(), &fileStat) == 0) {
+            key.device = fileStat.st_dev;
+            key.position = fileStat.st_ino;
+
+            const bool rotational = PageCacheAdvisor::isRotationalDevice(fileStat.st_dev);
+            anyRotational = anyRotational || rotational;
+
+            // Extent lookups only pay off where seeks are expensive
+            if (rotational || m_ordering == Ordering::Physical) {
+                const qint64 start = job.requestOffset < 0
+                    ? qMax<qint64>(0, fileStat.st_size + job.requestOffset)
+                    : job.requestOffset;
+                const int fd = open(path.constData(), O_RDONLY | O_CLOEXEC);
+                quint64 physical = 0;
+                if (fd >= 0 && physicalOffset(fd, quint64(start), physical)) {
+                    key.position = physical;
+                }
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+        }
+
+        keys.append(key);
+    }
+
+    if (m_ordering == Ordering::Auto && !anyRotational) {
+        return QList<int>();
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    QList<int> order;
+    order.reserve(keys.size());
+    for (const PhysicalKey &key : std::as_const(keys)) {
+        order.append(key.index);
+    }
+    return order;
+#else
+    Q_UNUSED(jobs);
+    return QList<int>();
+#endif
+}
+
+void BatchFileReader::runJobsOnPool(QList<Job> &jobs, int concurrency)
+{
+    const int threads = qBound(1, concurrency, POOL_MAX_THREADS);
+    for (Job &job : jobs) {
+        job.concurrency = threads;
+    }
+
+    m_pool.setMaxThreadCount(threads);
+    QtConcurrent::blockingMap(&m_pool, jobs, &BatchFileReader::runJobBlocking);
+}
+
+bool BatchFileReader::runJobsOnRing(QList<Job> &jobs, int concurrency)
+{
+#ifdef PHOTOMANAGER_HAS_IO_URING
+    if (!ensureRing()) {
+        return false;
+    }
+
+    IoConcurrencyController *controller = IoConcurrencyController::instance();
+    const unsigned slots = qMin<unsigned>(qMin<unsigned>(m_ring->depth(), unsigned(qMax(1, concurrency))),
+                                          unsigned(jobs.size()));
+    QList<int> slotJobs(slots, -1);
+    QList<qint64> slotIssued(slots, 0);
+    QElapsedTimer clock;
+    clock.start();
+    int nextJob = 0;
+    int activeSlots = 0;
+    int inFlight = 0;                // Reads queued and not yet completed
+
+    auto queueChunk = [&](unsigned slot) {
+        Job &job = jobs[slotJobs[slot]];
+        const unsigned length = unsigned(qMin<qint64>(job.remaining, m_ring->bufferSize()));
+        slotIssued[slot] = clock.nsecsElapsed();
+        const bool queued = m_ring->queueRead(job.fd, slot, quint64(job.offset), length, slot);
+        if (queued) {
+            inFlight++;
+        }
+        return queued;
+    };
+
+    // Open the next readable job and queue its first chunk in the slot
+    auto startNextJob = [&](unsigned slot) {
+        while (nextJob < jobs.size()) {
+            const int jobIndex = nextJob++;
+            Job &job = jobs[jobIndex];
+
+            job.fd = open(QFile::encodeName(job.filePath).constData(), O_RDONLY | O_CLOEXEC);
+            if (job.fd < 0) {
+                continue;
+            }
+
+            struct stat fileStat;
+            if (fstat(job.fd, &fileStat) != 0) {
+                close(job.fd);
+                job.fd = -1;
+                continue;
+            }
+
+            job.fileSize = fileStat.st_size;
+            resolveRange(job);
+            if (job.remaining <= 0) {
+                job.ok = true;
+                close(job.fd);
+                job.fd = -1;
+                continue;
+            }
+
+            if (job.dropBehind) {
+                job.advisor = new PageCacheAdvisor(job.fd, job.offset);
+            }
+
+            slotJobs[slot] = jobIndex;
+            return queueChunk(slot);
+        }
+        return false;
+    };
+
+    for (unsigned slot = 0; slot < slots && startNextJob(slot); ++slot) {
+        activeSlots++;
+    }
+
+    bool ringFailed = false;
+    while (activeSlots > 0 && !ringFailed) {
+        if (m_ring->submitAndWait(1) < 0) {
+            ringFailed = true;
+            break;
+        }
+
+        quint64 userData = 0;
+        int result = 0;
+        while (m_ring->nextCompletion(userData, result)) {
+            inFlight--;
+            const unsigned slot = unsigned(userData);
+            Job &job = jobs[slotJobs[slot]];
+
+            if (result == -EINTR || result == -EAGAIN) {
+                queueChunk(slot);
+                continue;
+            }
+
+            bool finished = result <= 0; // Error or unexpected end of file
+            if (result > 0) {
+                controller->recordCompletion(job.volume, IoConcurrencyController::Channel::Chunks,
+                                             result, clock.nsecsElapsed() - slotIssued[slot],
+                                             activeSlots);
+                consumeChunk(job, m_ring->buffer(slot), result);
+                job.offset += result;
+                job.remaining -= result;
+                if (job.advisor) {
+                    job.advisor->advance(job.offset);
+                }
+                if (job.remaining <= 0) {
+                    job.ok = true;
+                    finished = true;
+                } else {
+                    queueChunk(slot);
+                }
+            }
+
+            if (finished) {
+                delete job.advisor;
+                job.advisor = nullptr;
+                close(job.fd);
+                job.fd = -1;
+                slotJobs[slot] = -1;
+                if (!startNextJob(slot)) {
+                    activeSlots--;
+                }
+            }
+        }
+    }
+
+    if (!ringFailed) {
+        return true;
+    }
+
+    // Ring unusable. Queued reads still target the slot buffers and the
+    // jobs' descriptors: reap those that complete, then drop the ring so the
+    // kernel cancels the rest, and only then close the files.
+    qWarning() << "io_uring read failed, falling back to thread pool";
+    m_ringFailed = true;
+    quint64 userData = 0;
+    int result = 0;
+    while (inFlight > 0 && m_ring->submitAndWait(1) >= 0) {
+        while (m_ring->nextCompletion(userData, result)) {
+            inFlight--;
+        }
+    }
+    delete m_ring;
+    m_ring = nullptr;
+
+    // Reset every job so the pool can redo the batch
+    for (Job &job : jobs) {
+        delete job.advisor;
+        job.advisor = nullptr;
+        if (job.fd >= 0) {
+            close(job.fd);
+        }
+        job.fd = -1;
+        job.fileSize = -1;
+        job.data.clear();
+        job.ok = false;
+        if (job.hash) {
+            job.hash->reset();
+        }
+    }
+    return false;
+#else
+    Q_UNUSED(jobs);
+    return false;
+#endif
+}
+
+void BatchFileReader::runJobBlocking(Job &job)
+{
+    QFile file(job.filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    job.fileSize = file.size();
+    resolveRange(job);
+    if (job.remaining > 0 && !file.seek(job.offset)) {
+        return;
+    }
+
+    IoConcurrencyController *controller = IoConcurrencyController::instance();
+    PageCacheAdvisor advisor(job.dropBehind ? file.handle() : -1, job.offset);
+    QElapsedTimer timer;
+    while (job.remaining > 0) {
+        timer.start();
+        const QByteArray chunk = file.read(qMin<qint64>(job.remaining, POOL_READ_CHUNK));
+        if (chunk.isEmpty()) {
+            return;
+        }
+        controller->recordCompletion(job.volume, IoConcurrencyController::Channel::Chunks,
+                                     chunk.size(), timer.nsecsElapsed(), job.concurrency);
+        consumeChunk(job, chunk.constData(), chunk.size());
+        job.offset += chunk.size();
+        job.remaining -= chunk.size();
+        advisor.advance(job.offset);
+    }
+
+    job.ok = true;
+}
+
+void BatchFileReader::resolveRange(Job &job)
+{
+    if (job.requestLength < 0) {
+        job.offset = 0;
+        job.remaining = job.fileSize;
+        return;
+    }
+
+    const qint64 start = job.requestOffset < 0 ? job.fileSize + job.requestOffset
+                                               : job.requestOffset;
+    job.offset = qBound<qint64>(0, start, job.fileSize);
+    job.remaining = qMin(job.requestLength, job.fileSize - job.offset);
+
+    if (!job.hash) {
+        job.data.reserve(job.remaining);
+    }
+}
+
+void BatchFileReader::consumeChunk(Job &job, const char *data, qint64 size)
+{
+    if (job.hash) {
+        job.hash->addData(QByteArrayView(data, size));
+    } else {
+        job.data.append(data, size);
+    }
+}
+
+bool BatchFileReader::ensureRing()
+{
+#ifdef PHOTOMANAGER_HAS_IO_URING
+    if (m_ring) {
+        return true;
+    }
+    if (m_ringFailed) {
+        return false;
+    }
+
+    m_ring = new IoUringQueue;
+    if (!m_ring->initialize(unsigned(m_queueDepth), RING_BUFFER_SIZE)) {
+        qWarning() << "io_uring setup failed, using thread pool reads";
+        delete m_ring;
+        m_ring = nullptr;
+        m_ringFailed = true;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
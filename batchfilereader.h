@@ -0,0 +1,220 @@
+#ifndef BATCHFILEREADER_H
+#define BATCHFILEREADER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+class QCryptographicHash;
+class IoUringQueue;
+class PageCacheAdvisor;
+
+/**
+ * @brief Reads many files with many requests in flight
+ *
+ * Batches the small reads of hashing and header probing so that the
+ * device sees a deep queue instead of one blocking request per thread:
+ * - io_uring backend (Linux): one ring, registered buffers, up to
+ *   queueDepth reads outstanding from a single thread
+ * - Thread-pool backend: blocking QFile reads on a pool of workers, used
+ *   where io_uring is unavailable (other platforms, old kernels, seccomp)
+ *
+ * On rotational disks the batch is issued in physical order: requests
+ * are sorted by (device, physical extent from FIEMAP, or inode), with
+ * head reads and tail reads in separate sweeps, so the disk head moves
+ * across the platter once per sweep instead of seeking for every file.
+ *
+ * Whole-file reads (hashFiles) drop their pages from the page cache behind
+ * the read cursor, so a bulk hash of the library does not evict the
+ * catalog database and thumbnail cache (see PageCacheAdvisor).
+ *
+ * Batches are split per volume; the number of reads in flight on each
+ * follows the adaptive limit of IoConcurrencyController, and every
+ * completed read is reported back to it.
+ *
+ * Not thread-safe; use one reader per thread.
+ */
+class BatchFileReader
+{
+public:
+    /**
+     * @brief I/O backend selection
+     */
+    enum class Backend {
+        Auto,                        ///< io_uring if available, else thread pool
+        ThreadPool,                  ///< Blocking reads on worker threads
+        IoUring                      ///< Linux io_uring (falls back if unavailable)
+    };
+
+    /**
+     * @brief Order in which a batch is issued
+     */
+    enum class Ordering {
+        Submitted,                   ///< Keep the caller's order
+        Physical,                    ///< Always sort by on-disk position
+        Auto                         ///< Physical order for files on rotational devices
+    };
+
+    /**
+     * @brief A byte range to read from a file
+     */
+    struct ReadRequest {
+        QString filePath;            ///< File to read
+        qint64 offset = 0;           ///< Start offset; negative counts back from end of file
+        qint64 length = 0;           ///< Bytes to read (clamped to the file size)
+    };
+
+    /**
+     * @brief Result of a read request
+     */
+    struct ReadResult {
+        QByteArray data;             ///< Bytes read
+        qint64 fileSize = -1;        ///< Size of the file, -1 if it could not be opened
+        bool ok = false;             ///< True if the requested range was read
+    };
+
+    explicit BatchFileReader(Backend backend = Backend::Auto, int queueDepth = 64);
+    ~BatchFileReader();
+
+    BatchFileReader(const BatchFileReader &) = delete;
+    BatchFileReader &operator=(const BatchFileReader &) = delete;
+
+    // === Reading ===
+
+    /**
+     * @brief Read a batch of byte ranges
+     * @param requests Ranges to read
+     * @return Results in request order
+     */
+    QList<ReadResult> read(const QList<ReadRequest> &requests);
+
+    /**
+     * @brief Calculate MD5 hashes of whole files
+     * @param filePaths Files to hash
+     * @return Hex hashes in input order (empty string for unreadable files)
+     */
+    QStringList hashFiles(const QStringList &filePaths);
+
+    // === Configuration ===
+
+    /**
+     * @brief Set the issue order of batches
+     * @param ordering Ordering mode (default: Auto)
+     */
+    void setOrdering(Ordering ordering) { m_ordering = ordering; }
+
+    /**
+     * @brief Set whether whole-file reads bypass the page cache
+     * @param enabled Drop pages behind the read cursor (default: true)
+     */
+    void setDropBehind(bool enabled) { m_dropBehind = enabled; }
+
+    // === Information ===
+
+    /**
+     * @brief Get the backend actually in use
+     * @return ThreadPool or IoUring
+     */
+    Backend activeBackend() const;
+
+    /**
+     * @brief Check if the running kernel accepts io_uring
+     * @return True if an io_uring instance can be created
+     */
+    static bool isIoUringAvailable();
+
+private:
+    /**
+     * @brief State of one file being read
+     */
+    struct Job {
+        QString filePath;            ///< File to read
+        qint64 requestOffset = 0;    ///< Requested offset (negative: from end)
+        qint64 requestLength = 0;    ///< Requested length, -1 for the whole file
+        QCryptographicHash *hash = nullptr; ///< Receives data instead of @c data if set
+        bool dropBehind = false;     ///< Drop cached pages behind the read cursor
+        QString volume;              ///< Mount point (IoConcurrencyController key)
+        int concurrency = 1;         ///< Reads in flight alongside this one (thread pool)
+
+        int fd = -1;                 ///< Open descriptor (io_uring backend)
+        PageCacheAdvisor *advisor = nullptr; ///< Cache advice while @c fd is open
+        qint64 fileSize = -1;        ///< File size once opened
+        qint64 offset = 0;           ///< Next offset to read
+        qint64 remaining = 0;        ///< Bytes still to read
+        QByteArray data;             ///< Accumulated bytes
+        bool ok = false;             ///< True once the range was fully read
+    };
+
+    /**
+     * @brief Run jobs on the active backend
+     * @param jobs Jobs to complete
+     */
+    void runJobs(QList<Job> &jobs);
+
+    /**
+     * @brief Run jobs on the active backend in the caller's order
+     * @param jobs Jobs to complete
+     * @param concurrency Reads to keep in flight
+     */
+    void runJobsInOrder(QList<Job> &jobs, int concurrency);
+
+    /**
+     * @brief Compute the physical issue order of a batch
+     * @param jobs Jobs to order
+     * @return Job indices in issue order, or empty list to keep the given order
+     */
+    QList<int> physicalOrder(const QList<Job> &jobs);
+
+    /**
+     * @brief Run jobs with blocking reads on the thread pool
+     * @param jobs Jobs to complete
+     * @param concurrency Worker threads to use
+     */
+    void runJobsOnPool(QList<Job> &jobs, int concurrency);
+
+    /**
+     * @brief Run jobs through the io_uring queue
+     * @param jobs Jobs to complete
+     * @param concurrency Reads to keep in flight
+     * @return False if the ring failed and the pool must take over
+     */
+    bool runJobsOnRing(QList<Job> &jobs, int concurrency);
+
+    /**
+     * @brief Read a single job with blocking QFile calls
+     * @param job Job to complete
+     */
+    static void runJobBlocking(Job &job);
+
+    /**
+     * @brief Resolve the requested range once the file size is known
+     * @param job Job with fileSize set
+     */
+    static void resolveRange(Job &job);
+
+    /**
+     * @brief Append a chunk to a job's output
+     * @param job Target job
+     * @param data Chunk start
+     * @param size Chunk length
+     */
+    static void consumeChunk(Job &job, const char *data, qint64 size);
+
+    /**
+     * @brief Create the io_uring queue on first use
+     * @return True if the ring is usable
+     */
+    bool ensureRing();
+
+    Backend m_requestedBackend;             ///< Backend asked for by the caller
+    int m_queueDepth;                       ///< Upper bound of reads kept in flight
+    IoUringQueue *m_ring;                   ///< Lazily created ring (nullptr if unused)
+    bool m_ringFailed;                      ///< Set once io_uring turned out unusable
+    Ordering m_ordering;                    ///< Batch issue order
+    bool m_dropBehind;                      ///< Whole-file reads bypass the page cache
+    QThreadPool m_pool;                     ///< Workers for the fallback backend
+};
+
+#endif // BATCHFILEREADER_H
@@ -1,6 +1,9 @@
 #include "duplicateanalyzer.h"
 #include "projectmanager.h"
 #include "foldermanager.h"
+#include "imageprobe.h"
+#include "memorygovernor.h"
+#include "externalsorter.h"
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
 #include <QVBoxLayout>
@@ -14,7 +17,6 @@
 #include <QStyle>
 #include <QDir>
 #include <QFileInfo>
-#include <QCryptographicHash>
 #include <QDesktopServices>
 #include <QUrl>
 #include <QMessageBox>
@@ -24,8 +26,11 @@
 #include <QDataStream>
 #include <QDateTime>
 #include <QThread>
-#include <QImageReader>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
+#include <QLocale>
 #include <cstdio>
+#include <algorithm>
 
 // === Constants ===
 namespace {
@@ -40,6 +45,10 @@ constexpr qint64 BYTES_PER_KB = 1024;
 constexpr qint64 BYTES_PER_MB = 1024 * 1024;
 constexpr qint64 BYTES_PER_GB = 1024 * 1024 * 1024;
 
+// Memory governor accounting of the folder content cache
+constexpr double FOLDER_CACHE_WEIGHT = 1.0;
+constexpr qint64 FOLDER_CACHE_BYTES_PER_ENTRY = 256;  // Path string, FileInfo and hash node
+
 // Column indices for issues tree
 constexpr int COL_SEVERITY = 0;
 constexpr int COL_TYPE = 1;
@@ -47,6 +56,31 @@ constexpr int COL_DESCRIPTION = 2;
 constexpr int COL_SIMILARITY = 3;
 constexpr int COL_WASTED_SPACE = 4;
 
+// Issues tree item data
+constexpr int ISSUE_INDEX_ROLE = Qt::UserRole;        // Index into m_duplicateIssues
+constexpr int NESTED_PATH_ROLE = Qt::UserRole + 1;    // Relative path of a nested twin
+constexpr int CLUSTER_COPY_ROLE = Qt::UserRole + 2;   // Path of one copy in a cluster
+constexpr int MAX_NESTED_ITEMS = 100;                 // Nested twins listed under an issue
+
+// Progress is refreshed after every comparison, and this often for skipped pairs
+constexpr int SKIPPED_PAIRS_PER_PROGRESS_UPDATE = 1024;
+
+// Folders fingerprinted between event loop updates
+constexpr int FINGERPRINTS_PER_EVENT_UPDATE = 64;
+
+// Second batched header read for metadata segments larger than the first block
+constexpr qint64 EXTENDED_HEADER_SIZE = 256 * 1024;
+
+// Out-of-core analysis
+constexpr int OUT_OF_CORE_SORT_SHARE = 8;             // Each sorter buffers 1/8 of the memory budget
+constexpr int MAX_SIGNATURE_FOLDERS = 1024;           // Larger signature groups are not paired up
+constexpr int RECORDS_PER_EVENT_UPDATE = 65536;       // Sorted records between event loop updates
+constexpr int MATCHES_PER_EVENT_UPDATE = 1024;
+constexpr quint64 SECOND_HASH_SEED = 0x9e3779b97f4a7c15ULL;
+
+// Project state key of the last completed analysis
+const QString KEY_LAST_ANALYSIS = "duplicate_analysis_date";
+
 // Supported image extensions
 const QStringList SUPPORTED_EXTENSIONS = {
     "jpg", "jpeg", "png", "bmp", "gif", "tiff", "tif", "webp", "raw", "cr2", "nef", "arw"
@@ -74,6 +108,83 @@ const QString TYPE_PARTIAL = "Partial Duplicate";
 const QString SEVERITY_HIGH = "High";
 const QString SEVERITY_MEDIUM = "Medium";
 const QString SEVERITY_LOW = "Low";
+
+// True if path is folder itself or lies below it
+bool isSameOrInside(const QString &path, const QString &folder)
+{
+    if (!path.startsWith(folder)) {
+        return false;
+    }
+    return path.size() == folder.size() || folder.endsWith('/') || path.at(folder.size()) == '/';
+}
+
+// Folder at the same relative path under otherRoot as path is under root
+QString twinPath(const QString &path, const QString &root, const QString &otherRoot)
+{
+    QString relative = path.mid(root.size());
+    if (relative.startsWith('/')) {
+        relative.remove(0, 1);
+    }
+    if (relative.isEmpty()) {
+        return otherRoot;
+    }
+    return otherRoot.endsWith('/') ? otherRoot + relative : otherRoot + '/' + relative;
+}
+
+// Spreads a value over all 64 bits (splitmix64 finalizer), so that sums of
+// mixed hashes work as order-independent multiset hashes
+quint64 mixHash(quint64 value)
+{
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+quint64 stringHash(const QString &text)
+{
+    return static_cast<quint64>(qHash(text, 0));
+}
+
+// Union-find over dense integer IDs, with path halving and union by size
+class DisjointSets
+{
+public:
+    int add()
+    {
+        const int id = static_cast<int>(m_parent.size());
+        m_parent.append(id);
+        m_size.append(1);
+        return id;
+    }
+
+    int find(int id)
+    {
+        while (m_parent.at(id) != id) {
+            m_parent[id] = m_parent.at(m_parent.at(id));
+            id = m_parent.at(id);
+        }
+        return id;
+    }
+
+    void unite(int a, int b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return;
+        }
+        if (m_size.at(a) < m_size.at(b)) {
+            std::swap(a, b);
+        }
+        m_parent[b] = a;
+        m_size[a] += m_size.at(b);
+    }
+
+private:
+    QList<int> m_parent;
+    QList<int> m_size;
+};
 }
 
 // === Constructor ===
@@ -84,22 +195,51 @@ DuplicateAnalyzer::DuplicateAnalyzer(ProjectManager *projectManager,
     : QWidget(parent)
     , m_projectManager(projectManager)
     , m_folderManager(folderManager)
+    , m_partialThreshold(PARTIAL_DUPLICATE_THRESHOLD)
+    , m_memoryConsumerId(0)
     , m_currentMode(ComparisonMode::Quick)
+    , m_sampleCount(DEFAULT_SAMPLE_COUNT)
+    , m_droppedSignatures(0)
     , m_analysisRunning(false)
+    , m_bytesRead(0)
+    , m_filesHashed(0)
+    , m_sampledCollisions(0)
+    , m_collisionSampleShift(0)
 {
     setupUI();
     loadFolderContentCache();
+    restoreStoredResults();
+
+    m_memoryConsumerId = MemoryGovernor::instance()->registerConsumer(
+        "Folder content cache", FOLDER_CACHE_WEIGHT,
+        [this]() { return folderContentCacheBytes(); },
+        [this](qint64 bytes) { return evictFolderContentCache(bytes); });
+}
+
+DuplicateAnalyzer::~DuplicateAnalyzer()
+{
+    MemoryGovernor::instance()->unregisterConsumer(m_memoryConsumerId);
 }
 
 // === Public Methods ===
 
 void DuplicateAnalyzer::startAnalysis(ComparisonMode mode)
 {
-    qDebug() << "=== DuplicateAnalyzer::startAnalysis() called ===" << "Mode:" << (mode == ComparisonMode::Quick ? "Quick" : "Deep");
+    qDebug() << "=== DuplicateAnalyzer::startAnalysis() called ===" << "Mode:" << getModeName(mode);
 
     m_currentMode = mode;
     clearResults();
 
+    // Cached contents hold the signatures of the mode they were read in
+    if (m_cacheScheme != signatureScheme()) {
+        if (!m_folderContentCache.isEmpty()) {
+            qDebug() << "Signature scheme changed from" << m_cacheScheme << "to" << signatureScheme()
+                     << "- discarding" << m_folderContentCache.size() << "cached folders";
+        }
+        m_folderContentCache.clear();
+        m_cacheScheme = signatureScheme();
+    }
+
     QStringList projectFolders = getProjectFolders();
     qDebug() << "Total folders found (including subfolders):" << projectFolders.size();
     for (const QString &folder : projectFolders) {
@@ -123,11 +263,36 @@ void DuplicateAnalyzer::startAnalysis(ComparisonMode mode)
     qDebug() << "=== startAnalysis() completed ===";
 }
 
+void DuplicateAnalyzer::setPartialThreshold(double threshold)
+{
+    m_partialThreshold = qBound(MIN_PARTIAL_THRESHOLD, threshold, 1.0);
+
+    const int percent = qRound(m_partialThreshold * 100);
+    m_thresholdLabel->setText(QString("%1%").arg(percent));
+    if (m_thresholdSlider->value() != percent) {
+        m_thresholdSlider->setValue(percent);
+        return;  // onThresholdChanged() comes back here
+    }
+
+    // The slider is disabled while an analysis is comparing pairs
+    if (!m_analysisRunning) {
+        applyPartialThreshold();
+    }
+}
+
+void DuplicateAnalyzer::setSampleCount(int count)
+{
+    m_sampleCount = qBound(1, count, MAX_SAMPLE_COUNT);
+}
+
 void DuplicateAnalyzer::clearResults()
 {
     m_duplicateIssues.clear();
-    // Don't clear the folder content cache - keep it for performance
-    // But we need to be careful: Quick mode cache won't have partial hashes
+    m_folderRecords.clear();
+    m_folderRecordIds.clear();
+    m_pairResults.clear();
+    // Don't clear the folder content cache - keep it for performance;
+    // startAnalysis() drops it when the signature scheme changes
     updateIssuesTree();
     updateDetailsPanel();
 
@@ -149,51 +314,44 @@ void DuplicateAnalyzer::onIssueSelected()
     m_openDuplicateButton->setEnabled(hasSelection);
 }
 
-void DuplicateAnalyzer::showPrimaryFolder()
+void DuplicateAnalyzer::onThresholdChanged(int percent)
 {
-    QTreeWidgetItem *item = getCurrentIssueItem();
-    if (!item) return;
+    setPartialThreshold(percent / 100.0);
+}
 
-    int issueIndex = m_issuesTree->indexOfTopLevelItem(item);
-    if (issueIndex >= 0 && issueIndex < m_duplicateIssues.size()) {
-        const DuplicateIssue &issue = m_duplicateIssues[issueIndex];
-        emit showFolderInTree(issue.primaryFolder);
+void DuplicateAnalyzer::showPrimaryFolder()
+{
+    QString primaryFolder;
+    QString duplicateFolder;
+    if (foldersForItem(getCurrentIssueItem(), primaryFolder, duplicateFolder)) {
+        emit showFolderInTree(primaryFolder);
     }
 }
 
 void DuplicateAnalyzer::showDuplicateFolder()
 {
-    QTreeWidgetItem *item = getCurrentIssueItem();
-    if (!item) return;
-
-    int issueIndex = m_issuesTree->indexOfTopLevelItem(item);
-    if (issueIndex >= 0 && issueIndex < m_duplicateIssues.size()) {
-        const DuplicateIssue &issue = m_duplicateIssues[issueIndex];
-        emit showFolderInTree(issue.duplicateFolder);
+    QString primaryFolder;
+    QString duplicateFolder;
+    if (foldersForItem(getCurrentIssueItem(), primaryFolder, duplicateFolder)) {
+        emit showFolderInTree(duplicateFolder);
     }
 }
 
 void DuplicateAnalyzer::openPrimaryInExplorer()
 {
-    QTreeWidgetItem *item = getCurrentIssueItem();
-    if (!item) return;
-
-    int issueIndex = m_issuesTree->indexOfTopLevelItem(item);
-    if (issueIndex >= 0 && issueIndex < m_duplicateIssues.size()) {
-        const DuplicateIssue &issue = m_duplicateIssues[issueIndex];
-        openFolderInExplorer(issue.primaryFolder);
+    QString primaryFolder;
+    QString duplicateFolder;
+    if (foldersForItem(getCurrentIssueItem(), primaryFolder, duplicateFolder)) {
+        openFolderInExplorer(primaryFolder);
     }
 }
 
 void DuplicateAnalyzer::openDuplicateInExplorer()
 {
-    QTreeWidgetItem *item = getCurrentIssueItem();
-    if (!item) return;
-
-    int issueIndex = m_issuesTree->indexOfTopLevelItem(item);
-    if (issueIndex >= 0 && issueIndex < m_duplicateIssues.size()) {
-        const DuplicateIssue &issue = m_duplicateIssues[issueIndex];
-        openFolderInExplorer(issue.duplicateFolder);
+    QString primaryFolder;
+    QString duplicateFolder;
+    if (foldersForItem(getCurrentIssueItem(), primaryFolder, duplicateFolder)) {
+        openFolderInExplorer(duplicateFolder);
     }
 }
 
@@ -221,6 +379,7 @@ void DuplicateAnalyzer::resetAnalysisState()
     m_progressBar->setVisible(false);
     m_statusLabel->setText("Analysis cancelled");
     m_analysisRunning = false;
+    m_thresholdSlider->setEnabled(true);
 
     printf("\nAnalysis state reset.\n");
     fflush(stdout);
@@ -268,10 +427,25 @@ void DuplicateAnalyzer::createIssuesTree()
     m_issuesCountLabel->setStyleSheet("font-weight: bold; padding: 5px;");
     treeLayout->addWidget(m_issuesCountLabel);
 
+    // Partial duplicate threshold, applied to the stored candidates instantly
+    QHBoxLayout *thresholdLayout = new QHBoxLayout;
+    thresholdLayout->addWidget(new QLabel("Partial match threshold:"));
+    m_thresholdSlider = new QSlider(Qt::Horizontal);
+    m_thresholdSlider->setRange(qRound(MIN_PARTIAL_THRESHOLD * 100), 100);
+    m_thresholdSlider->setValue(qRound(PARTIAL_DUPLICATE_THRESHOLD * 100));
+    m_thresholdSlider->setToolTip("Minimum share of files two folders must have in common\n"
+                                  "Changes the results without re-analyzing");
+    thresholdLayout->addWidget(m_thresholdSlider, 1);
+    m_thresholdLabel = new QLabel(QString("%1%").arg(qRound(PARTIAL_DUPLICATE_THRESHOLD * 100)));
+    thresholdLayout->addWidget(m_thresholdLabel);
+    treeLayout->addLayout(thresholdLayout);
+
+    connect(m_thresholdSlider, &QSlider::valueChanged, this, &DuplicateAnalyzer::onThresholdChanged);
+
     // Create tree widget
     m_issuesTree = new QTreeWidget;
     m_issuesTree->setHeaderLabels({"Severity", "Type", "Description", "Similarity", "Wasted Space"});
-    m_issuesTree->setRootIsDecorated(false);
+    m_issuesTree->setRootIsDecorated(true);
     m_issuesTree->setAlternatingRowColors(true);
     m_issuesTree->setSelectionMode(QAbstractItemView::SingleSelection);
     m_issuesTree->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -408,8 +582,18 @@ void DuplicateAnalyzer::createProgressSection()
 void DuplicateAnalyzer::performAnalysis()
 {
     m_analysisRunning = true;
+    m_thresholdSlider->setEnabled(false);
     m_filesAnalyzed = 0;
     m_foldersScanned = 0;
+    m_droppedSignatures = 0;
+    m_bytesRead = 0;
+    m_filesHashed = 0;
+    m_sampledCollisions = 0;
+    m_collisionSampleShift = 0;
+    m_deepToSampled.clear();
+
+    QElapsedTimer timer;
+    timer.start();
 
     QStringList projectFolders = getProjectFolders();
     if (projectFolders.isEmpty()) {
@@ -422,6 +606,27 @@ void DuplicateAnalyzer::performAnalysis()
     m_progressBar->setValue(0);
     m_statusLabel->setText(QString("Starting %1 analysis...").arg(getModeName(m_currentMode)));
 
+    // Fingerprints tell which folders changed since the stored analysis;
+    // pairs of unchanged folders reuse their stored result
+    loadStoredAnalysis();
+    computeFolderFingerprints(projectFolders);
+    if (!m_analysisRunning) {
+        resetAnalysisState();
+        return;
+    }
+
+    bool anyFolderChanged = false;
+    for (const QString &folder : std::as_const(projectFolders)) {
+        if (isFolderUnchanged(folder)) {
+            continue;
+        }
+        anyFolderChanged = true;
+        // Cached content of a folder known to have changed is stale
+        if (m_storedFolders.contains(folder)) {
+            m_folderContentCache.remove(folder);
+        }
+    }
+
     // Phase 1 (0-10%): Count files that need analysis
     qDebug() << "\n=== Phase 1: Counting uncached files ===";
     m_totalFilesToAnalyze = 0;
@@ -433,7 +638,9 @@ void DuplicateAnalyzer::performAnalysis()
             return;
         }
 
-        if (!m_folderContentCache.contains(folder)) {
+        // A changed folder is compared with every other one, so once any
+        // folder changed, every uncached folder gets loaded
+        if (!m_folderContentCache.contains(folder) && (anyFolderChanged || !isFolderUnchanged(folder))) {
             m_totalFoldersToScan++;
             int fileCount = countFilesInFolder(folder);
             m_totalFilesToAnalyze += fileCount;
@@ -453,38 +660,80 @@ void DuplicateAnalyzer::performAnalysis()
     qDebug() << "\n=== Phase 2: Analyzing folder contents ===";
     m_progressBar->setValue(10);
     
-    if (m_totalFilesToAnalyze > 0) {
-        m_statusLabel->setText(QString("%1 analysis: Processing %2 files...")
-                              .arg(getModeName(m_currentMode))
-                              .arg(m_totalFilesToAnalyze));
-        printf("\nStarting file analysis (%s mode):\n", getModeName(m_currentMode).toLocal8Bit().constData());
-        fflush(stdout);
-    }
+    // Libraries whose folder contents would not fit the memory budget are
+    // analyzed from sorted runs on disk instead of the content cache
+    const bool outOfCore = shouldAnalyzeOutOfCore();
+    if (outOfCore) {
+        analyzeOutOfCore(projectFolders);
+    } else {
+        if (m_totalFilesToAnalyze > 0) {
+            m_statusLabel->setText(QString("%1 analysis: Processing %2 files...")
+                                  .arg(getModeName(m_currentMode))
+                                  .arg(m_totalFilesToAnalyze));
+            printf("\nStarting file analysis (%s mode):\n", getModeName(m_currentMode).toLocal8Bit().constData());
+            fflush(stdout);
+        }
 
-    analyzeFolderPairs();
+        analyzeFolderPairs();
+    }
 
     if (!m_analysisRunning) {
         resetAnalysisState();
         return;
     }
 
+    clusterDuplicateIssues();
+
     // Phase 3 (70-100%): Compare folder pairs and finalize
     qDebug() << "\n=== Phase 3: Finalizing results ===";
     m_progressBar->setValue(100);
     printf("\n\nAnalysis complete!\n");
     fflush(stdout);
 
-    // Save cache for future runs
-    saveFolderContentCache();
+    // Save cache and results for future runs; an out-of-core run has no
+    // cache, and the one on disk is kept for smaller libraries
+    if (!outOfCore) {
+        saveFolderContentCache();
+    }
+    saveAnalysisResults(projectFolders);
+
+    // Signature cost of this run, to weigh the modes against each other
+    QString costText;
+    if (m_filesHashed > 0) {
+        const qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+        qDebug() << signatureScheme() << "signatures:" << m_filesHashed << "files,"
+                 << m_bytesRead / m_filesHashed << "bytes read per file,"
+                 << m_filesHashed * 1000 / elapsed << "files/s";
+        costText = QString(" - %1 files, %2 read per file")
+                       .arg(m_filesHashed)
+                       .arg(formatFileSize(m_bytesRead / m_filesHashed));
+        if (m_currentMode == ComparisonMode::Sampled) {
+            const int collisions = estimatedSampledCollisions();
+            qDebug() << "Sampled hashes told apart" << collisions
+                     << "files that Deep mode would have matched";
+            costText += QString(", %1%2 Deep collisions avoided")
+                            .arg(m_collisionSampleShift > 0 ? "~" : "")
+                            .arg(collisions);
+        }
+    }
+    m_deepToSampled.clear();
+
+    // Signatures left out of the overlap counts make partial results approximate
+    if (m_droppedSignatures > 0) {
+        costText += QString(" - %1 file signatures shared by more than %2 folders not compared")
+                        .arg(m_droppedSignatures)
+                        .arg(MAX_SIGNATURE_FOLDERS);
+    }
 
     // Update UI
     updateIssuesTree();
     m_statusLabel->setText(QString("%1 complete: %2 issues found")
                           .arg(MSG_COMPLETED.arg(m_duplicateIssues.size()))
-                          .arg(getModeName(m_currentMode)));
+                          .arg(getModeName(m_currentMode)) + costText);
 
     m_progressBar->setVisible(false);
     m_analysisRunning = false;
+    m_thresholdSlider->setEnabled(true);
 
     emit analysisCompleted(m_duplicateIssues.size(), m_currentMode);
 }
@@ -494,23 +743,97 @@ void DuplicateAnalyzer::analyzeFolderPairs()
     QStringList projectFolders = getProjectFolders();
     int totalPairs = (projectFolders.size() * (projectFolders.size() - 1)) / 2;
     int pairsAnalyzed = 0;
+    int pairsCompared = 0;
+    int pairsReused = 0;
+    int pairsSkipped = 0;
+
+    // Folders are listed parents first, so the pairs of two folders' ancestors
+    // are always decided before theirs. Once two folders are exact complete
+    // duplicates, each subfolder of one has a twin at the same relative path
+    // in the other; those twin pairs are implied by the match and skipped.
+    QList<int> exactIssues;
 
-    // Compare each pair of folders
     for (int i = 0; i < projectFolders.size(); ++i) {
         if (!m_analysisRunning) return;
 
+        // Exact complete matches one of whose folders contains folder1: (issue, twin of folder1)
+        const QString &folder1 = projectFolders[i];
+        QList<QPair<int, QString>> covering;
+        for (int issueIndex : std::as_const(exactIssues)) {
+            const DuplicateIssue &issue = m_duplicateIssues.at(issueIndex);
+            if (isSameOrInside(folder1, issue.primaryFolder)) {
+                covering.append(qMakePair(issueIndex, twinPath(folder1, issue.primaryFolder, issue.duplicateFolder)));
+            } else if (isSameOrInside(folder1, issue.duplicateFolder)) {
+                covering.append(qMakePair(issueIndex, twinPath(folder1, issue.duplicateFolder, issue.primaryFolder)));
+            }
+        }
+
+        // Same for the stored analysis, whose twin pairs were never compared
+        const bool folder1Unchanged = isFolderUnchanged(folder1);
+        QStringList storedCovering;
+        if (folder1Unchanged) {
+            for (const auto &exact : std::as_const(m_storedExactPairs)) {
+                if (isSameOrInside(folder1, exact.first)) {
+                    storedCovering.append(twinPath(folder1, exact.first, exact.second));
+                } else if (isSameOrInside(folder1, exact.second)) {
+                    storedCovering.append(twinPath(folder1, exact.second, exact.first));
+                }
+            }
+        }
+
         for (int j = i + 1; j < projectFolders.size(); ++j) {
             if (!m_analysisRunning) return;
 
-            compareFolders(projectFolders[i], projectFolders[j]);
-
+            const QString &folder2 = projectFolders[j];
             pairsAnalyzed++;
+
+            int coveringIssue = -1;
+            for (const auto &cover : std::as_const(covering)) {
+                if (folder2 == cover.second) {
+                    coveringIssue = cover.first;
+                    break;
+                }
+            }
+
+            // A folder and its own subfolder share the same files on disk
+            const bool nested = isSameOrInside(folder2, folder1) || isSameOrInside(folder1, folder2);
+
+            if (coveringIssue >= 0) {
+                m_duplicateIssues[coveringIssue].nestedPairs++;
+            }
+            if (coveringIssue >= 0 || nested) {
+                pairsSkipped++;
+                if (pairsSkipped % SKIPPED_PAIRS_PER_PROGRESS_UPDATE != 0) {
+                    continue;
+                }
+            } else {
+                const int issuesBefore = m_duplicateIssues.size();
+                if (folder1Unchanged && isFolderUnchanged(folder2) &&
+                    reuseStoredResult(folder1, folder2, storedCovering)) {
+                    pairsReused++;
+                } else {
+                    compareFolders(folder1, folder2);
+                    pairsCompared++;
+                }
+
+                if (m_duplicateIssues.size() > issuesBefore &&
+                    m_duplicateIssues.last().type == DuplicateType::ExactComplete) {
+                    const int issueIndex = m_duplicateIssues.size() - 1;
+                    exactIssues.append(issueIndex);
+                    covering.append(qMakePair(issueIndex, folder2));
+                }
+            }
+
             // Update progress (70-100% range)
             int progress = 70 + (pairsAnalyzed * 30) / qMax(1, totalPairs);
             m_progressBar->setValue(progress);
             QApplication::processEvents();
         }
     }
+
+    qDebug() << "Folder pairs:" << totalPairs << "compared:" << pairsCompared
+             << "reused from the last analysis:" << pairsReused
+             << "skipped as nested or twins of an exact match:" << pairsSkipped;
 }
 
 void DuplicateAnalyzer::compareFolders(const QString &folder1, const QString &folder2)
@@ -527,6 +850,7 @@ void DuplicateAnalyzer::compareFolders(const QString &folder1, const QString &fo
     if (!m_folderContentCache.contains(folder2)) {
         m_folderContentCache[folder2] = analyzeFolderContent(folder2);
     }
+    MemoryGovernor::instance()->notifyGrowth();
 
     const FolderContent &content1 = m_folderContentCache[folder1];
     const FolderContent &content2 = m_folderContentCache[folder2];
@@ -536,55 +860,30 @@ void DuplicateAnalyzer::compareFolders(const QString &folder1, const QString &fo
         return;
     }
 
-    // Check for exact complete duplicate (files + folder structure)
+    // Check for exact complete duplicate (files + folder structure), then
+    // for exact files-only duplicate
+    PairResult pair;
+    pair.folder1 = folderRecordId(folder1);
+    pair.folder2 = folderRecordId(folder2);
     if (isExactCompleteDuplicate(content1, content2)) {
-        DuplicateIssue issue;
-        issue.type = DuplicateType::ExactComplete;
-        issue.primaryFolder = folder1;
-        issue.duplicateFolder = folder2;
-        issue.similarity = 1.0;
-        issue.totalFiles = content1.allFiles.size();
-        issue.duplicateFiles = content1.allFiles.size();
-        issue.wastedSpace = qMin(content1.totalSize, content2.totalSize);
-        issue.severity = SEVERITY_HIGH;
-        issue.description = formatIssueDescription(issue);
-
-        addDuplicateIssue(issue);
+        pair.type = DuplicateType::ExactComplete;
+        addPairResult(pair);
         return; // Don't check other types if exact match found
     }
-
-    // Check for exact files-only duplicate
     if (isExactFilesOnlyDuplicate(content1, content2)) {
-        DuplicateIssue issue;
-        issue.type = DuplicateType::ExactFilesOnly;
-        issue.primaryFolder = folder1;
-        issue.duplicateFolder = folder2;
-        issue.similarity = 1.0;
-        issue.totalFiles = content1.allFiles.size();
-        issue.duplicateFiles = content1.allFiles.size();
-        issue.wastedSpace = qMin(content1.totalSize, content2.totalSize);
-        issue.severity = SEVERITY_MEDIUM;
-        issue.description = formatIssueDescription(issue);
-
-        addDuplicateIssue(issue);
+        pair.type = DuplicateType::ExactFilesOnly;
+        addPairResult(pair);
         return;
     }
 
-    // Check for partial duplicate (90%+ similarity)
-    double similarity = calculateFileSimilarity(content1, content2);
-    if (similarity >= PARTIAL_DUPLICATE_THRESHOLD) {
-        DuplicateIssue issue;
-        issue.type = DuplicateType::PartialDuplicate;
-        issue.primaryFolder = folder1;
-        issue.duplicateFolder = folder2;
-        issue.similarity = similarity;
-        issue.totalFiles = qMax(content1.allFiles.size(), content2.allFiles.size());
-        issue.duplicateFiles = qRound(similarity * issue.totalFiles);
-        issue.wastedSpace = qRound(similarity * qMin(content1.totalSize, content2.totalSize));
-        issue.severity = SEVERITY_LOW;
-        issue.description = formatIssueDescription(issue);
-
-        addDuplicateIssue(issue);
+    // Check for partial duplicate; the overlap counts are kept so the
+    // threshold can be changed later without re-analysis
+    const FileOverlap overlap = calculateFileOverlap(content1, content2);
+    if (overlap.similarity() >= MIN_PARTIAL_THRESHOLD) {
+        pair.type = DuplicateType::PartialDuplicate;
+        pair.intersection = overlap.intersection;
+        pair.unionSize = overlap.unionSize;
+        addPairResult(pair);
     }
 }
 
@@ -634,13 +933,8 @@ void DuplicateAnalyzer::scanFolderRecursive(const QString &folderPath,
     // Scan files
     QStringList files = dir.entryList(QDir::Files, QDir::Name);
 
-    int imageFileCount = 0;
+    QStringList imagePaths;
     for (const QString &fileName : files) {
-        if (!m_analysisRunning) {
-            scanDepth--;
-            return;
-        }
-
         QString fullPath = dir.absoluteFilePath(fileName);
         QFileInfo fileInfo(fullPath);
 
@@ -648,14 +942,27 @@ void DuplicateAnalyzer::scanFolderRecursive(const QString &folderPath,
 
         // Only include image files
         if (SUPPORTED_EXTENSIONS.contains(extension)) {
-            imageFileCount++;
+            imagePaths.append(fullPath);
+        }
+    }
+
+    // Analyze in batches so many reads are in flight at once
+    for (int start = 0; start < imagePaths.size(); start += ANALYSIS_BATCH_SIZE) {
+        if (!m_analysisRunning) {
+            scanDepth--;
+            return;
+        }
+
+        const QStringList batch = imagePaths.mid(start, ANALYSIS_BATCH_SIZE);
+        const QList<FileInfo> infos = analyzeFiles(batch);
+
+        for (int i = 0; i < batch.size(); ++i) {
             m_filesAnalyzed++;
 
-            QString relativePath = getRelativePath(fullPath, basePath);
+            QString relativePath = getRelativePath(batch.at(i), basePath);
             content.allFiles.append(relativePath);
 
-            // Analyze file based on current mode
-            FileInfo info = analyzeFile(fullPath);
+            const FileInfo &info = infos.at(i);
             content.fileInfo[relativePath] = info;
             content.totalSize += info.fileSize;
 
@@ -685,62 +992,164 @@ void DuplicateAnalyzer::scanFolderRecursive(const QString &folderPath,
     scanDepth--;
 }
 
-DuplicateAnalyzer::FileInfo DuplicateAnalyzer::analyzeFile(const QString &filePath)
+QList<DuplicateAnalyzer::FileInfo> DuplicateAnalyzer::analyzeFiles(const QStringList &filePaths)
 {
-    FileInfo info;
-    
-    QFileInfo fileInfo(filePath);
-    info.fileSize = fileInfo.size();
-    
-    // Read image dimensions (quick)
-    QSize dimensions = readImageDimensions(filePath);
-    info.imageWidth = dimensions.width();
-    info.imageHeight = dimensions.height();
-    
-    // Calculate partial hash only in Deep mode
-    if (m_currentMode == ComparisonMode::Deep) {
-        info.partialHash = calculatePartialHash(filePath);
+    const bool hashMode = m_currentMode != ComparisonMode::Quick;
+    const bool sampledMode = m_currentMode == ComparisonMode::Sampled;
+    const qint64 headSize = qMax<qint64>(ImageProbe::headerSize(), PARTIAL_HASH_SIZE);
+
+    // Header block for every file, plus the tail block in Deep and Sampled mode
+    QList<BatchFileReader::ReadRequest> requests;
+    for (const QString &filePath : filePaths) {
+        requests.append({filePath, 0, headSize});
+        if (hashMode) {
+            requests.append({filePath, -PARTIAL_HASH_SIZE, PARTIAL_HASH_SIZE});
+        }
     }
-    
-    return info;
-}
 
-QSize DuplicateAnalyzer::readImageDimensions(const QString &filePath)
-{
-    QImageReader reader(filePath);
-    QSize size = reader.size();
-    
-    if (!size.isValid()) {
-        qDebug() << "Failed to read image dimensions for:" << filePath;
-        return QSize(0, 0);
+    const QList<BatchFileReader::ReadResult> results = m_batchReader.read(requests);
+    const int stride = hashMode ? 2 : 1;
+
+    // Sampled mode: interior blocks, placed by the file size the first batch
+    // reported so copies are sampled at the same offsets
+    QList<BatchFileReader::ReadResult> sampleResults;
+    QList<int> sampleStart;
+    if (sampledMode) {
+        QList<BatchFileReader::ReadRequest> sampleRequests;
+        sampleStart.reserve(filePaths.size() + 1);
+        for (int i = 0; i < filePaths.size(); ++i) {
+            sampleStart.append(sampleRequests.size());
+            const BatchFileReader::ReadResult &head = results.at(i * stride);
+            if (!head.ok) {
+                continue;
+            }
+            const QList<qint64> offsets = ImageProbe::sampleOffsets(head.fileSize, m_sampleCount,
+                                                                    PARTIAL_HASH_SIZE, SAMPLE_BLOCK_SIZE);
+            for (qint64 offset : offsets) {
+                sampleRequests.append({filePaths.at(i), offset, SAMPLE_BLOCK_SIZE});
+            }
+        }
+        sampleStart.append(sampleRequests.size());
+        sampleResults = m_batchReader.read(sampleRequests);
+    }
+
+    // Header parsers on the head block; headers running past it (large EXIF
+    // segments, distant IFDs) are read again in one batch with a larger block
+    QList<ImageProbe::Info> images;
+    images.reserve(filePaths.size());
+    QList<BatchFileReader::ReadRequest> extendedRequests;
+    QList<int> extendedFiles;
+    for (int i = 0; i < filePaths.size(); ++i) {
+        const BatchFileReader::ReadResult &head = results.at(i * stride);
+        images.append(ImageProbe::probe(nullptr, head.data));
+        if (!images.last().isValid() && head.ok && head.fileSize > head.data.size()) {
+            extendedRequests.append({filePaths.at(i), 0, EXTENDED_HEADER_SIZE});
+            extendedFiles.append(i);
+        }
     }
-    
-    return size;
+    const QList<BatchFileReader::ReadResult> extendedResults = m_batchReader.read(extendedRequests);
+    for (int k = 0; k < extendedResults.size(); ++k) {
+        images[extendedFiles.at(k)] = ImageProbe::probe(nullptr, extendedResults.at(k).data);
+    }
+
+    for (const BatchFileReader::ReadResult &result : results) {
+        m_bytesRead += result.data.size();
+    }
+    for (const BatchFileReader::ReadResult &result : std::as_const(sampleResults)) {
+        m_bytesRead += result.data.size();
+    }
+    for (const BatchFileReader::ReadResult &result : extendedResults) {
+        m_bytesRead += result.data.size();
+    }
+    m_filesHashed += filePaths.size();
+
+    QList<FileInfo> infos;
+    infos.reserve(filePaths.size());
+    for (int i = 0; i < filePaths.size(); ++i) {
+        const QString &filePath = filePaths.at(i);
+        const BatchFileReader::ReadResult &head = results.at(i * stride);
+
+        FileInfo info;
+        info.fileSize = qMax<qint64>(0, head.fileSize);
+
+        const ImageProbe::Info &image = images.at(i);
+        if (image.isValid()) {
+            info.imageWidth = image.size.width();
+            info.imageHeight = image.size.height();
+        } else {
+            qDebug() << "Failed to read image dimensions for:" << filePath;
+            info.imageWidth = 0;
+            info.imageHeight = 0;
+        }
+
+        // Partial hash only in Deep and Sampled mode
+        if (hashMode && head.ok) {
+            const BatchFileReader::ReadResult &tail = results.at(i * stride + 1);
+            info.partialHash = ImageProbe::partialHash(head.data, tail.data,
+                                                       head.fileSize, PARTIAL_HASH_SIZE);
+
+            if (sampledMode) {
+                QList<QByteArray> samples;
+                for (int j = sampleStart.at(i); j < sampleStart.at(i + 1); ++j) {
+                    samples.append(sampleResults.at(j).data);
+                }
+
+                // Measure what sampling buys: the Deep signature comes for
+                // free from the same head and tail blocks
+                const QString deepSignature = QString("%1x%2_%3_%4").arg(info.imageWidth)
+                                                  .arg(info.imageHeight).arg(info.fileSize)
+                                                  .arg(info.partialHash);
+                info.partialHash = ImageProbe::sampledHash(head.data, samples, tail.data,
+                                                           head.fileSize, PARTIAL_HASH_SIZE);
+                recordSampledCollision(deepSignature, info.partialHash);
+            }
+        }
+
+        infos.append(info);
+    }
+
+    return infos;
 }
 
-QString DuplicateAnalyzer::calculatePartialHash(const QString &filePath)
+void DuplicateAnalyzer::recordSampledCollision(const QString &deepSignature,
+                                               const QString &sampledHash)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open file for partial hashing:" << filePath;
-        return QString();
+    // Only Deep signatures whose hash falls below a threshold are tracked;
+    // the threshold halves whenever the table is full, so memory stays
+    // bounded on any library and the count is scaled back up at the end
+    const quint64 deepKey = mixHash(stringHash(deepSignature));
+    if (m_collisionSampleShift > 0 && (deepKey >> (64 - m_collisionSampleShift)) != 0) {
+        return;
     }
 
-    qint64 fileSize = file.size();
-    QCryptographicHash hash(QCryptographicHash::Md5);
-
-    // Read first 16KB
-    QByteArray firstChunk = file.read(PARTIAL_HASH_SIZE);
-    hash.addData(firstChunk);
+    const quint64 sampledKey = stringHash(sampledHash);
+    auto seen = m_deepToSampled.find(deepKey);
+    if (seen != m_deepToSampled.end()) {
+        if (seen->sampledHash != sampledKey) {
+            seen->collisions++;
+            m_sampledCollisions++;
+        }
+        return;
+    }
 
-    // Read last 16KB (if file is large enough)
-    if (fileSize > PARTIAL_HASH_SIZE * 2) {
-        file.seek(fileSize - PARTIAL_HASH_SIZE);
-        QByteArray lastChunk = file.read(PARTIAL_HASH_SIZE);
-        hash.addData(lastChunk);
+    m_deepToSampled.insert(deepKey, {sampledKey, 0});
+    while (m_deepToSampled.size() > MAX_COLLISION_SAMPLES && m_collisionSampleShift < 63) {
+        m_collisionSampleShift++;
+        for (auto it = m_deepToSampled.begin(); it != m_deepToSampled.end();) {
+            if ((it.key() >> (64 - m_collisionSampleShift)) != 0) {
+                m_sampledCollisions -= it->collisions;
+                it = m_deepToSampled.erase(it);
+            } else {
+                ++it;
+            }
+        }
     }
+}
 
-    return hash.result().toHex();
+int DuplicateAnalyzer::estimatedSampledCollisions() const
+{
+    const qint64 estimate = qint64(m_sampledCollisions) << m_collisionSampleShift;
+    return static_cast<int>(qMin<qint64>(estimate, m_filesHashed));
 }
 
 // === Private Methods - Duplicate Detection ===
@@ -796,69 +1205,42 @@ bool DuplicateAnalyzer::isExactFilesOnlyDuplicate(const FolderContent &folder1,
     
     for (const QString &path : folder1.allFiles) {
         const FileInfo &info = folder1.fileInfo.value(path);
-        QString signature = QString("%1x%2_%3").arg(info.imageWidth).arg(info.imageHeight).arg(info.fileSize);
-        if (m_currentMode == ComparisonMode::Deep) {
-            signature += "_" + info.partialHash;
-        }
-        signatures1.insert(signature, info);
+        signatures1.insert(fileSignature(info), info);
     }
     
     for (const QString &path : folder2.allFiles) {
         const FileInfo &info = folder2.fileInfo.value(path);
-        QString signature = QString("%1x%2_%3").arg(info.imageWidth).arg(info.imageHeight).arg(info.fileSize);
-        if (m_currentMode == ComparisonMode::Deep) {
-            signature += "_" + info.partialHash;
-        }
-        signatures2.insert(signature, info);
+        signatures2.insert(fileSignature(info), info);
     }
 
     return signatures1.keys() == signatures2.keys() && !signatures1.isEmpty();
 }
 
-double DuplicateAnalyzer::calculateFileSimilarity(const FolderContent &folder1,
-                                                  const FolderContent &folder2)
+DuplicateAnalyzer::FileOverlap DuplicateAnalyzer::calculateFileOverlap(const FolderContent &folder1,
+                                                                       const FolderContent &folder2)
 {
-    if (folder1.allFiles.isEmpty() && folder2.allFiles.isEmpty()) {
-        return 1.0;
-    }
-
     if (folder1.allFiles.isEmpty() || folder2.allFiles.isEmpty()) {
-        return 0.0;
+        return FileOverlap{0, 0};
     }
 
     // Get unique file signatures from both folders
     QSet<QString> signatures1, signatures2;
     
     for (const QString &path : folder1.allFiles) {
-        const FileInfo &info = folder1.fileInfo.value(path);
-        QString signature = QString("%1x%2_%3").arg(info.imageWidth).arg(info.imageHeight).arg(info.fileSize);
-        if (m_currentMode == ComparisonMode::Deep) {
-            signature += "_" + info.partialHash;
-        }
-        signatures1.insert(signature);
+        signatures1.insert(fileSignature(folder1.fileInfo.value(path)));
     }
     
     for (const QString &path : folder2.allFiles) {
-        const FileInfo &info = folder2.fileInfo.value(path);
-        QString signature = QString("%1x%2_%3").arg(info.imageWidth).arg(info.imageHeight).arg(info.fileSize);
-        if (m_currentMode == ComparisonMode::Deep) {
-            signature += "_" + info.partialHash;
-        }
-        signatures2.insert(signature);
+        signatures2.insert(fileSignature(folder2.fileInfo.value(path)));
     }
 
     // Calculate Jaccard similarity coefficient
     QSet<QString> intersection = signatures1;
     intersection.intersect(signatures2);
 
-    QSet<QString> unionSet = signatures1;
-    unionSet.unite(signatures2);
-
-    if (unionSet.isEmpty()) {
-        return 0.0;
-    }
-
-    return static_cast<double>(intersection.size()) / unionSet.size();
+    // |A ∪ B| = |A| + |B| - |A ∩ B|
+    return FileOverlap{static_cast<int>(intersection.size()),
+                       static_cast<int>(signatures1.size() + signatures2.size() - intersection.size())};
 }
 
 bool DuplicateAnalyzer::areFilesIdentical(const FileInfo &file1, const FileInfo &file2)
@@ -870,8 +1252,8 @@ bool DuplicateAnalyzer::areFilesIdentical(const FileInfo &file1, const FileInfo
         return false;
     }
     
-    // Deep comparison: also check partial hash
-    if (m_currentMode == ComparisonMode::Deep) {
+    // Deep and Sampled comparison: also check partial hash
+    if (m_currentMode != ComparisonMode::Quick) {
         if (file1.partialHash != file2.partialHash) {
             return false;
         }
@@ -880,6 +1262,864 @@ bool DuplicateAnalyzer::areFilesIdentical(const FileInfo &file1, const FileInfo
     return true;
 }
 
+QString DuplicateAnalyzer::fileSignature(const FileInfo &info) const
+{
+    QString signature = QString("%1x%2_%3").arg(info.imageWidth).arg(info.imageHeight).arg(info.fileSize);
+    if (m_currentMode != ComparisonMode::Quick) {
+        signature += "_" + info.partialHash;
+    }
+    return signature;
+}
+
+// === Private Methods - Pair Results ===
+
+int DuplicateAnalyzer::folderRecordId(const QString &folderPath)
+{
+    auto it = m_folderRecordIds.constFind(folderPath);
+    if (it != m_folderRecordIds.constEnd()) {
+        return it.value();
+    }
+
+    // Sizes are copied so the results outlive evictions of the content cache.
+    // Unchanged folders (and all of them when restoring) take the stored
+    // record, which their stored pair results were computed from.
+    FolderRecord record;
+    auto stored = m_storedFolders.constFind(folderPath);
+    auto content = m_folderContentCache.constFind(folderPath);
+    if (stored != m_storedFolders.constEnd() &&
+        (m_folderFingerprints.isEmpty() || isFolderUnchanged(folderPath))) {
+        record = stored.value();
+    } else if (content != m_folderContentCache.constEnd()) {
+        record.folderPath = folderPath;
+        record.fingerprint = m_folderFingerprints.value(folderPath);
+        record.fileCount = content->allFiles.size();
+        record.totalSize = content->totalSize;
+        record.subfolders = content->allSubfolders;
+    } else {
+        record.folderPath = folderPath;
+    }
+
+    return addFolderRecord(record);
+}
+
+int DuplicateAnalyzer::addFolderRecord(const FolderRecord &record)
+{
+    m_folderRecords.append(record);
+    return m_folderRecordIds.insert(record.folderPath, m_folderRecords.size() - 1).value();
+}
+
+void DuplicateAnalyzer::addPairResult(const PairResult &pair)
+{
+    m_pairResults.append(pair);
+
+    if (pair.type != DuplicateType::PartialDuplicate) {
+        addDuplicateIssue(createExactIssue(pair));
+    } else if (static_cast<double>(pair.intersection) / pair.unionSize >= m_partialThreshold) {
+        addDuplicateIssue(createPartialIssue(pair));
+    }
+}
+
+DuplicateAnalyzer::DuplicateIssue DuplicateAnalyzer::createExactIssue(const PairResult &pair)
+{
+    const FolderRecord &folder1 = m_folderRecords.at(pair.folder1);
+    const FolderRecord &folder2 = m_folderRecords.at(pair.folder2);
+
+    DuplicateIssue issue;
+    issue.type = pair.type;
+    issue.primaryFolder = folder1.folderPath;
+    issue.duplicateFolder = folder2.folderPath;
+    issue.similarity = 1.0;
+    issue.totalFiles = folder1.fileCount;
+    issue.duplicateFiles = folder1.fileCount;
+    issue.wastedSpace = qMin(folder1.totalSize, folder2.totalSize);
+    if (pair.type == DuplicateType::ExactComplete) {
+        issue.severity = SEVERITY_HIGH;
+        issue.nestedFolders = folder1.subfolders;
+    } else {
+        issue.severity = SEVERITY_MEDIUM;
+    }
+    issue.description = formatIssueDescription(issue);
+    return issue;
+}
+
+DuplicateAnalyzer::DuplicateIssue DuplicateAnalyzer::createPartialIssue(const PairResult &pair)
+{
+    const FolderRecord &folder1 = m_folderRecords.at(pair.folder1);
+    const FolderRecord &folder2 = m_folderRecords.at(pair.folder2);
+    const double similarity = static_cast<double>(pair.intersection) / pair.unionSize;
+
+    DuplicateIssue issue;
+    issue.type = DuplicateType::PartialDuplicate;
+    issue.primaryFolder = folder1.folderPath;
+    issue.duplicateFolder = folder2.folderPath;
+    issue.similarity = similarity;
+    issue.totalFiles = qMax(folder1.fileCount, folder2.fileCount);
+    issue.duplicateFiles = qRound(similarity * issue.totalFiles);
+    issue.wastedSpace = qRound64(similarity * qMin(folder1.totalSize, folder2.totalSize));
+    issue.severity = SEVERITY_LOW;
+    issue.description = formatIssueDescription(issue);
+    return issue;
+}
+
+void DuplicateAnalyzer::applyPartialThreshold()
+{
+    // Exact matches do not depend on the threshold; partial ones are rebuilt
+    m_duplicateIssues.removeIf([](const DuplicateIssue &issue) {
+        return issue.type == DuplicateType::PartialDuplicate;
+    });
+
+    const int exactCount = m_duplicateIssues.size();
+    for (const PairResult &pair : std::as_const(m_pairResults)) {
+        if (pair.type == DuplicateType::PartialDuplicate &&
+            static_cast<double>(pair.intersection) / pair.unionSize >= m_partialThreshold) {
+            m_duplicateIssues.append(createPartialIssue(pair));
+        }
+    }
+
+    // Most similar first, then most wasted space
+    std::sort(m_duplicateIssues.begin() + exactCount, m_duplicateIssues.end(),
+              [](const DuplicateIssue &a, const DuplicateIssue &b) {
+                  return a.similarity != b.similarity ? a.similarity > b.similarity
+                                                      : a.wastedSpace > b.wastedSpace;
+              });
+
+    updateIssuesTree();
+    updateDetailsPanel();
+    m_statusLabel->setText(QString("%1 issues at %2% partial match threshold")
+                               .arg(m_duplicateIssues.size())
+                               .arg(qRound(m_partialThreshold * 100)));
+}
+
+// === Private Methods - Stored Results ===
+
+QList<ProjectManager::DuplicatePairRecord> DuplicateAnalyzer::loadStoredAnalysis()
+{
+    m_storedFolders.clear();
+    m_storedPairs.clear();
+    m_storedExactPairs.clear();
+
+    if (!m_projectManager || !m_projectManager->hasOpenProject()) {
+        return QList<ProjectManager::DuplicatePairRecord>();
+    }
+
+    const QList<FolderRecord> folders = m_projectManager->getDuplicateFolders();
+    for (const FolderRecord &folder : folders) {
+        m_storedFolders.insert(folder.folderPath, folder);
+    }
+
+    const QList<ProjectManager::DuplicatePairRecord> pairs = m_projectManager->getDuplicatePairs();
+    for (const auto &pair : pairs) {
+        m_storedPairs.insert(pairKey(pair.folder1, pair.folder2), pair);
+        if (pair.matchType == static_cast<int>(DuplicateType::ExactComplete)) {
+            m_storedExactPairs.append(qMakePair(pair.folder1, pair.folder2));
+        }
+    }
+    return pairs;
+}
+
+void DuplicateAnalyzer::restoreStoredResults()
+{
+    const QList<ProjectManager::DuplicatePairRecord> pairs = loadStoredAnalysis();
+    if (pairs.isEmpty()) {
+        return;
+    }
+
+    // Rebuilt in the stored order, so clusters come out in a stable order
+    for (const auto &stored : pairs) {
+        PairResult pair;
+        pair.folder1 = folderRecordId(stored.folder1);
+        pair.folder2 = folderRecordId(stored.folder2);
+        pair.type = static_cast<DuplicateType>(stored.matchType);
+        pair.intersection = stored.intersection;
+        pair.unionSize = stored.unionSize;
+        addPairResult(pair);
+    }
+    clusterDuplicateIssues();
+
+    updateIssuesTree();
+    const QDateTime analyzed = m_projectManager->getProjectValue(KEY_LAST_ANALYSIS).toDateTime();
+    m_statusLabel->setText(QString("%1 issues from the analysis of %2 - refresh to check for changes")
+                               .arg(m_duplicateIssues.size())
+                               .arg(QLocale().toString(analyzed, QLocale::ShortFormat)));
+}
+
+void DuplicateAnalyzer::saveAnalysisResults(const QStringList &projectFolders)
+{
+    if (!m_projectManager || !m_projectManager->hasOpenProject()) {
+        return;
+    }
+
+    // Changed folders are stored with their new fingerprint when their content
+    // was scanned; the others are dropped and count as changed next time
+    QList<FolderRecord> changedFolders;
+    QStringList removedFolders;
+    const QSet<QString> currentFolders(projectFolders.cbegin(), projectFolders.cend());
+    for (const QString &folder : currentFolders) {
+        if (isFolderUnchanged(folder)) {
+            continue;
+        }
+
+        // Out-of-core results only have the totals of their folders
+        auto content = m_folderContentCache.constFind(folder);
+        auto recordId = m_folderRecordIds.constFind(folder);
+        FolderRecord record;
+        if (content != m_folderContentCache.constEnd()) {
+            record.folderPath = folder;
+            record.fileCount = content->allFiles.size();
+            record.totalSize = content->totalSize;
+            record.subfolders = content->allSubfolders;
+        } else if (recordId != m_folderRecordIds.constEnd()) {
+            record = m_folderRecords.at(recordId.value());
+        } else {
+            if (m_storedFolders.contains(folder)) {
+                removedFolders.append(folder);
+            }
+            continue;
+        }
+        record.fingerprint = m_folderFingerprints.value(folder);
+        changedFolders.append(record);
+    }
+    for (auto it = m_storedFolders.constBegin(); it != m_storedFolders.constEnd(); ++it) {
+        if (!currentFolders.contains(it.key())) {
+            removedFolders.append(it.key());
+        }
+    }
+
+    // Pair results are diffed against the stored ones: a refresh that only
+    // touched a few folders rewrites only the pairs that involve them
+    QList<ProjectManager::DuplicatePairRecord> changedPairs;
+    QList<ProjectManager::DuplicatePairRecord> removedPairs;
+    QSet<QString> currentPairs;
+    for (const PairResult &pair : std::as_const(m_pairResults)) {
+        ProjectManager::DuplicatePairRecord record;
+        record.folder1 = m_folderRecords.at(pair.folder1).folderPath;
+        record.folder2 = m_folderRecords.at(pair.folder2).folderPath;
+        record.matchType = static_cast<int>(pair.type);
+        record.intersection = pair.intersection;
+        record.unionSize = pair.unionSize;
+
+        const QString key = pairKey(record.folder1, record.folder2);
+        currentPairs.insert(key);
+        auto stored = m_storedPairs.constFind(key);
+        if (stored != m_storedPairs.constEnd()) {
+            if (stored->matchType == record.matchType && stored->intersection == record.intersection &&
+                stored->unionSize == record.unionSize) {
+                continue;
+            }
+            removedPairs.append(stored.value());
+        }
+        changedPairs.append(record);
+    }
+    for (auto it = m_storedPairs.constBegin(); it != m_storedPairs.constEnd(); ++it) {
+        if (!currentPairs.contains(it.key())) {
+            removedPairs.append(it.value());
+        }
+    }
+
+    if (m_projectManager->saveDuplicateAnalysis(changedFolders, removedFolders, changedPairs, removedPairs)) {
+        m_projectManager->setProjectValue(KEY_LAST_ANALYSIS, QDateTime::currentDateTime());
+    }
+}
+
+void DuplicateAnalyzer::computeFolderFingerprints(const QStringList &folders)
+{
+    m_folderFingerprints.clear();
+    m_statusLabel->setText("Checking folders for changes...");
+
+    // Folders are listed parents first; walking the list backwards hashes
+    // every subfolder before its parent, which folds them into its own
+    // fingerprint. A folder's fingerprint thus changes with anything below it.
+    QHash<QString, QStringList> childFingerprints;
+    for (int i = folders.size() - 1; i >= 0; --i) {
+        const QString &folder = folders.at(i);
+
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        hash.addData(signatureScheme().toUtf8());
+
+        const QFileInfoList files = QDir(folder).entryInfoList(QDir::Files, QDir::Name);
+        for (const QFileInfo &file : files) {
+            if (SUPPORTED_EXTENSIONS.contains(file.suffix().toLower())) {
+                hash.addData(QString("%1|%2|%3\n")
+                                 .arg(file.fileName())
+                                 .arg(file.size())
+                                 .arg(file.lastModified().toMSecsSinceEpoch())
+                                 .toUtf8());
+            }
+        }
+
+        QStringList children = childFingerprints.take(folder);
+        children.sort();
+        for (const QString &child : std::as_const(children)) {
+            hash.addData(child.toUtf8());
+        }
+
+        const QString fingerprint = QString::fromLatin1(hash.result().toHex());
+        m_folderFingerprints.insert(folder, fingerprint);
+
+        const QFileInfo folderInfo(folder);
+        childFingerprints[folderInfo.absolutePath()].append(folderInfo.fileName() + '|' + fingerprint);
+
+        if (i % FINGERPRINTS_PER_EVENT_UPDATE == 0) {
+            QApplication::processEvents();
+            if (!m_analysisRunning) {
+                return;
+            }
+        }
+    }
+}
+
+bool DuplicateAnalyzer::isFolderUnchanged(const QString &folderPath) const
+{
+    auto stored = m_storedFolders.constFind(folderPath);
+    return stored != m_storedFolders.constEnd() &&
+           stored->fingerprint == m_folderFingerprints.value(folderPath);
+}
+
+bool DuplicateAnalyzer::reuseStoredResult(const QString &folder1, const QString &folder2,
+                                          const QStringList &storedCovering)
+{
+    auto stored = m_storedPairs.constFind(pairKey(folder1, folder2));
+    if (stored != m_storedPairs.constEnd()) {
+        PairResult pair;
+        pair.folder1 = folderRecordId(folder1);
+        pair.folder2 = folderRecordId(folder2);
+        pair.type = static_cast<DuplicateType>(stored->matchType);
+        pair.intersection = stored->intersection;
+        pair.unionSize = stored->unionSize;
+        addPairResult(pair);
+        return true;
+    }
+
+    // No stored result means no match - unless the pair was skipped as the
+    // twin pair of an exact match that no longer covers it
+    return !storedCovering.contains(folder2);
+}
+
+QString DuplicateAnalyzer::pairKey(const QString &folder1, const QString &folder2)
+{
+    // Order independent: the folder list may be ordered differently next time
+    return folder1 < folder2 ? folder1 + '\n' + folder2 : folder2 + '\n' + folder1;
+}
+
+// === Private Methods - Out-of-Core Analysis ===
+
+bool DuplicateAnalyzer::shouldAnalyzeOutOfCore() const
+{
+    // Every folder holds its whole subtree, so the cache grows with the
+    // file count times the folder depth - which is what Phase 1 counted
+    const qint64 estimatedBytes = folderContentCacheBytes() +
+                                  static_cast<qint64>(m_totalFilesToAnalyze) * FOLDER_CACHE_BYTES_PER_ENTRY;
+    return estimatedBytes > MemoryGovernor::instance()->effectiveBudget();
+}
+
+void DuplicateAnalyzer::analyzeOutOfCore(const QStringList &folders)
+{
+    // Only per-folder totals are kept in memory. Overlaps are counted from
+    // sorted runs on disk, which cannot tell whether a pair changed, so
+    // nothing of this run is reused incrementally.
+    m_folderContentCache.clear();
+    m_folderFingerprints.clear();
+
+    auto fail = [this](const QString &error) {
+        qWarning() << "Out-of-core duplicate analysis failed:" << error;
+        QMessageBox::warning(this, "Analysis Failed",
+                             QString("The analysis could not use its temporary files:\n%1").arg(error));
+        m_analysisRunning = false;
+    };
+
+    const QString tempPath = m_projectManager && m_projectManager->hasOpenProject()
+                                 ? m_projectManager->currentProjectPath()
+                                 : QDir::tempPath();
+    const qint64 sortMemory = MemoryGovernor::instance()->effectiveBudget() / OUT_OF_CORE_SORT_SHARE;
+
+    // (signature, folder) for every file and every folder containing it
+    QList<OutOfCoreFolder> stats = buildOutOfCoreFolders(folders);
+    ExternalSorter signatures(tempPath, sortMemory);
+    if (!spillFolderSignatures(folders, stats, signatures) || !signatures.finish()) {
+        fail(signatures.errorString());
+        return;
+    }
+    if (!m_analysisRunning) {
+        return;
+    }
+
+    // (folder1, folder2) once per shared signature
+    m_statusLabel->setText(QString("%1 analysis: counting shared files...").arg(getModeName(m_currentMode)));
+    m_progressBar->setValue(60);
+    ExternalSorter pairs(tempPath, sortMemory);
+    if (!spillOverlapPairs(signatures, stats, pairs)) {
+        fail(signatures.errorString().isEmpty() ? pairs.errorString() : signatures.errorString());
+        return;
+    }
+    if (!m_analysisRunning) {
+        return;
+    }
+    if (!pairs.finish()) {
+        fail(pairs.errorString());
+        return;
+    }
+
+    m_progressBar->setValue(70);
+    QList<PairResult> matches = findOutOfCoreMatches(stats, pairs);
+    if (!pairs.errorString().isEmpty()) {
+        fail(pairs.errorString());
+        return;
+    }
+
+    // Equal content hashes only nominate exact matches; the sorted
+    // signatures confirm them
+    if (!verifyExactMatches(signatures, folders, stats, matches)) {
+        fail(signatures.errorString());
+        return;
+    }
+    if (!m_analysisRunning) {
+        return;
+    }
+
+    addOutOfCoreMatches(folders, stats, std::move(matches));
+}
+
+QList<DuplicateAnalyzer::OutOfCoreFolder> DuplicateAnalyzer::buildOutOfCoreFolders(const QStringList &folders)
+{
+    // The list is pre-order, so a folder's descendants directly follow it
+    QList<OutOfCoreFolder> stats(folders.size());
+    QSet<QString> seen;
+    QList<int> ancestors;
+    for (int i = 0; i < folders.size(); ++i) {
+        const QString &folder = folders.at(i);
+        if (seen.contains(folder)) {
+            stats[i].repeated = true;
+            stats[i].subtreeEnd = i + 1;
+            continue;
+        }
+        seen.insert(folder);
+
+        while (!ancestors.isEmpty() && !isSameOrInside(folder, folders.at(ancestors.last()))) {
+            stats[ancestors.takeLast()].subtreeEnd = i;
+        }
+        stats[i].parent = ancestors.isEmpty() ? -1 : ancestors.last();
+        ancestors.append(i);
+    }
+    while (!ancestors.isEmpty()) {
+        stats[ancestors.takeLast()].subtreeEnd = folders.size();
+    }
+    return stats;
+}
+
+bool DuplicateAnalyzer::spillFolderSignatures(const QStringList &folders, QList<OutOfCoreFolder> &stats,
+                                              ExternalSorter &signatures)
+{
+    // Each file is read once, in its own folder; its signature is added to
+    // that folder and all its ancestors
+    for (int i = 0; i < folders.size(); ++i) {
+        if (!m_analysisRunning) {
+            return true;
+        }
+        if (stats.at(i).repeated) {
+            continue;
+        }
+
+        const QDir dir(folders.at(i));
+        QStringList imagePaths;
+        const QStringList files = dir.entryList(QDir::Files, QDir::Name);
+        for (const QString &fileName : files) {
+            if (SUPPORTED_EXTENSIONS.contains(QFileInfo(fileName).suffix().toLower())) {
+                imagePaths.append(dir.absoluteFilePath(fileName));
+            }
+        }
+
+        for (int start = 0; start < imagePaths.size(); start += ANALYSIS_BATCH_SIZE) {
+            const QStringList batch = imagePaths.mid(start, ANALYSIS_BATCH_SIZE);
+            const QList<FileInfo> infos = analyzeFiles(batch);
+
+            for (int f = 0; f < batch.size(); ++f) {
+                const FileInfo &info = infos.at(f);
+                const quint64 signature = stringHash(fileSignature(info));
+                stats[i].directHash += mixHash(stringHash(QFileInfo(batch.at(f)).fileName()) ^ mixHash(signature));
+
+                for (int folder = i; folder >= 0; folder = stats.at(folder).parent) {
+                    OutOfCoreFolder &stat = stats[folder];
+                    stat.fileCount++;
+                    stat.totalSize += info.fileSize;
+                    stat.contentHash += mixHash(signature);
+                    stat.contentHash2 += mixHash(signature ^ SECOND_HASH_SEED);
+                    if (!signatures.add({signature, static_cast<quint64>(folder)})) {
+                        return false;
+                    }
+                }
+                m_filesAnalyzed++;
+            }
+
+            QApplication::processEvents();
+            if (!m_analysisRunning) {
+                return true;
+            }
+        }
+
+        m_progressBar->setValue(10 + (i * 50) / qMax(1, static_cast<int>(folders.size())));
+        m_statusLabel->setText(QString("%1 analysis (out of core): %2 files, folder %3/%4")
+                                   .arg(getModeName(m_currentMode))
+                                   .arg(m_filesAnalyzed)
+                                   .arg(i + 1)
+                                   .arg(folders.size()));
+        QApplication::processEvents();
+    }
+
+    // Subfolders come last: fold each folder's named structure into its parent
+    QList<quint64> childHashes(folders.size(), 0);
+    for (int i = folders.size() - 1; i >= 0; --i) {
+        OutOfCoreFolder &stat = stats[i];
+        if (stat.repeated) {
+            continue;
+        }
+        stat.structureHash = mixHash(stat.directHash + mixHash(childHashes.at(i)));
+        if (stat.parent >= 0) {
+            childHashes[stat.parent] += mixHash(stringHash(QFileInfo(folders.at(i)).fileName()) ^ stat.structureHash);
+        }
+    }
+    return true;
+}
+
+bool DuplicateAnalyzer::spillOverlapPairs(ExternalSorter &signatures, QList<OutOfCoreFolder> &stats,
+                                          ExternalSorter &pairs)
+{
+    // Pass 1: distinct signatures per folder, the set sizes of the Jaccard similarity
+    ExternalSorter::Record record;
+    ExternalSorter::Record previous{0, 0};
+    qint64 processed = 0;
+    while (signatures.next(record)) {
+        if (processed == 0 || record.key != previous.key || record.value != previous.value) {
+            stats[static_cast<int>(record.value)].signatureCount++;
+        }
+        previous = record;
+        if (++processed % RECORDS_PER_EVENT_UPDATE == 0) {
+            QApplication::processEvents();
+            if (!m_analysisRunning) {
+                return true;
+            }
+        }
+    }
+    if (!signatures.errorString().isEmpty() || !signatures.rewind()) {
+        return false;
+    }
+
+    // Pass 2: each group of folders sharing a signature yields its pairs.
+    // Nested pairs are never reported, and pairs whose set sizes alone rule
+    // out the lowest threshold are dropped before they reach the disk.
+    QList<int> group;
+    quint64 groupKey = 0;
+    auto flushGroup = [&]() {
+        if (group.size() > MAX_SIGNATURE_FOLDERS) {
+            m_droppedSignatures++;
+            return true;
+        }
+        for (int x = 0; x < group.size(); ++x) {
+            const int folder1 = group.at(x);
+            const OutOfCoreFolder &stat1 = stats.at(folder1);
+            for (int y = x + 1; y < group.size(); ++y) {
+                const int folder2 = group.at(y);
+                const OutOfCoreFolder &stat2 = stats.at(folder2);
+                if (folder2 < stat1.subtreeEnd ||
+                    qMin(stat1.signatureCount, stat2.signatureCount) <
+                        MIN_PARTIAL_THRESHOLD * qMax(stat1.signatureCount, stat2.signatureCount)) {
+                    continue;
+                }
+                if (!pairs.add({(static_cast<quint64>(folder1) << 32) | static_cast<quint64>(folder2), 0})) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    processed = 0;
+    while (signatures.next(record)) {
+        const int folder = static_cast<int>(record.value);
+        if (processed > 0 && record.key == groupKey) {
+            if (group.last() != folder) {
+                group.append(folder);
+            }
+        } else {
+            if (!group.isEmpty() && !flushGroup()) {
+                return false;
+            }
+            groupKey = record.key;
+            group = {folder};
+        }
+
+        if (++processed % RECORDS_PER_EVENT_UPDATE == 0) {
+            QApplication::processEvents();
+            if (!m_analysisRunning) {
+                return true;
+            }
+        }
+    }
+    if (!group.isEmpty() && !flushGroup()) {
+        return false;
+    }
+
+    return signatures.errorString().isEmpty();
+}
+
+QList<DuplicateAnalyzer::PairResult> DuplicateAnalyzer::findOutOfCoreMatches(const QList<OutOfCoreFolder> &stats,
+                                                                             ExternalSorter &pairs)
+{
+    // Folders of the returned pairs are indices into the folder list
+    QList<PairResult> matches;
+
+    // Exact duplicates share their hashes
+    QHash<quint64, QList<int>> byStructure;
+    QHash<QPair<quint64, quint64>, QList<int>> byContent;
+    for (int i = 0; i < stats.size(); ++i) {
+        const OutOfCoreFolder &stat = stats.at(i);
+        if (stat.repeated || stat.fileCount == 0) {
+            continue;
+        }
+        byStructure[stat.structureHash].append(i);
+        byContent[qMakePair(stat.contentHash ^ mixHash(stat.fileCount), stat.contentHash2)].append(i);
+    }
+
+    auto addExactPairs = [&](const QList<int> &group, DuplicateType type) {
+        for (int x = 0; x < group.size(); ++x) {
+            const OutOfCoreFolder &stat1 = stats.at(group.at(x));
+            for (int y = x + 1; y < group.size(); ++y) {
+                const int folder2 = group.at(y);
+                if (folder2 < stat1.subtreeEnd ||
+                    (type == DuplicateType::ExactFilesOnly &&
+                     stat1.structureHash == stats.at(folder2).structureHash)) {
+                    continue;
+                }
+                matches.append({group.at(x), folder2, type});
+            }
+        }
+    };
+    for (const QList<int> &group : std::as_const(byStructure)) {
+        addExactPairs(group, DuplicateType::ExactComplete);
+    }
+    for (const QList<int> &group : std::as_const(byContent)) {
+        addExactPairs(group, DuplicateType::ExactFilesOnly);
+    }
+
+    // Partial candidates: a run of equal pair records counts their shared
+    // signatures. Exact candidates get one too, in case verification rejects them.
+    auto addCandidate = [&](quint64 key, int shared) {
+        const int folder1 = static_cast<int>(key >> 32);
+        const int folder2 = static_cast<int>(key & 0xffffffffULL);
+        const OutOfCoreFolder &stat1 = stats.at(folder1);
+        const OutOfCoreFolder &stat2 = stats.at(folder2);
+        const int unionSize = stat1.signatureCount + stat2.signatureCount - shared;
+        if (unionSize > 0 && shared >= MIN_PARTIAL_THRESHOLD * unionSize) {
+            matches.append({folder1, folder2, DuplicateType::PartialDuplicate, shared, unionSize});
+        }
+    };
+
+    ExternalSorter::Record record;
+    quint64 pairKey = 0;
+    int shared = 0;
+    while (pairs.next(record)) {
+        if (shared > 0 && record.key == pairKey) {
+            shared++;
+            continue;
+        }
+        if (shared > 0) {
+            addCandidate(pairKey, shared);
+        }
+        pairKey = record.key;
+        shared = 1;
+    }
+    if (shared > 0) {
+        addCandidate(pairKey, shared);
+    }
+
+    return matches;
+}
+
+bool DuplicateAnalyzer::verifyExactMatches(ExternalSorter &signatures, const QStringList &folders,
+                                           const QList<OutOfCoreFolder> &stats, QList<PairResult> &matches)
+{
+    auto pairKey = [](int folder1, int folder2) {
+        return (static_cast<quint64>(folder1) << 32) | static_cast<quint64>(folder2);
+    };
+
+    QHash<int, QList<int>> candidatesByFolder;   // Folder -> indices of its exact candidates
+    for (int m = 0; m < matches.size(); ++m) {
+        const PairResult &match = matches.at(m);
+        if (match.type != DuplicateType::PartialDuplicate) {
+            candidatesByFolder[match.folder1].append(m);
+            candidatesByFolder[match.folder2].append(m);
+        }
+    }
+    if (candidatesByFolder.isEmpty()) {
+        return true;
+    }
+
+    // Both folders of an exact match hold every signature equally often;
+    // each run of equal signatures is checked on its own
+    QList<bool> rejected(matches.size(), false);
+    QHash<int, int> counts;   // Candidate folder -> files with the current signature
+    auto checkRun = [&]() {
+        for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+            for (int m : candidatesByFolder.value(it.key())) {
+                const PairResult &match = matches.at(m);
+                const int other = match.folder1 == it.key() ? match.folder2 : match.folder1;
+                if (counts.value(other) != it.value()) {
+                    rejected[m] = true;
+                }
+            }
+        }
+        counts.clear();
+    };
+
+    if (!signatures.rewind()) {
+        return false;
+    }
+    ExternalSorter::Record record;
+    quint64 runKey = 0;
+    qint64 processed = 0;
+    while (signatures.next(record)) {
+        if (processed > 0 && record.key != runKey) {
+            checkRun();
+        }
+        runKey = record.key;
+        const int folder = static_cast<int>(record.value);
+        if (candidatesByFolder.contains(folder)) {
+            counts[folder]++;
+        }
+
+        if (++processed % RECORDS_PER_EVENT_UPDATE == 0) {
+            QApplication::processEvents();
+            if (!m_analysisRunning) {
+                return true;
+            }
+        }
+    }
+    checkRun();
+    if (!signatures.errorString().isEmpty()) {
+        return false;
+    }
+
+    // Exact complete also needs the same subfolders, which the structure
+    // hash alone does not prove
+    auto subfolderPaths = [&](int folder) {
+        QStringList paths;
+        for (int sub = folder + 1; sub < stats.at(folder).subtreeEnd; ++sub) {
+            if (!stats.at(sub).repeated) {
+                paths.append(getRelativePath(folders.at(sub), folders.at(folder)));
+            }
+        }
+        paths.sort();
+        return paths;
+    };
+
+    QList<PairResult> verified;
+    QSet<quint64> exactPairs;
+    for (int m = 0; m < matches.size(); ++m) {
+        PairResult match = matches.at(m);
+        if (match.type == DuplicateType::PartialDuplicate || rejected.at(m)) {
+            continue;
+        }
+        if (match.type == DuplicateType::ExactComplete &&
+            subfolderPaths(match.folder1) != subfolderPaths(match.folder2)) {
+            match.type = DuplicateType::ExactFilesOnly;
+        }
+        exactPairs.insert(pairKey(match.folder1, match.folder2));
+        verified.append(match);
+    }
+
+    // A rejected candidate is still reported if it overlaps enough
+    for (const PairResult &match : std::as_const(matches)) {
+        if (match.type == DuplicateType::PartialDuplicate &&
+            !exactPairs.contains(pairKey(match.folder1, match.folder2))) {
+            verified.append(match);
+        }
+    }
+
+    matches = verified;
+    return true;
+}
+
+void DuplicateAnalyzer::addOutOfCoreMatches(const QStringList &folders, const QList<OutOfCoreFolder> &stats,
+                                            QList<PairResult> matches)
+{
+    // The walk of analyzeFolderPairs(), over the matching pairs only: in
+    // folder list order, pairs implied by an earlier exact match collapse into it
+    std::sort(matches.begin(), matches.end(), [](const PairResult &a, const PairResult &b) {
+        return a.folder1 != b.folder1 ? a.folder1 < b.folder1 : a.folder2 < b.folder2;
+    });
+
+    auto recordId = [&](int folder) {
+        auto it = m_folderRecordIds.constFind(folders.at(folder));
+        if (it != m_folderRecordIds.constEnd()) {
+            return it.value();
+        }
+        FolderRecord record;
+        record.folderPath = folders.at(folder);
+        record.fileCount = stats.at(folder).fileCount;
+        record.totalSize = stats.at(folder).totalSize;
+        return addFolderRecord(record);
+    };
+
+    QList<int> exactIssues;
+    QList<QPair<int, QString>> covering;
+    int coveringFolder = -1;
+    for (int m = 0; m < matches.size(); ++m) {
+        const PairResult &match = matches.at(m);
+        const QString &folder1 = folders.at(match.folder1);
+        const QString &folder2 = folders.at(match.folder2);
+
+        if (match.folder1 != coveringFolder) {
+            coveringFolder = match.folder1;
+            covering.clear();
+            for (int issueIndex : std::as_const(exactIssues)) {
+                const DuplicateIssue &issue = m_duplicateIssues.at(issueIndex);
+                if (isSameOrInside(folder1, issue.primaryFolder)) {
+                    covering.append(qMakePair(issueIndex, twinPath(folder1, issue.primaryFolder, issue.duplicateFolder)));
+                } else if (isSameOrInside(folder1, issue.duplicateFolder)) {
+                    covering.append(qMakePair(issueIndex, twinPath(folder1, issue.duplicateFolder, issue.primaryFolder)));
+                }
+            }
+        }
+
+        // Only the twin of folder1 is implied; other pairs across the two
+        // subtrees are reported on their own
+        const bool covered = std::any_of(covering.cbegin(), covering.cend(), [&](const QPair<int, QString> &cover) {
+            return folder2 == cover.second;
+        });
+        if (covered) {
+            continue;
+        }
+
+        PairResult pair = match;
+        pair.folder1 = recordId(match.folder1);
+        pair.folder2 = recordId(match.folder2);
+
+        // Twin subfolders are the primary's descendants in the folder list
+        FolderRecord &primary = m_folderRecords[pair.folder1];
+        if (match.type == DuplicateType::ExactComplete && primary.subfolders.isEmpty()) {
+            for (int sub = match.folder1 + 1; sub < stats.at(match.folder1).subtreeEnd; ++sub) {
+                if (!stats.at(sub).repeated) {
+                    primary.subfolders.append(getRelativePath(folders.at(sub), folder1));
+                }
+            }
+        }
+
+        addPairResult(pair);
+
+        if (match.type == DuplicateType::ExactComplete) {
+            // Each subfolder of folder1 pairs with its twin in folder2
+            const int issueIndex = m_duplicateIssues.size() - 1;
+            m_duplicateIssues[issueIndex].nestedPairs = stats.at(match.folder1).subtreeEnd - match.folder1 - 1;
+            exactIssues.append(issueIndex);
+            covering.append(qMakePair(issueIndex, folder2));
+        }
+
+        if (m % MATCHES_PER_EVENT_UPDATE == 0) {
+            m_progressBar->setValue(70 + (m * 30) / qMax(1, static_cast<int>(matches.size())));
+            QApplication::processEvents();
+        }
+    }
+}
+
 // === Private Methods - Results Management ===
 
 void DuplicateAnalyzer::addDuplicateIssue(const DuplicateIssue &issue)
@@ -887,6 +2127,133 @@ void DuplicateAnalyzer::addDuplicateIssue(const DuplicateIssue &issue)
     m_duplicateIssues.append(issue);
 }
 
+void DuplicateAnalyzer::clusterDuplicateIssues()
+{
+    // Exact duplication is an equivalence: five copies of a folder are one
+    // cluster, not ten pairs. Partial overlap is not transitive and stays pairwise.
+    DisjointSets sets;
+    QHash<QString, int> folderIds;
+    QStringList folders;
+    auto folderId = [&](const QString &folder) {
+        auto it = folderIds.constFind(folder);
+        if (it != folderIds.constEnd()) {
+            return it.value();
+        }
+        folders.append(folder);
+        return folderIds.insert(folder, sets.add()).value();
+    };
+
+    QList<DuplicateIssue> pairIssues;
+    QList<DuplicateIssue> exactIssues;
+    for (const DuplicateIssue &issue : std::as_const(m_duplicateIssues)) {
+        if (issue.type == DuplicateType::PartialDuplicate) {
+            pairIssues.append(issue);
+            continue;
+        }
+        sets.unite(folderId(issue.primaryFolder), folderId(issue.duplicateFolder));
+        exactIssues.append(issue);
+    }
+
+    if (exactIssues.isEmpty()) {
+        return;
+    }
+
+    // One issue per cluster; a files-only edge makes the whole cluster files-only
+    QHash<int, DuplicateIssue> clusters;
+    QList<int> clusterOrder;
+    for (const DuplicateIssue &edge : std::as_const(exactIssues)) {
+        const int root = sets.find(folderIds.value(edge.primaryFolder));
+        auto it = clusters.find(root);
+        if (it == clusters.end()) {
+            it = clusters.insert(root, edge);
+            it->nestedPairs = 0;
+            clusterOrder.append(root);
+        } else if (edge.type == DuplicateType::ExactFilesOnly) {
+            it->type = DuplicateType::ExactFilesOnly;
+        }
+        it->nestedPairs += edge.nestedPairs;
+    }
+
+    for (int id = 0; id < folders.size(); ++id) {
+        clusters[sets.find(id)].clusterFolders.append(folders.at(id));
+    }
+
+    m_duplicateIssues.clear();
+    for (int root : std::as_const(clusterOrder)) {
+        DuplicateIssue &cluster = clusters[root];
+        finalizeCluster(cluster);
+        m_duplicateIssues.append(cluster);
+    }
+    m_duplicateIssues.append(pairIssues);
+
+    qDebug() << "Grouped" << exactIssues.size() << "exact duplicate pairs into"
+             << clusterOrder.size() << "clusters";
+}
+
+void DuplicateAnalyzer::finalizeCluster(DuplicateIssue &cluster)
+{
+    std::sort(cluster.clusterFolders.begin(), cluster.clusterFolders.end());
+    cluster.primaryFolder = cluster.clusterFolders.first();
+    cluster.duplicateFolder = cluster.clusterFolders.value(1);
+
+    // Twin subfolders only line up when every copy has the same structure
+    if (cluster.type != DuplicateType::ExactComplete) {
+        cluster.nestedFolders.clear();
+    }
+
+    // Reclaimable bytes: every distinct file of the cluster except the kept
+    // copy's. Counting paths once keeps copies that overlap on disk honest.
+    QHash<QString, qint64> fileSizes;
+    QSet<QString> keptFiles;
+    for (const QString &folder : std::as_const(cluster.clusterFolders)) {
+        const FolderContent content = m_folderContentCache.value(folder);
+        const QDir dir(folder);
+        for (const QString &relativePath : content.allFiles) {
+            const QString filePath = dir.filePath(relativePath);
+            fileSizes.insert(filePath, content.fileInfo.value(relativePath).fileSize);
+            if (folder == cluster.primaryFolder) {
+                keptFiles.insert(filePath);
+            }
+        }
+    }
+
+    qint64 reclaimable = 0;
+    int redundantFiles = 0;
+    for (auto it = fileSizes.constBegin(); it != fileSizes.constEnd(); ++it) {
+        if (!keptFiles.contains(it.key())) {
+            reclaimable += it.value();
+            redundantFiles++;
+        }
+    }
+    int keptFileCount = keptFiles.size();
+
+    // Restored clusters may lack cached content; fall back to folder totals
+    const bool contentComplete = std::all_of(cluster.clusterFolders.cbegin(), cluster.clusterFolders.cend(),
+                                             [this](const QString &folder) {
+                                                 return m_folderContentCache.contains(folder);
+                                             });
+    if (!contentComplete) {
+        reclaimable = 0;
+        redundantFiles = 0;
+        for (const QString &folder : std::as_const(cluster.clusterFolders)) {
+            const FolderRecord &record = m_folderRecords.at(folderRecordId(folder));
+            if (folder == cluster.primaryFolder) {
+                keptFileCount = record.fileCount;
+            } else {
+                reclaimable += record.totalSize;
+                redundantFiles += record.fileCount;
+            }
+        }
+    }
+
+    cluster.similarity = 1.0;
+    cluster.totalFiles = keptFileCount;
+    cluster.duplicateFiles = redundantFiles;
+    cluster.wastedSpace = reclaimable;
+    cluster.severity = cluster.type == DuplicateType::ExactComplete ? SEVERITY_HIGH : SEVERITY_MEDIUM;
+    cluster.description = formatIssueDescription(cluster);
+}
+
 void DuplicateAnalyzer::updateIssuesTree()
 {
     m_issuesTree->clear();
@@ -896,17 +2263,31 @@ void DuplicateAnalyzer::updateIssuesTree()
         return;
     }
 
-    m_issuesCountLabel->setText(QString("%1 duplicate folder issues found (%2 mode)")
-                                    .arg(m_duplicateIssues.size())
-                                    .arg(getModeName(m_currentMode)));
+    int nestedPairs = 0;
+    for (const DuplicateIssue &issue : std::as_const(m_duplicateIssues)) {
+        nestedPairs += issue.nestedPairs;
+    }
+
+    QString countText = QString("%1 duplicate folder issues found (%2 mode)")
+                            .arg(m_duplicateIssues.size())
+                            .arg(getModeName(m_currentMode));
+    if (nestedPairs > 0) {
+        countText += QString(", %1 nested pairs collapsed").arg(nestedPairs);
+    }
+    m_issuesCountLabel->setText(countText);
 
-    for (const DuplicateIssue &issue : m_duplicateIssues) {
+    for (int issueIndex = 0; issueIndex < m_duplicateIssues.size(); ++issueIndex) {
+        const DuplicateIssue &issue = m_duplicateIssues.at(issueIndex);
         QTreeWidgetItem *item = new QTreeWidgetItem(m_issuesTree);
 
-        // Set item data
+        // Set item data; the index survives sorting
+        item->setData(COL_SEVERITY, ISSUE_INDEX_ROLE, issueIndex);
         item->setText(COL_SEVERITY, issue.severity);
         item->setText(COL_TYPE, getTypeDisplayName(issue.type));
-        item->setText(COL_DESCRIPTION, issue.description);
+        item->setText(COL_DESCRIPTION, issue.nestedPairs > 0
+                                           ? QString("%1 (+%2 nested)").arg(issue.description)
+                                                 .arg(issue.nestedPairs)
+                                           : issue.description);
         item->setText(COL_SIMILARITY, QString("%1%").arg(qRound(issue.similarity * 100)));
         item->setText(COL_WASTED_SPACE, formatFileSize(issue.wastedSpace));
 
@@ -925,6 +2306,32 @@ void DuplicateAnalyzer::updateIssuesTree()
         } else {
             item->setBackground(COL_SEVERITY, QBrush(QColor(200, 255, 200))); // Light green
         }
+
+        // Further copies of a cluster, expandable under it
+        for (int i = 2; i < issue.clusterFolders.size(); ++i) {
+            const QString &copy = issue.clusterFolders.at(i);
+            QTreeWidgetItem *child = new QTreeWidgetItem(item);
+            child->setData(COL_SEVERITY, ISSUE_INDEX_ROLE, issueIndex);
+            child->setData(COL_SEVERITY, CLUSTER_COPY_ROLE, copy);
+            child->setText(COL_TYPE, getTypeDisplayName(issue.type));
+            child->setText(COL_DESCRIPTION, QString("Copy: %1").arg(copy));
+        }
+
+        // Twin subfolders covered by an exact match, expandable under it
+        const int listed = qMin<int>(issue.nestedFolders.size(), MAX_NESTED_ITEMS);
+        for (int i = 0; i < listed; ++i) {
+            const QString &relativePath = issue.nestedFolders.at(i);
+            QTreeWidgetItem *child = new QTreeWidgetItem(item);
+            child->setData(COL_SEVERITY, ISSUE_INDEX_ROLE, issueIndex);
+            child->setData(COL_SEVERITY, NESTED_PATH_ROLE, relativePath);
+            child->setText(COL_TYPE, getTypeDisplayName(issue.type));
+            child->setText(COL_DESCRIPTION, QString("'%1' is duplicated in both folders").arg(relativePath));
+        }
+        if (issue.nestedFolders.size() > listed) {
+            QTreeWidgetItem *more = new QTreeWidgetItem(item);
+            more->setData(COL_SEVERITY, ISSUE_INDEX_ROLE, issueIndex);
+            more->setText(COL_DESCRIPTION, QString("... and %1 more").arg(issue.nestedFolders.size() - listed));
+        }
     }
 
     // Sort by severity (High first)
@@ -948,37 +2355,45 @@ void DuplicateAnalyzer::updateDetailsPanel()
     }
 
     // Get issue details
-    int issueIndex = m_issuesTree->indexOfTopLevelItem(item);
-    if (issueIndex < 0 || issueIndex >= m_duplicateIssues.size()) {
+    const DuplicateIssue *selectedIssue = issueForItem(item);
+    QString primaryFolder;
+    QString duplicateFolder;
+    if (!selectedIssue || !foldersForItem(item, primaryFolder, duplicateFolder)) {
         return;
     }
 
-    const DuplicateIssue &issue = m_duplicateIssues[issueIndex];
+    const DuplicateIssue &issue = *selectedIssue;
 
     // Update details panel
     m_detailsTitle->setText(QString("Issue Details - %1").arg(getTypeDisplayName(issue.type)));
     
     m_modeLabel->setText(QString("<b>Analysis Mode:</b> %1").arg(getModeName(m_currentMode)));
 
-    QFileInfo primaryInfo(issue.primaryFolder);
-    QFileInfo duplicateInfo(issue.duplicateFolder);
+    QFileInfo primaryInfo(primaryFolder);
+    QFileInfo duplicateInfo(duplicateFolder);
 
     m_primaryFolderLabel->setText(QString("<b>Primary Folder:</b><br>%1<br><small>%2</small>")
                                       .arg(primaryInfo.fileName())
-                                      .arg(issue.primaryFolder));
+                                      .arg(primaryFolder));
 
     m_duplicateFolderLabel->setText(QString("<b>Duplicate Folder:</b><br>%1<br><small>%2</small>")
                                         .arg(duplicateInfo.fileName())
-                                        .arg(issue.duplicateFolder));
+                                        .arg(duplicateFolder));
 
     m_similarityLabel->setText(QString("<b>Similarity:</b> %1%")
                                    .arg(qRound(issue.similarity * 100)));
 
-    m_filesCountLabel->setText(QString("<b>Files:</b> %1 duplicates out of %2 total")
-                                   .arg(issue.duplicateFiles)
-                                   .arg(issue.totalFiles));
+    QString filesText = QString("<b>Files:</b> %1 duplicates out of %2 total")
+                            .arg(issue.duplicateFiles)
+                            .arg(issue.totalFiles);
+    if (issue.nestedPairs > 0) {
+        filesText += QString("<br><b>Nested pairs covered:</b> %1").arg(issue.nestedPairs);
+    }
+    m_filesCountLabel->setText(filesText);
 
-    m_wastedSpaceLabel->setText(QString("<b>Wasted Space:</b> %1")
+    m_wastedSpaceLabel->setText(QString("<b>%1:</b> %2")
+                                    .arg(issue.clusterFolders.isEmpty() ? "Wasted Space"
+                                                                        : "Reclaimable")
                                     .arg(formatFileSize(issue.wastedSpace)));
 
     m_severityLabel->setText(QString("<b>Severity:</b> %1").arg(issue.severity));
@@ -990,6 +2405,13 @@ QString DuplicateAnalyzer::formatIssueDescription(const DuplicateIssue &issue)
     QFileInfo duplicateInfo(issue.duplicateFolder);
 
     QString desc;
+    if (issue.clusterFolders.size() > 2) {
+        desc = QString("'%1' exists in %2 copies").arg(primaryInfo.fileName()).arg(issue.clusterFolders.size());
+        desc += issue.type == DuplicateType::ExactComplete ? " (same files and folder structure)"
+                                                           : " (same files, different structure)";
+        return desc;
+    }
+
     switch (issue.type) {
     case DuplicateType::ExactComplete:
         desc = QString("'%1' and '%2' are exact duplicates (same files and folder structure)")
@@ -1057,14 +2479,31 @@ QString DuplicateAnalyzer::getTypeDescription(DuplicateType type)
     case DuplicateType::ExactFilesOnly:
         return "Folders contain exactly the same image files, but organized differently";
     case DuplicateType::PartialDuplicate:
-        return "Folders share 90% or more of their image files";
+        return QString("Folders share %1% or more of their image files").arg(qRound(m_partialThreshold * 100));
     }
     return "Unknown duplicate type";
 }
 
 QString DuplicateAnalyzer::getModeName(ComparisonMode mode)
 {
-    return (mode == ComparisonMode::Quick) ? "Quick" : "Deep";
+    switch (mode) {
+    case ComparisonMode::Quick:
+        return "Quick";
+    case ComparisonMode::Deep:
+        return "Deep";
+    case ComparisonMode::Sampled:
+        return "Sampled";
+    }
+    return "Quick";
+}
+
+QString DuplicateAnalyzer::signatureScheme() const
+{
+    // Sampled hashes differ with the sample count, so it is part of the scheme
+    if (m_currentMode == ComparisonMode::Sampled) {
+        return QString("%1 x%2").arg(getModeName(m_currentMode)).arg(m_sampleCount);
+    }
+    return getModeName(m_currentMode);
 }
 
 // === Private Methods - Utility ===
@@ -1129,6 +2568,45 @@ QTreeWidgetItem* DuplicateAnalyzer::getCurrentIssueItem()
     return selectedItems.isEmpty() ? nullptr : selectedItems.first();
 }
 
+const DuplicateAnalyzer::DuplicateIssue *DuplicateAnalyzer::issueForItem(QTreeWidgetItem *item) const
+{
+    if (!item) {
+        return nullptr;
+    }
+
+    bool ok = false;
+    const int issueIndex = item->data(COL_SEVERITY, ISSUE_INDEX_ROLE).toInt(&ok);
+    if (!ok || issueIndex < 0 || issueIndex >= m_duplicateIssues.size()) {
+        return nullptr;
+    }
+    return &m_duplicateIssues[issueIndex];
+}
+
+bool DuplicateAnalyzer::foldersForItem(QTreeWidgetItem *item, QString &primaryFolder,
+                                       QString &duplicateFolder) const
+{
+    const DuplicateIssue *issue = issueForItem(item);
+    if (!issue) {
+        return false;
+    }
+
+    // Further copies of a cluster pair up with the kept copy
+    const QString copy = item->data(COL_SEVERITY, CLUSTER_COPY_ROLE).toString();
+    if (!copy.isEmpty()) {
+        primaryFolder = issue->primaryFolder;
+        duplicateFolder = copy;
+        return true;
+    }
+
+    // Nested twins resolve to the same relative path under both folders
+    const QString relativePath = item->data(COL_SEVERITY, NESTED_PATH_ROLE).toString();
+    primaryFolder = relativePath.isEmpty() ? issue->primaryFolder
+                                           : QDir(issue->primaryFolder).filePath(relativePath);
+    duplicateFolder = relativePath.isEmpty() ? issue->duplicateFolder
+                                             : QDir(issue->duplicateFolder).filePath(relativePath);
+    return true;
+}
+
 // === Cache Management Methods ===
 
 void DuplicateAnalyzer::saveFolderContentCache()
@@ -1150,8 +2628,8 @@ void DuplicateAnalyzer::saveFolderContentCache()
     stream.setVersion(QDataStream::Qt_6_0);
 
     // Write cache version and metadata
-    stream << QString("FolderContentCache_v2.0"); // New version for FileInfo struct
-    stream << static_cast<qint32>(m_currentMode);
+    stream << QString("FolderContentCache_v2.1"); // v2.1: signature scheme instead of mode
+    stream << m_cacheScheme;
     stream << static_cast<qint32>(m_folderContentCache.size());
 
     // Write each cached folder
@@ -1204,14 +2682,13 @@ void DuplicateAnalyzer::loadFolderContentCache()
     // Read and validate cache version
     QString version;
     stream >> version;
-    if (version != "FolderContentCache_v2.0") {
+    if (version != "FolderContentCache_v2.1") {
         qDebug() << "Invalid cache version:" << version << "- clearing cache";
         return;
     }
 
-    // Read cache metadata
-    qint32 cachedMode;
-    stream >> cachedMode;
+    // Read cache metadata; startAnalysis() drops the cache for another scheme
+    stream >> m_cacheScheme;
 
     // Read cache size
     qint32 cacheSize;
@@ -1262,6 +2739,7 @@ void DuplicateAnalyzer::loadFolderContentCache()
         }
     }
 
+    MemoryGovernor::instance()->notifyGrowth();
     qDebug() << "Loaded folder content cache:" << validEntries << "valid," << invalidEntries << "invalid entries";
 }
 
@@ -1297,6 +2775,32 @@ bool DuplicateAnalyzer::isFolderContentCacheValid(const QString &folderPath, con
     return true;
 }
 
+qint64 DuplicateAnalyzer::folderContentCacheBytes() const
+{
+    qint64 entries = 0;
+    for (const FolderContent &content : m_folderContentCache) {
+        entries += content.allFiles.size() + content.allSubfolders.size();
+    }
+    return entries * FOLDER_CACHE_BYTES_PER_ENTRY;
+}
+
+qint64 DuplicateAnalyzer::evictFolderContentCache(qint64 bytes)
+{
+    // A running analysis holds references into the cache across event processing
+    if (m_analysisRunning) {
+        return 0;
+    }
+
+    // Evicted folders are simply rescanned by the next analysis
+    qint64 freed = 0;
+    auto it = m_folderContentCache.begin();
+    while (it != m_folderContentCache.end() && freed < bytes) {
+        freed += (it->allFiles.size() + it->allSubfolders.size()) * FOLDER_CACHE_BYTES_PER_ENTRY;
+        it = m_folderContentCache.erase(it);
+    }
+    return freed;
+}
+
 int DuplicateAnalyzer::countFilesInFolder(const QString &folderPath)
 {
     int count = 0;
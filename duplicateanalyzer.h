@@ -11,12 +11,15 @@
 #include <QSplitter>
 #include <QHeaderView>
 #include <QTimer>
+#include <QSlider>
 #include <QHash>
 #include <QSet>
 #include <QFileInfo>
+#include "batchfilereader.h"
+#include "projectmanager.h"
 
-class ProjectManager;
 class FolderManager;
+class ExternalSorter;
 
 /**
  * @brief Analyzer for detecting duplicate folders with various criteria
@@ -24,7 +27,9 @@ class FolderManager;
  * Provides comprehensive folder duplicate detection including:
  * - Quick comparison (file size + image dimensions)
  * - Deep comparison (file size + image dimensions + partial hash)
+ * - Sampled comparison (Deep plus blocks spread through each file)
  * - Multiple duplicate types detection
+ * - Out-of-core analysis when folder contents would exceed the memory budget
  * - IDE-style issue reporting with detailed descriptions
  */
 class DuplicateAnalyzer : public QWidget
@@ -37,7 +42,8 @@ public:
      */
     enum class ComparisonMode {
         Quick,      ///< Fast: File size + image dimensions only
-        Deep        ///< Thorough: File size + image dimensions + partial hash
+        Deep,       ///< Thorough: File size + image dimensions + partial hash
+        Sampled     ///< Deep plus blocks sampled through the middle of each file
     };
 
     /**
@@ -62,15 +68,19 @@ public:
         qint64 wastedSpace;          ///< Wasted disk space in bytes
         QString description;         ///< Human-readable issue description
         QString severity;            ///< Issue severity level
+        int nestedPairs = 0;         ///< Twin subfolder pairs covered by this issue (exact complete only)
+        QStringList nestedFolders;   ///< Twin subfolders (relative paths), exact complete only
+        QStringList clusterFolders;  ///< All copies of an exact duplicate cluster, kept copy first
     };
 
     explicit DuplicateAnalyzer(ProjectManager *projectManager,
                                FolderManager *folderManager,
                                QWidget *parent = nullptr);
+    ~DuplicateAnalyzer();
 
     /**
      * @brief Start analyzing folders for duplicates
-     * @param mode Comparison mode (Quick or Deep)
+     * @param mode Comparison mode (Quick, Deep or Sampled)
      */
     void startAnalysis(ComparisonMode mode);
 
@@ -91,6 +101,47 @@ public:
      */
     ComparisonMode currentMode() const { return m_currentMode; }
 
+    /**
+     * @brief Get the display name of a comparison mode
+     * @param mode Comparison mode
+     * @return Mode name ("Quick", "Deep" or "Sampled")
+     */
+    static QString getModeName(ComparisonMode mode);
+
+    /**
+     * @brief Change the similarity needed for a partial duplicate
+     *
+     * Re-filters the stored candidate pairs of the last analysis; no file
+     * is read and nothing is re-analyzed.
+     * @param threshold Minimum similarity (0.5 - 1.0)
+     */
+    void setPartialThreshold(double threshold);
+
+    /**
+     * @brief Set the number of interior blocks read per file in Sampled mode
+     *
+     * More samples tell apart more near-identical files at the cost of one
+     * extra 4 KB read each. Takes effect on the next analysis; changing it
+     * invalidates cached folder contents and stored fingerprints.
+     * @param count Sample count (1 - MAX_SAMPLE_COUNT)
+     */
+    void setSampleCount(int count);
+
+    /**
+     * @brief Get the number of interior blocks read per file in Sampled mode
+     * @return Sample count
+     */
+    int sampleCount() const { return m_sampleCount; }
+
+    static constexpr int DEFAULT_SAMPLE_COUNT = 8;
+    static constexpr int MAX_SAMPLE_COUNT = 64;
+
+    /**
+     * @brief Get the similarity needed for a partial duplicate
+     * @return Minimum similarity (0.0 - 1.0)
+     */
+    double partialThreshold() const { return m_partialThreshold; }
+
 signals:
     /**
      * @brief Emitted when analysis starts
@@ -151,6 +202,12 @@ private slots:
      */
     void refreshAnalysis();
 
+    /**
+     * @brief Apply the threshold slider
+     * @param percent Minimum similarity in percent
+     */
+    void onThresholdChanged(int percent);
+
 private:
     // === UI Setup ===
     void setupUI();
@@ -173,7 +230,7 @@ private:
         qint64 fileSize;           ///< File size in bytes
         int imageWidth;            ///< Image width in pixels
         int imageHeight;           ///< Image height in pixels
-        QString partialHash;       ///< Partial hash (first 16KB + last 16KB) - only for deep mode
+        QString partialHash;       ///< Deep: first 16KB + last 16KB; Sampled: also interior blocks
     };
 
     /**
@@ -191,9 +248,18 @@ private:
                              const QString &basePath,
                              FolderContent &content);
     
-    FileInfo analyzeFile(const QString &filePath);
-    QSize readImageDimensions(const QString &filePath);
-    QString calculatePartialHash(const QString &filePath);
+    QList<FileInfo> analyzeFiles(const QStringList &filePaths);
+
+    /**
+     * @brief First sampled hash seen for a Deep signature
+     */
+    struct CollisionSample {
+        quint64 sampledHash = 0;     ///< Hash of the sampled signature
+        int collisions = 0;          ///< Later files with a different sampled signature
+    };
+
+    void recordSampledCollision(const QString &deepSignature, const QString &sampledHash);
+    int estimatedSampledCollisions() const;
     
     int countFilesInFolder(const QString &folderPath);
     void updateFileProgress();
@@ -203,13 +269,94 @@ private:
                                   const FolderContent &folder2);
     bool isExactFilesOnlyDuplicate(const FolderContent &folder1,
                                    const FolderContent &folder2);
-    double calculateFileSimilarity(const FolderContent &folder1,
-                                   const FolderContent &folder2);
+
+    /**
+     * @brief File signature overlap of two folders
+     */
+    struct FileOverlap {
+        int intersection;            ///< Signatures present in both folders
+        int unionSize;               ///< Signatures present in either folder
+
+        double similarity() const { return unionSize > 0 ? double(intersection) / unionSize : 0.0; }
+    };
+
+    FileOverlap calculateFileOverlap(const FolderContent &folder1,
+                                     const FolderContent &folder2);
     
     bool areFilesIdentical(const FileInfo &file1, const FileInfo &file2);
+    QString fileSignature(const FileInfo &info) const;
+
+    // === Pair Results ===
+
+    using FolderRecord = ProjectManager::DuplicateFolderRecord;
+
+    /**
+     * @brief Outcome of comparing a folder pair: an exact match, or the
+     *        overlap counts of a partial candidate
+     */
+    struct PairResult {
+        int folder1;                 ///< Index into m_folderRecords
+        int folder2;                 ///< Index into m_folderRecords
+        DuplicateType type;          ///< Match type
+        int intersection = 0;        ///< Shared file signatures (partial only)
+        int unionSize = 0;           ///< File signatures of both folders (partial only)
+    };
+
+    int folderRecordId(const QString &folderPath);
+    int addFolderRecord(const FolderRecord &record);
+    void addPairResult(const PairResult &pair);
+    DuplicateIssue createExactIssue(const PairResult &pair);
+    DuplicateIssue createPartialIssue(const PairResult &pair);
+    void applyPartialThreshold();
+
+    // === Stored Results ===
+    QList<ProjectManager::DuplicatePairRecord> loadStoredAnalysis();
+    void restoreStoredResults();
+    void saveAnalysisResults(const QStringList &projectFolders);
+    void computeFolderFingerprints(const QStringList &folders);
+    bool isFolderUnchanged(const QString &folderPath) const;
+    bool reuseStoredResult(const QString &folder1, const QString &folder2,
+                           const QStringList &storedCovering);
+    static QString pairKey(const QString &folder1, const QString &folder2);
+
+    // === Out-of-Core Analysis ===
+
+    /**
+     * @brief Per-folder totals of an out-of-core analysis
+     *
+     * Replaces FolderContent: a folder keeps counts and hashes of its
+     * subtree, never the file list itself.
+     */
+    struct OutOfCoreFolder {
+        int parent = -1;             ///< Index of the parent folder, -1 for top-level folders
+        int subtreeEnd = 0;          ///< One past the last descendant in the folder list
+        bool repeated = false;       ///< Folder already listed earlier (nested project folders)
+        int fileCount = 0;           ///< Image files, recursively
+        int signatureCount = 0;      ///< Distinct file signatures, recursively
+        qint64 totalSize = 0;        ///< Total size in bytes, recursively
+        quint64 directHash = 0;      ///< Multiset hash of the direct files' (name, signature)
+        quint64 structureHash = 0;   ///< directHash plus named subfolders: equal for exact complete duplicates
+        quint64 contentHash = 0;     ///< Multiset hash of all signatures: equal for exact files-only duplicates
+        quint64 contentHash2 = 0;    ///< Second, independent multiset hash of all signatures
+    };
+
+    bool shouldAnalyzeOutOfCore() const;
+    void analyzeOutOfCore(const QStringList &folders);
+    QList<OutOfCoreFolder> buildOutOfCoreFolders(const QStringList &folders);
+    bool spillFolderSignatures(const QStringList &folders, QList<OutOfCoreFolder> &stats,
+                               ExternalSorter &signatures);
+    bool spillOverlapPairs(ExternalSorter &signatures, QList<OutOfCoreFolder> &stats,
+                           ExternalSorter &pairs);
+    QList<PairResult> findOutOfCoreMatches(const QList<OutOfCoreFolder> &stats, ExternalSorter &pairs);
+    bool verifyExactMatches(ExternalSorter &signatures, const QStringList &folders,
+                            const QList<OutOfCoreFolder> &stats, QList<PairResult> &matches);
+    void addOutOfCoreMatches(const QStringList &folders, const QList<OutOfCoreFolder> &stats,
+                             QList<PairResult> matches);
 
     // === Results Management ===
     void addDuplicateIssue(const DuplicateIssue &issue);
+    void clusterDuplicateIssues();
+    void finalizeCluster(DuplicateIssue &cluster);
     void updateIssuesTree();
     void updateDetailsPanel();
     QString formatIssueDescription(const DuplicateIssue &issue);
@@ -217,7 +364,7 @@ private:
     QIcon getSeverityIcon(const QString &severity);
     QString getTypeDisplayName(DuplicateType type);
     QString getTypeDescription(DuplicateType type);
-    QString getModeName(ComparisonMode mode);
+    QString signatureScheme() const;
 
     // === Cache Management ===
     void saveFolderContentCache();
@@ -225,6 +372,8 @@ private:
     QString getCacheKey(const QString &folderPath) const;
     bool isFolderContentCacheValid(const QString &folderPath, const FolderContent &content) const;
     void resetAnalysisState();
+    qint64 folderContentCacheBytes() const;
+    qint64 evictFolderContentCache(qint64 bytes);
 
     // === Utility Methods ===
     QStringList getProjectFolders();
@@ -232,6 +381,8 @@ private:
     void openFolderInExplorer(const QString &folderPath);
     QString getRelativePath(const QString &fullPath, const QString &basePath);
     QTreeWidgetItem* getCurrentIssueItem();
+    const DuplicateIssue *issueForItem(QTreeWidgetItem *item) const;
+    bool foldersForItem(QTreeWidgetItem *item, QString &primaryFolder, QString &duplicateFolder) const;
 
     // === UI Components ===
     QVBoxLayout *m_mainLayout;
@@ -240,6 +391,8 @@ private:
     // Issues list
     QTreeWidget *m_issuesTree;
     QLabel *m_issuesCountLabel;
+    QSlider *m_thresholdSlider;
+    QLabel *m_thresholdLabel;
 
     // Details panel
     QWidget *m_detailsPanel;
@@ -268,19 +421,47 @@ private:
     FolderManager *m_folderManager;
     QList<DuplicateIssue> m_duplicateIssues;
     QHash<QString, FolderContent> m_folderContentCache;
+    QList<FolderRecord> m_folderRecords;       ///< Folders of pair results
+    QHash<QString, int> m_folderRecordIds;     ///< Folder path -> index in m_folderRecords
+    QList<PairResult> m_pairResults;           ///< Exact matches and partial candidates
+    double m_partialThreshold;                 ///< Similarity needed for a partial duplicate
+
+    // === Incremental analysis ===
+    QHash<QString, QString> m_folderFingerprints;                ///< Current fingerprint per folder
+    QHash<QString, FolderRecord> m_storedFolders;                ///< Folders of the stored analysis
+    QHash<QString, ProjectManager::DuplicatePairRecord> m_storedPairs; ///< Stored results by pairKey()
+    QList<QPair<QString, QString>> m_storedExactPairs;           ///< Stored exact complete matches, in order
+    int m_memoryConsumerId;                    ///< Memory governor registration
     ComparisonMode m_currentMode;
+    int m_sampleCount;                         ///< Interior blocks per file in Sampled mode
+    QString m_cacheScheme;                     ///< signatureScheme() of m_folderContentCache
 
     // === Analysis progress tracking ===
     int m_totalFilesToAnalyze;
     int m_filesAnalyzed;
     int m_totalFoldersToScan;
     int m_foldersScanned;
+    int m_droppedSignatures;                   ///< Out-of-core: signatures shared by too many folders to pair
     bool m_analysisRunning;
 
+    // === Signature cost ===
+    qint64 m_bytesRead;                        ///< Bytes read for file signatures this run
+    int m_filesHashed;                         ///< Files read this run
+    int m_sampledCollisions;                   ///< Collisions among the tracked Deep signatures
+    int m_collisionSampleShift;                ///< 1 in 2^shift Deep signatures is tracked
+    QHash<quint64, CollisionSample> m_deepToSampled; ///< Hashed Deep signature -> first sampled hash
+
+    // === File I/O ===
+    BatchFileReader m_batchReader;             ///< Batched header/tail reads
+
     // === Constants ===
-    static constexpr double PARTIAL_DUPLICATE_THRESHOLD = 0.90; // 90%
+    static constexpr double PARTIAL_DUPLICATE_THRESHOLD = 0.90; // 90%, default
+    static constexpr double MIN_PARTIAL_THRESHOLD = 0.50;       // Lowest selectable; pairs below are not kept
     static constexpr int PROGRESS_UPDATE_INTERVAL = 5;
     static constexpr qint64 PARTIAL_HASH_SIZE = 16384; // 16 KB
+    static constexpr int SAMPLE_BLOCK_SIZE = 4096;     // Interior block in Sampled mode
+    static constexpr int MAX_COLLISION_SAMPLES = 65536; // Deep signatures tracked for the cost report
+    static constexpr int ANALYSIS_BATCH_SIZE = 256;    // Files read per batch
 };
 
 #endif // DUPLICATEANALYZER_H
@@ -2,13 +2,24 @@
 #include "duplicateanalyzer.h"
 #include "projectmanager.h"
 #include "foldermanager.h"
+#include "asyncprojectmanager.h"
+#include "duplicatefilemodel.h"
+#include "spacereclaimer.h"
+#include "taskscheduler.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
 #include <QLabel>
+#include <QSpinBox>
+#include <QCloseEvent>
 #include <QMessageBox>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QDebug>
+#include <QTabWidget>
+#include <QTreeView>
+#include <QHeaderView>
+#include <QDir>
 
 // === Constants ===
 namespace {
@@ -17,7 +28,7 @@ constexpr int DIALOG_MIN_HEIGHT = 700;
 
 const QString DIALOG_TITLE = "Duplicate Folder Analysis";
 const QString INSTRUCTIONS_TEXT =
-    "This tool analyzes your project folders to find duplicates using two comparison modes:\n\n"
+    "This tool analyzes your project folders to find duplicates using three comparison modes:\n\n"
     "<b>Quick Analysis</b> - Fast scan using file size + image dimensions\n"
     "  • Compares file sizes and image resolutions\n"
     "  • Very fast, suitable for large collections\n"
@@ -26,8 +37,21 @@ const QString INSTRUCTIONS_TEXT =
     "  • Adds partial content comparison (first 16KB + last 16KB)\n"
     "  • More accurate, still 20-50x faster than full hash\n"
     "  • Recommended for final verification\n\n"
+    "<b>Sampled Analysis</b> - Deep plus blocks spread through each file\n"
+    "  • Tells apart near-identical shots that share headers and trailers\n"
+    "  • Reads 4KB more per sample; the status bar reports the cost\n\n"
+    "<b>Exact Files</b> - Identical files anywhere in the catalog\n"
+    "  • Uses the full-file hashes stored during sync, reads no files\n"
+    "  • Lists each set of identical copies with the space they waste\n\n"
     "Choose your preferred analysis mode to start.";
 
+const QString FOLDERS_TAB_TITLE = "Folders";
+const QString FILES_TAB_TITLE = "Exact Files";
+constexpr int MAX_LISTED_PROBLEMS = 10;
+constexpr int FILE_NAME_COLUMN_WIDTH = 600;
+
+constexpr qint64 BYTES_PER_MB = 1024 * 1024;
+
 const QString STYLE_TITLE = "font-weight: bold; font-size: 16px; padding: 10px; color: #2c3e50;";
 const QString STYLE_INSTRUCTIONS = "padding: 10px; background-color: #f8f9fa; border: 1px solid #e9ecef; border-radius: 4px; color: #495057;";
 const QString STYLE_BUTTON_PRIMARY = "QPushButton { font-weight: bold; color: white; background-color: #007bff; border: 1px solid #007bff; padding: 8px 16px; border-radius: 4px; } QPushButton:hover { background-color: #0056b3; } QPushButton:disabled { background-color: #6c757d; }";
@@ -38,11 +62,14 @@ const QString STYLE_BUTTON_SECONDARY = "QPushButton { color: #6c757d; background
 // === Constructor ===
 
 DuplicateDialog::DuplicateDialog(ProjectManager *projectManager,
+                                 AsyncProjectManager *asyncProjectManager,
                                  FolderManager *folderManager,
                                  QWidget *parent)
     : QDialog(parent)
     , m_projectManager(projectManager)
+    , m_asyncProjectManager(asyncProjectManager)
     , m_folderManager(folderManager)
+    , m_reclaimRunning(false)
 {
     setupUI();
 
@@ -55,6 +82,8 @@ DuplicateDialog::DuplicateDialog(ProjectManager *projectManager,
             this, &DuplicateDialog::onAnalysisCompleted);
     connect(m_analyzer, &DuplicateAnalyzer::showFolderInTree,
             this, &DuplicateDialog::onShowFolderInTree);
+    connect(m_fileModel, &DuplicateFileModel::groupsLoaded,
+            this, &DuplicateDialog::onFileGroupsLoaded);
 
     setWindowTitle(DIALOG_TITLE);
     setMinimumSize(DIALOG_MIN_WIDTH, DIALOG_MIN_HEIGHT);
@@ -69,14 +98,17 @@ DuplicateDialog::DuplicateDialog(ProjectManager *projectManager,
 
 void DuplicateDialog::onAnalysisStarted(int totalFolders, DuplicateAnalyzer::ComparisonMode mode)
 {
-    // Disable both analysis buttons during analysis
+    // Disable the analysis buttons during analysis
     m_quickAnalysisButton->setEnabled(false);
     m_deepAnalysisButton->setEnabled(false);
+    m_sampledAnalysisButton->setEnabled(false);
+    m_sampleCountSpin->setEnabled(false);
     
-    QString modeText = (mode == DuplicateAnalyzer::ComparisonMode::Quick) ? "Quick" : "Deep";
+    QString modeText = DuplicateAnalyzer::getModeName(mode);
     
     m_quickAnalysisButton->setText("Analyzing...");
     m_deepAnalysisButton->setText("Analyzing...");
+    m_sampledAnalysisButton->setText("Analyzing...");
 
     updateTitle(0, mode); // Reset title during analysis
 
@@ -104,13 +136,16 @@ void DuplicateDialog::onAnalysisCompleted(int issuesFound, DuplicateAnalyzer::Co
     // Re-enable analysis buttons
     m_quickAnalysisButton->setEnabled(true);
     m_deepAnalysisButton->setEnabled(true);
+    m_sampledAnalysisButton->setEnabled(true);
+    m_sampleCountSpin->setEnabled(true);
     
     m_quickAnalysisButton->setText("Quick Analysis");
     m_deepAnalysisButton->setText("Deep Analysis");
+    m_sampledAnalysisButton->setText("Sampled Analysis");
 
     updateTitle(issuesFound, mode);
 
-    QString modeText = (mode == DuplicateAnalyzer::ComparisonMode::Quick) ? "Quick" : "Deep";
+    QString modeText = DuplicateAnalyzer::getModeName(mode);
 
     // Update instructions based on results
     if (issuesFound == 0) {
@@ -151,6 +186,24 @@ void DuplicateDialog::onShowFolderInTree(const QString &folderPath)
                                     .arg(folderInfo.fileName()));
 }
 
+void DuplicateDialog::reject()
+{
+    // The catalog update runs when reclamation finishes; closing would drop it
+    if (m_reclaimRunning) {
+        return;
+    }
+    QDialog::reject();
+}
+
+void DuplicateDialog::closeEvent(QCloseEvent *event)
+{
+    if (m_reclaimRunning) {
+        event->ignore();
+        return;
+    }
+    QDialog::closeEvent(event);
+}
+
 void DuplicateDialog::closeDialog()
 {
     accept(); // Close with accepted status
@@ -166,6 +219,12 @@ void DuplicateDialog::startDeepAnalysis()
     startAnalysis(DuplicateAnalyzer::ComparisonMode::Deep);
 }
 
+void DuplicateDialog::startSampledAnalysis()
+{
+    m_analyzer->setSampleCount(m_sampleCountSpin->value());
+    startAnalysis(DuplicateAnalyzer::ComparisonMode::Sampled);
+}
+
 void DuplicateDialog::startAnalysis(DuplicateAnalyzer::ComparisonMode mode)
 {
     // Verify we have a project open
@@ -189,9 +248,147 @@ void DuplicateDialog::startAnalysis(DuplicateAnalyzer::ComparisonMode mode)
     // The analyzer will check if there are enough folders/subfolders to compare
     // It counts all subfolders recursively, so even 1 top-level folder with 
     // multiple subfolders is sufficient
+    m_tabWidget->setCurrentIndex(0);
     m_analyzer->startAnalysis(mode);
 }
 
+void DuplicateDialog::startFileAnalysis()
+{
+    if (!m_projectManager || !m_projectManager->hasOpenProject()) {
+        QMessageBox::information(this, "No Project Open",
+                                 "Please open a project before analyzing for duplicates.");
+        return;
+    }
+
+    m_tabWidget->setCurrentIndex(1);
+    m_fileAnalysisButton->setEnabled(false);
+    m_fileSummaryLabel->setText("Searching the catalog...");
+    m_fileModel->reload();
+}
+
+void DuplicateDialog::onFileGroupsLoaded(int groupCount, qint64 reclaimableBytes, bool complete)
+{
+    m_fileAnalysisButton->setEnabled(true);
+    m_reclaimButton->setEnabled(groupCount > 0);
+
+    const QString reclaimable = QString::number(reclaimableBytes / (double)BYTES_PER_MB, 'f', 1);
+    if (complete) {
+        m_fileSummaryLabel->setText(groupCount == 0
+            ? QString("No identical files found in the catalog.")
+            : QString("%1 sets of identical files, %2 MB reclaimable.")
+                  .arg(groupCount).arg(reclaimable));
+    } else {
+        // The rest is fetched as the list is scrolled
+        m_fileSummaryLabel->setText(QString("%1+ sets of identical files so far, %2 MB reclaimable. "
+                                            "Scroll to load more.")
+                                        .arg(groupCount).arg(reclaimable));
+    }
+
+    m_instructionsLabel->setText(QString("<b>Exact File Analysis</b><br><br>"
+                                         "Files are grouped by the content hash stored in the catalog. "
+                                         "Only copies whose size and modification date still match "
+                                         "the catalog are listed; run a sync to include changed files.<br>"
+                                         "Double-click a file to open its folder."));
+}
+
+void DuplicateDialog::reclaimSpace()
+{
+    const QList<ProjectManager::DuplicateFileGroup> groups = m_fileModel->groups();
+    if (groups.isEmpty() || !m_projectManager || !m_projectManager->hasOpenProject()) {
+        return;
+    }
+
+    QMessageBox methodBox(this);
+    methodBox.setWindowTitle("Reclaim Space");
+    methodBox.setIcon(QMessageBox::Question);
+    methodBox.setText(QString("Replace the redundant copies of %1 loaded sets of identical files?").arg(groups.size()));
+    methodBox.setInformativeText("The first copy of each set is kept. Every other copy stays at its path "
+                                 "and is replaced by:\n"
+                                 "• a reflink: a copy-on-write clone sharing the kept file's storage "
+                                 "(btrfs, XFS), or\n"
+                                 "• a hard link: another name of the kept file - editing one edits both.\n\n"
+                                 "Nothing is changed until you confirm the dry run.");
+    QPushButton *reflinkButton = methodBox.addButton("Reflinks", QMessageBox::AcceptRole);
+    QPushButton *hardlinkButton = methodBox.addButton("Hard Links", QMessageBox::AcceptRole);
+    methodBox.addButton(QMessageBox::Cancel);
+    methodBox.setDefaultButton(reflinkButton);
+    methodBox.exec();
+
+    if (methodBox.clickedButton() != reflinkButton && methodBox.clickedButton() != hardlinkButton) {
+        return;
+    }
+
+    const SpaceReclaimer::Method method = methodBox.clickedButton() == reflinkButton
+        ? SpaceReclaimer::Method::Reflink : SpaceReclaimer::Method::Hardlink;
+    SpaceReclaimer reclaimer(m_projectManager->currentProjectPath());
+
+    m_reclaimButton->setEnabled(false);
+    m_fileSummaryLabel->setText("Checking copies...");
+
+    // Dry run: stats only
+    TaskScheduler::instance()->run(TaskScheduler::Priority::Interactive, [reclaimer, groups, method]() {
+        return reclaimer.plan(groups, method);
+    }).then(this, [this, reclaimer](const SpaceReclaimer::Plan &plan) {
+        QString details = QString("%1 copies can be replaced, freeing %2 MB.")
+                              .arg(plan.operations.size())
+                              .arg(plan.reclaimableBytes / (double)BYTES_PER_MB, 0, 'f', 1);
+        if (!plan.skipped.isEmpty()) {
+            details += QString("\n\n%1 copies are skipped:\n%2")
+                           .arg(plan.skipped.size())
+                           .arg(plan.skipped.mid(0, MAX_LISTED_PROBLEMS).join('\n'));
+        }
+
+        if (plan.operations.isEmpty()) {
+            m_reclaimButton->setEnabled(true);
+            m_fileSummaryLabel->setText("Nothing to reclaim.");
+            QMessageBox::information(this, "Reclaim Space", details);
+            return;
+        }
+
+        if (QMessageBox::question(this, "Reclaim Space", details + "\n\nProceed?") != QMessageBox::Yes) {
+            m_reclaimButton->setEnabled(true);
+            m_fileSummaryLabel->setText("Space reclamation canceled.");
+            return;
+        }
+
+        m_fileSummaryLabel->setText(QString("Replacing %1 copies...").arg(plan.operations.size()));
+        m_closeButton->setEnabled(false);
+        m_reclaimRunning = true;
+
+        TaskScheduler::instance()->run(TaskScheduler::Priority::Background, [reclaimer, plan]() mutable {
+            return reclaimer.execute(plan);
+        }).then(this, [this](const SpaceReclaimer::Result &result) {
+            // Hard-linked copies carry the kept file's date; keep the catalog in step
+            if (!m_projectManager->updateModifiedDates(result.modifiedDates)) {
+                qWarning() << "Failed to record reclaimed files in the catalog";
+            }
+
+            m_reclaimRunning = false;
+            m_closeButton->setEnabled(true);
+            m_reclaimButton->setEnabled(true);
+
+            QString summary = QString("Replaced %1 copies, freed %2 MB.")
+                                  .arg(result.replaced)
+                                  .arg(result.reclaimedBytes / (double)BYTES_PER_MB, 0, 'f', 1);
+            m_fileSummaryLabel->setText(summary);
+            if (!result.errors.isEmpty()) {
+                summary += QString("\n\n%1 copies failed:\n%2")
+                               .arg(result.errors.size())
+                               .arg(result.errors.mid(0, MAX_LISTED_PROBLEMS).join('\n'));
+            }
+            QMessageBox::information(this, "Reclaim Space", summary);
+        });
+    });
+}
+
+void DuplicateDialog::onFileActivated(const QModelIndex &index)
+{
+    const QString filePath = m_fileModel->filePath(index);
+    if (!filePath.isEmpty()) {
+        QDesktopServices::openUrl(QUrl::fromLocalFile(QFileInfo(filePath).absolutePath()));
+    }
+}
+
 // === Private Methods ===
 
 void DuplicateDialog::setupUI()
@@ -202,9 +399,12 @@ void DuplicateDialog::setupUI()
 
     createHeader();
 
-    // Create the main analyzer widget
+    // Folder analysis and catalog file duplicates share the dialog
+    m_tabWidget = new QTabWidget(this);
     m_analyzer = new DuplicateAnalyzer(m_projectManager, m_folderManager, this);
-    m_mainLayout->addWidget(m_analyzer);
+    m_tabWidget->addTab(m_analyzer, FOLDERS_TAB_TITLE);
+    m_tabWidget->addTab(createFilesTab(), FILES_TAB_TITLE);
+    m_mainLayout->addWidget(m_tabWidget);
 
     createButtons();
 }
@@ -225,6 +425,39 @@ void DuplicateDialog::createHeader()
     m_mainLayout->addWidget(m_instructionsLabel);
 }
 
+QWidget *DuplicateDialog::createFilesTab()
+{
+    QWidget *page = new QWidget;
+    QVBoxLayout *layout = new QVBoxLayout(page);
+
+    m_fileSummaryLabel = new QLabel("Click 'Exact Files' to list identical files in the catalog.");
+    layout->addWidget(m_fileSummaryLabel);
+
+    // Rows are fetched page by page as the view scrolls
+    m_fileModel = new DuplicateFileModel(m_asyncProjectManager, this);
+    m_fileView = new QTreeView;
+    m_fileView->setModel(m_fileModel);
+    m_fileView->setUniformRowHeights(true);
+    m_fileView->setAlternatingRowColors(true);
+    m_fileView->setColumnWidth(DuplicateFileModel::COL_NAME, FILE_NAME_COLUMN_WIDTH);
+    m_fileView->header()->setStretchLastSection(true);
+    connect(m_fileView, &QTreeView::doubleClicked, this, &DuplicateDialog::onFileActivated);
+    layout->addWidget(m_fileView);
+
+    QHBoxLayout *actionLayout = new QHBoxLayout;
+    actionLayout->addStretch();
+    m_reclaimButton = new QPushButton("Reclaim Space...");
+    m_reclaimButton->setStyleSheet(STYLE_BUTTON_SECONDARY);
+    m_reclaimButton->setToolTip("Replace redundant copies by reflinks or hard links\n"
+                                "Files keep their paths and contents");
+    m_reclaimButton->setEnabled(false);
+    connect(m_reclaimButton, &QPushButton::clicked, this, &DuplicateDialog::reclaimSpace);
+    actionLayout->addWidget(m_reclaimButton);
+    layout->addLayout(actionLayout);
+
+    return page;
+}
+
 void DuplicateDialog::createButtons()
 {
     QHBoxLayout *buttonLayout = new QHBoxLayout;
@@ -236,7 +469,7 @@ void DuplicateDialog::createButtons()
     connect(m_helpButton, &QPushButton::clicked, [this]() {
         QMessageBox::information(this, "Duplicate Analysis Help",
                                  "<h3>Duplicate Folder Analysis</h3>"
-                                 "<p>This tool helps you identify and manage duplicate content in your project folders using two analysis modes:</p>"
+                                 "<p>This tool helps you identify and manage duplicate content in your project folders using three analysis modes:</p>"
                                  
                                  "<h4>Quick Analysis (Recommended First)</h4>"
                                  "<ul>"
@@ -253,6 +486,14 @@ void DuplicateDialog::createButtons()
                                  "<li><b>Accuracy:</b> 99.9% accurate - near-perfect duplicate detection</li>"
                                  "<li><b>Best for:</b> Final verification before deleting duplicates</li>"
                                  "</ul>"
+
+                                 "<h4>Sampled Analysis (Near-Identical Files)</h4>"
+                                 "<ul>"
+                                 "<li><b>Speed:</b> One extra 4KB read per sample and file - still far below a full hash</li>"
+                                 "<li><b>Method:</b> Deep plus blocks at fixed points spread through each file</li>"
+                                 "<li><b>Accuracy:</b> Tells apart burst shots re-saved with identical headers and trailers</li>"
+                                 "<li><b>Cost:</b> The status bar reports bytes read per file and the Deep collisions avoided</li>"
+                                 "</ul>"
                                  
                                  "<h4>Duplicate Types Detected:</h4>"
                                  "<ul>"
@@ -260,6 +501,14 @@ void DuplicateDialog::createButtons()
                                  "<li><b>Exact Files Duplicates:</b> Same files, different organization (Medium severity)</li>"
                                  "<li><b>Partial Duplicates:</b> 90%+ file overlap (Low severity)</li>"
                                  "</ul>"
+
+                                 "<h4>Exact Files</h4>"
+                                 "<ul>"
+                                 "<li><b>Speed:</b> Seconds, even for large catalogs - no files are read</li>"
+                                 "<li><b>Method:</b> Groups the full-file hashes stored during sync</li>"
+                                 "<li><b>Scope:</b> Identical files anywhere, not just whole folders</li>"
+                                 "<li><b>Note:</b> Files changed since the last sync are left out</li>"
+                                 "</ul>"
                                  
                                  "<h4>Actions you can take:</h4>"
                                  "<ul>"
@@ -290,6 +539,29 @@ void DuplicateDialog::createButtons()
                                      "More accurate, recommended for final verification");
     connect(m_deepAnalysisButton, &QPushButton::clicked, this, &DuplicateDialog::startDeepAnalysis);
 
+    // Sampled Analysis button and its sample count
+    m_sampledAnalysisButton = new QPushButton("Sampled Analysis");
+    m_sampledAnalysisButton->setStyleSheet(STYLE_BUTTON_SUCCESS);
+    m_sampledAnalysisButton->setMinimumWidth(140);
+    m_sampledAnalysisButton->setToolTip("Deep analysis plus blocks sampled through each file\n"
+                                        "Tells apart near-identical shots with identical headers");
+    connect(m_sampledAnalysisButton, &QPushButton::clicked, this, &DuplicateDialog::startSampledAnalysis);
+
+    m_sampleCountSpin = new QSpinBox;
+    m_sampleCountSpin->setRange(1, DuplicateAnalyzer::MAX_SAMPLE_COUNT);
+    m_sampleCountSpin->setValue(m_analyzer->sampleCount());
+    m_sampleCountSpin->setSuffix(" samples");
+    m_sampleCountSpin->setToolTip("4KB blocks read per file in Sampled mode\n"
+                                  "More samples catch smaller differences at a higher read cost");
+
+    // Exact Files button
+    m_fileAnalysisButton = new QPushButton("Exact Files");
+    m_fileAnalysisButton->setStyleSheet(STYLE_BUTTON_PRIMARY);
+    m_fileAnalysisButton->setMinimumWidth(140);
+    m_fileAnalysisButton->setToolTip("Identical files anywhere in the catalog\n"
+                                     "Uses stored hashes, reads no files");
+    connect(m_fileAnalysisButton, &QPushButton::clicked, this, &DuplicateDialog::startFileAnalysis);
+
     // Close button
     m_closeButton = new QPushButton("Close");
     m_closeButton->setStyleSheet(STYLE_BUTTON_SECONDARY);
@@ -299,6 +571,9 @@ void DuplicateDialog::createButtons()
     // Layout buttons
     buttonLayout->addWidget(m_quickAnalysisButton);
     buttonLayout->addWidget(m_deepAnalysisButton);
+    buttonLayout->addWidget(m_sampleCountSpin);
+    buttonLayout->addWidget(m_sampledAnalysisButton);
+    buttonLayout->addWidget(m_fileAnalysisButton);
     buttonLayout->addWidget(m_closeButton);
 
     m_mainLayout->addLayout(buttonLayout);
@@ -306,7 +581,7 @@ void DuplicateDialog::createButtons()
 
 void DuplicateDialog::updateTitle(int issueCount, DuplicateAnalyzer::ComparisonMode mode)
 {
-    QString modeText = (mode == DuplicateAnalyzer::ComparisonMode::Quick) ? "Quick" : "Deep";
+    QString modeText = DuplicateAnalyzer::getModeName(mode);
     
     if (issueCount == 0) {
         setWindowTitle(DIALOG_TITLE);
@@ -12,12 +12,19 @@
 
 class ProjectManager;
 class FolderManager;
+class AsyncProjectManager;
+class DuplicateFileModel;
+class QCloseEvent;
+class QSpinBox;
+class QTabWidget;
+class QTreeView;
 
 /**
  * @brief Dialog for duplicate folder analysis and management
  *
  * Provides a modal dialog interface for:
- * - Running duplicate folder analysis (Quick or Deep mode)
+ * - Running duplicate folder analysis (Quick, Deep or Sampled mode)
+ * - Listing exact duplicate files straight from the catalog hashes
  * - Displaying results in an organized manner
  * - Managing duplicate issues
  * - Integration with folder tree navigation
@@ -28,6 +35,7 @@ class DuplicateDialog : public QDialog
 
 public:
     explicit DuplicateDialog(ProjectManager *projectManager,
+                             AsyncProjectManager *asyncProjectManager,
                              FolderManager *folderManager,
                              QWidget *parent = nullptr);
 
@@ -38,6 +46,19 @@ signals:
      */
     void showFolderInTree(const QString &folderPath);
 
+public slots:
+    /**
+     * @brief Close the dialog unless space reclamation is running
+     */
+    void reject() override;
+
+protected:
+    /**
+     * @brief Keep the dialog open while space reclamation is running
+     * @param event Close event
+     */
+    void closeEvent(QCloseEvent *event) override;
+
 private slots:
     /**
      * @brief Handle analysis start
@@ -82,6 +103,35 @@ private slots:
      */
     void startDeepAnalysis();
 
+    /**
+     * @brief Start sampled analysis with the selected sample count
+     */
+    void startSampledAnalysis();
+
+    /**
+     * @brief List exact duplicate files from the catalog
+     */
+    void startFileAnalysis();
+
+    /**
+     * @brief Handle a page of duplicate files being loaded
+     * @param groupCount Groups loaded so far
+     * @param reclaimableBytes Reclaimable bytes of the loaded groups
+     * @param complete True once all groups are loaded
+     */
+    void onFileGroupsLoaded(int groupCount, qint64 reclaimableBytes, bool complete);
+
+    /**
+     * @brief Dry-run, confirm and apply space reclamation of the loaded groups
+     */
+    void reclaimSpace();
+
+    /**
+     * @brief Open the folder containing a double-clicked copy
+     * @param index Activated model index
+     */
+    void onFileActivated(const QModelIndex &index);
+
 private:
     /**
      * @brief Setup the user interface
@@ -93,6 +143,12 @@ private:
      */
     void createHeader();
 
+    /**
+     * @brief Create the exact duplicate files tab
+     * @return Tab page widget
+     */
+    QWidget *createFilesTab();
+
     /**
      * @brief Create the action buttons
      */
@@ -115,14 +171,26 @@ private:
     QVBoxLayout *m_mainLayout;
     QLabel *m_titleLabel;
     QLabel *m_instructionsLabel;
+    QTabWidget *m_tabWidget;
     DuplicateAnalyzer *m_analyzer;
+    QTreeView *m_fileView;
+    QLabel *m_fileSummaryLabel;
+    DuplicateFileModel *m_fileModel;
     QPushButton *m_quickAnalysisButton;
     QPushButton *m_deepAnalysisButton;
+    QPushButton *m_sampledAnalysisButton;
+    QSpinBox *m_sampleCountSpin;
+    QPushButton *m_fileAnalysisButton;
+    QPushButton *m_reclaimButton;
     QPushButton *m_closeButton;
     QPushButton *m_helpButton;
 
+    // === State ===
+    bool m_reclaimRunning;              ///< True while copies are being replaced
+
     // === Services ===
     ProjectManager *m_projectManager;
+    AsyncProjectManager *m_asyncProjectManager;
     FolderManager *m_folderManager;
 };
 
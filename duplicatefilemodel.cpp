@@ -0,0 +1,208 @@
+#include "duplicatefilemodel.h"
+#include "asyncprojectmanager.h"
+#include <QDir>
+
+// === Constants ===
+namespace {
+constexpr int PAGE_SIZE = 256;              // Catalog groups examined per page
+constexpr quintptr GROUP_ROW_ID = 0;        // Internal ID of top-level rows
+
+constexpr qint64 BYTES_PER_KB = 1024;
+constexpr qint64 BYTES_PER_MB = 1024 * 1024;
+constexpr qint64 BYTES_PER_GB = 1024 * 1024 * 1024;
+
+QString formatFileSize(qint64 bytes)
+{
+    if (bytes >= BYTES_PER_GB) {
+        return QString("%1 GB").arg(bytes / (double)BYTES_PER_GB, 0, 'f', 2);
+    } else if (bytes >= BYTES_PER_MB) {
+        return QString("%1 MB").arg(bytes / (double)BYTES_PER_MB, 0, 'f', 2);
+    } else if (bytes >= BYTES_PER_KB) {
+        return QString("%1 KB").arg(bytes / (double)BYTES_PER_KB, 0, 'f', 2);
+    } else {
+        return QString("%1 bytes").arg(bytes);
+    }
+}
+
+qint64 reclaimableBytes(const ProjectManager::DuplicateFileGroup &group)
+{
+    // Copies already hard-linked to each other free nothing more
+    return group.fileSize * qMax(0, group.distinctCopies - 1);
+}
+}
+
+// === Constructor ===
+
+DuplicateFileModel::DuplicateFileModel(AsyncProjectManager *asyncProjectManager, QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_asyncProjectManager(asyncProjectManager)
+    , m_nextSize(0)
+    , m_reclaimableBytes(0)
+    , m_exhausted(true)
+    , m_loading(false)
+    , m_generation(0)
+{
+}
+
+// === Public Methods ===
+
+void DuplicateFileModel::reload()
+{
+    beginResetModel();
+    m_groups.clear();
+    m_nextHash.clear();
+    m_nextSize = 0;
+    m_reclaimableBytes = 0;
+    m_exhausted = false;
+    m_loading = false;
+    m_generation++;
+    endResetModel();
+
+    fetchMore(QModelIndex());
+}
+
+QString DuplicateFileModel::filePath(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.internalId() == GROUP_ROW_ID) {
+        return QString();
+    }
+
+    const auto &group = m_groups.at(static_cast<int>(index.internalId() - 1));
+    return group.files.at(index.row()).filePath;
+}
+
+// === QAbstractItemModel Interface ===
+
+QModelIndex DuplicateFileModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!hasIndex(row, column, parent)) {
+        return QModelIndex();
+    }
+
+    // Copies remember their group as row + 1; groups use 0
+    const quintptr id = parent.isValid() ? static_cast<quintptr>(parent.row()) + 1 : GROUP_ROW_ID;
+    return createIndex(row, column, id);
+}
+
+QModelIndex DuplicateFileModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid() || child.internalId() == GROUP_ROW_ID) {
+        return QModelIndex();
+    }
+    return createIndex(static_cast<int>(child.internalId() - 1), 0, GROUP_ROW_ID);
+}
+
+int DuplicateFileModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return m_groups.size();
+    }
+    if (parent.internalId() == GROUP_ROW_ID && parent.column() == 0) {
+        return m_groups.at(parent.row()).files.size();
+    }
+    return 0;
+}
+
+int DuplicateFileModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return COL_COUNT;
+}
+
+QVariant DuplicateFileModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::ToolTipRole)) {
+        return QVariant();
+    }
+
+    if (index.internalId() == GROUP_ROW_ID) {
+        const auto &group = m_groups.at(index.row());
+        switch (index.column()) {
+        case COL_NAME:
+            return role == Qt::ToolTipRole ? QVariant(QString("MD5 %1").arg(group.fileHash))
+                                           : QVariant(group.files.first().fileName);
+        case COL_COPIES:
+            return group.files.size();
+        case COL_SIZE:
+            return formatFileSize(group.fileSize);
+        case COL_RECLAIMABLE:
+            return formatFileSize(reclaimableBytes(group));
+        }
+        return QVariant();
+    }
+
+    if (index.column() != COL_NAME) {
+        return QVariant();
+    }
+
+    const auto &group = m_groups.at(static_cast<int>(index.internalId() - 1));
+    return QDir::toNativeSeparators(group.files.at(index.row()).filePath);
+}
+
+QVariant DuplicateFileModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (section) {
+    case COL_NAME:
+        return "File";
+    case COL_COPIES:
+        return "Copies";
+    case COL_SIZE:
+        return "Size";
+    case COL_RECLAIMABLE:
+        return "Reclaimable";
+    }
+    return QVariant();
+}
+
+bool DuplicateFileModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && !m_exhausted && !m_loading && m_asyncProjectManager;
+}
+
+void DuplicateFileModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    m_loading = true;
+    const int generation = m_generation;
+    m_asyncProjectManager->getDuplicateFiles(m_nextHash, m_nextSize, PAGE_SIZE)
+        .then(this, [this, generation](const ProjectManager::DuplicateFilePage &page) {
+            appendPage(generation, page);
+        });
+}
+
+// === Private Methods ===
+
+void DuplicateFileModel::appendPage(int generation, const ProjectManager::DuplicateFilePage &page)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    m_loading = false;
+    m_exhausted = page.exhausted;
+    m_nextHash = page.lastHash;
+    m_nextSize = page.lastSize;
+
+    if (!page.groups.isEmpty()) {
+        beginInsertRows(QModelIndex(), m_groups.size(), m_groups.size() + page.groups.size() - 1);
+        for (const auto &group : page.groups) {
+            m_reclaimableBytes += reclaimableBytes(group);
+        }
+        m_groups.append(page.groups);
+        endInsertRows();
+    }
+
+    emit groupsLoaded(m_groups.size(), m_reclaimableBytes, m_exhausted);
+
+    // Pages whose groups all failed verification add no rows for the view to scroll to
+    if (page.groups.isEmpty()) {
+        fetchMore(QModelIndex());
+    }
+}
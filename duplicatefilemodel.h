@@ -0,0 +1,103 @@
+#ifndef DUPLICATEFILEMODEL_H
+#define DUPLICATEFILEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QPointer>
+#include "projectmanager.h"
+
+class AsyncProjectManager;
+
+/**
+ * @brief Lazily loaded tree of exact duplicate files from the catalog
+ *
+ * Top-level rows are duplicate groups (one content hash), their children
+ * the copies. Groups are fetched a page at a time on the catalog thread as
+ * the view scrolls (canFetchMore/fetchMore), so the first results show up
+ * immediately and large catalogs never load into memory at once.
+ */
+class DuplicateFileModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Column identifiers
+     */
+    enum Column {
+        COL_NAME = 0,       ///< Group: file name of the first copy; copy: file path
+        COL_COPIES,         ///< Number of copies
+        COL_SIZE,           ///< Size of one copy
+        COL_RECLAIMABLE,    ///< Bytes freed by keeping one copy
+        COL_COUNT
+    };
+
+    /**
+     * @brief Create an empty model
+     * @param asyncProjectManager Catalog facade serving the pages
+     * @param parent Parent object
+     */
+    explicit DuplicateFileModel(AsyncProjectManager *asyncProjectManager, QObject *parent = nullptr);
+
+    /**
+     * @brief Clear the model and start loading from the first page
+     */
+    void reload();
+
+    /**
+     * @brief Check whether a page request is running
+     * @return True while loading
+     */
+    bool isLoading() const { return m_loading; }
+
+    /**
+     * @brief Get the groups loaded so far
+     * @return Loaded groups, copies ordered by path
+     */
+    const QList<ProjectManager::DuplicateFileGroup> &groups() const { return m_groups; }
+
+    /**
+     * @brief Get the file path of a copy row
+     * @param index Model index
+     * @return File path, or empty for group rows
+     */
+    QString filePath(const QModelIndex &index) const;
+
+    // === QAbstractItemModel Interface ===
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+signals:
+    /**
+     * @brief Emitted after each page is appended
+     * @param groupCount Groups loaded so far
+     * @param reclaimableBytes Reclaimable bytes of the loaded groups
+     * @param complete True once the last page has been loaded
+     */
+    void groupsLoaded(int groupCount, qint64 reclaimableBytes, bool complete);
+
+private:
+    /**
+     * @brief Append a fetched page
+     * @param generation Generation the page was requested for
+     * @param page Fetched page
+     */
+    void appendPage(int generation, const ProjectManager::DuplicateFilePage &page);
+
+    QPointer<AsyncProjectManager> m_asyncProjectManager; ///< Catalog facade
+    QList<ProjectManager::DuplicateFileGroup> m_groups;  ///< Loaded groups
+    QString m_nextHash;                                  ///< Paging key of the next page
+    qint64 m_nextSize;                                   ///< Paging key of the next page
+    qint64 m_reclaimableBytes;                           ///< Sum over loaded groups
+    bool m_exhausted;                                    ///< Last page loaded
+    bool m_loading;                                      ///< Page request running
+    int m_generation;                                    ///< Bumped by reload() to drop stale pages
+};
+
+#endif // DUPLICATEFILEMODEL_H
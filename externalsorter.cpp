@@ -0,0 +1,211 @@
+#include "externalsorter.h"
+#include <QDir>
+#include <QFile>
+#include <algorithm>
+
+// === Constructor ===
+
+ExternalSorter::ExternalSorter(const QString &tempPath, qint64 memoryBytes)
+    : m_tempDir(QDir(tempPath).filePath(".pmsort-XXXXXX"))
+    , m_bufferPosition(0)
+    , m_recordCount(0)
+    , m_runCounter(0)
+    , m_finished(false)
+{
+    const size_t records = static_cast<size_t>(qMax<qint64>(0, memoryBytes)) / sizeof(Record);
+    m_bufferRecords = std::max(records, MIN_BUFFER_RECORDS);
+    m_blockRecords = std::max<size_t>(m_bufferRecords / (MAX_MERGE_FAN_IN + 1), 1);
+    m_buffer.reserve(m_bufferRecords);
+
+    if (!m_tempDir.isValid()) {
+        m_error = QString("Cannot create a temporary directory in %1").arg(tempPath);
+    }
+}
+
+ExternalSorter::~ExternalSorter() = default;
+
+// === Public Methods ===
+
+bool ExternalSorter::add(const Record &record)
+{
+    m_buffer.push_back(record);
+    m_recordCount++;
+
+    if (m_buffer.size() >= m_bufferRecords) {
+        return spillRun();
+    }
+    return true;
+}
+
+bool ExternalSorter::finish()
+{
+    m_finished = true;
+
+    // Everything fit in memory: stream straight from the buffer
+    if (m_runs.isEmpty()) {
+        std::sort(m_buffer.begin(), m_buffer.end());
+        return rewind();
+    }
+
+    if (!m_buffer.empty() && !spillRun()) {
+        return false;
+    }
+    std::vector<Record>().swap(m_buffer);
+
+    // Merge groups of runs until the final merge can read all of them at once
+    while (m_runs.size() > MAX_MERGE_FAN_IN) {
+        QStringList merged;
+        for (int start = 0; start < m_runs.size(); start += MAX_MERGE_FAN_IN) {
+            const QStringList group = m_runs.mid(start, MAX_MERGE_FAN_IN);
+            const QString target = newRunPath();
+            if (!mergeRuns(group, target)) {
+                return false;
+            }
+            for (const QString &run : group) {
+                QFile::remove(run);
+            }
+            merged.append(target);
+        }
+        m_runs = merged;
+    }
+
+    return rewind();
+}
+
+bool ExternalSorter::next(Record &record)
+{
+    if (m_runs.isEmpty()) {
+        if (m_bufferPosition >= m_buffer.size()) {
+            return false;
+        }
+        record = m_buffer[m_bufferPosition++];
+        return true;
+    }
+    return popSmallest(m_readers, record);
+}
+
+bool ExternalSorter::rewind()
+{
+    if (!m_finished) {
+        return false;
+    }
+
+    m_bufferPosition = 0;
+    m_readers.clear();
+    return m_runs.isEmpty() || openReaders(m_runs, m_readers);
+}
+
+// === Private Methods ===
+
+bool ExternalSorter::RunReader::refill(size_t blockRecords)
+{
+    block.resize(blockRecords);
+    const qint64 bytes = file->read(reinterpret_cast<char *>(block.data()),
+                                    static_cast<qint64>(blockRecords * sizeof(Record)));
+    block.resize(bytes > 0 ? static_cast<size_t>(bytes) / sizeof(Record) : 0);
+    position = 0;
+    return !block.empty();
+}
+
+bool ExternalSorter::spillRun()
+{
+    std::sort(m_buffer.begin(), m_buffer.end());
+
+    const QString path = newRunPath();
+    if (!writeRecords(path, m_buffer.data(), m_buffer.size())) {
+        return false;
+    }
+
+    m_runs.append(path);
+    m_buffer.clear();
+    return true;
+}
+
+bool ExternalSorter::writeRecords(const QString &path, const Record *records, size_t count)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        m_error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        return false;
+    }
+
+    const qint64 bytes = static_cast<qint64>(count * sizeof(Record));
+    if (file.write(reinterpret_cast<const char *>(records), bytes) != bytes) {
+        m_error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool ExternalSorter::openReaders(const QStringList &runs, std::vector<RunReader> &readers)
+{
+    readers.clear();
+    readers.reserve(runs.size());
+
+    for (const QString &run : runs) {
+        RunReader reader;
+        reader.file = std::make_unique<QFile>(run);
+        if (!reader.file->open(QIODevice::ReadOnly)) {
+            m_error = QString("Cannot read %1: %2").arg(run, reader.file->errorString());
+            readers.clear();
+            return false;
+        }
+        if (reader.refill(m_blockRecords)) {
+            readers.push_back(std::move(reader));
+        }
+    }
+    return true;
+}
+
+bool ExternalSorter::popSmallest(std::vector<RunReader> &readers, Record &record)
+{
+    if (readers.empty()) {
+        return false;
+    }
+
+    // Linear scan: at most MAX_MERGE_FAN_IN runs, and the I/O dominates
+    size_t smallest = 0;
+    for (size_t i = 1; i < readers.size(); ++i) {
+        if (readers[i].current() < readers[smallest].current()) {
+            smallest = i;
+        }
+    }
+
+    RunReader &reader = readers[smallest];
+    record = reader.current();
+    if (++reader.position >= reader.block.size() && !reader.refill(m_blockRecords)) {
+        if (reader.file->error() != QFileDevice::NoError) {
+            m_error = QString("Cannot read %1: %2").arg(reader.file->fileName(), reader.file->errorString());
+        }
+        readers.erase(readers.begin() + static_cast<std::ptrdiff_t>(smallest));
+    }
+    return true;
+}
+
+bool ExternalSorter::mergeRuns(const QStringList &runs, const QString &target)
+{
+    std::vector<RunReader> readers;
+    if (!openReaders(runs, readers)) {
+        return false;
+    }
+
+    std::vector<Record> output;
+    output.reserve(m_blockRecords);
+
+    Record record;
+    while (popSmallest(readers, record)) {
+        output.push_back(record);
+        if (output.size() >= m_blockRecords) {
+            if (!writeRecords(target, output.data(), output.size())) {
+                return false;
+            }
+            output.clear();
+        }
+    }
+    return writeRecords(target, output.data(), output.size()) && m_error.isEmpty();
+}
+
+QString ExternalSorter::newRunPath()
+{
+    return m_tempDir.filePath(QString("run-%1").arg(m_runCounter++));
+}
@@ -0,0 +1,124 @@
+#ifndef EXTERNALSORTER_H
+#define EXTERNALSORTER_H
+
+#include <QList>
+#include <QString>
+#include <QTemporaryDir>
+#include <memory>
+#include <vector>
+
+class QFile;
+
+/**
+ * @brief Sorts more fixed-size records than fit in memory
+ *
+ * Records are buffered up to a memory limit; each full buffer is sorted
+ * and spilled to a run file. finish() merges the runs, in several passes
+ * if there are more than MAX_MERGE_FAN_IN, and next() then streams every
+ * record in ascending (key, value) order with one block of memory per run.
+ * rewind() streams the sorted records again.
+ *
+ * Run files live in a temporary directory removed with the sorter.
+ */
+class ExternalSorter
+{
+public:
+    /**
+     * @brief Sorted record
+     */
+    struct Record {
+        quint64 key;                 ///< Primary sort key
+        quint64 value;               ///< Secondary sort key and payload
+
+        bool operator<(const Record &other) const
+        {
+            return key != other.key ? key < other.key : value < other.value;
+        }
+    };
+
+    /**
+     * @brief Create a sorter
+     * @param tempPath Directory holding the run files (should be on disk, not tmpfs)
+     * @param memoryBytes Memory used for buffering and merging
+     */
+    ExternalSorter(const QString &tempPath, qint64 memoryBytes);
+    ~ExternalSorter();
+
+    ExternalSorter(const ExternalSorter &) = delete;
+    ExternalSorter &operator=(const ExternalSorter &) = delete;
+
+    /**
+     * @brief Add a record, spilling a sorted run when the buffer is full
+     * @param record Record to add
+     * @return False if a run could not be written
+     */
+    bool add(const Record &record);
+
+    /**
+     * @brief Spill the last run and merge down to one pass
+     * @return False if a run could not be written
+     */
+    bool finish();
+
+    /**
+     * @brief Get the next record in sorted order
+     * @param record Set to the next record
+     * @return False at the end; check errorString() for read errors
+     */
+    bool next(Record &record);
+
+    /**
+     * @brief Start streaming the sorted records from the beginning
+     * @return False if a run could not be reopened
+     */
+    bool rewind();
+
+    /**
+     * @brief Get the number of records added
+     * @return Record count
+     */
+    qint64 recordCount() const { return m_recordCount; }
+
+    /**
+     * @brief Get the last error
+     * @return Error message, empty if none
+     */
+    QString errorString() const { return m_error; }
+
+private:
+    /**
+     * @brief One run being read during a merge
+     */
+    struct RunReader {
+        std::unique_ptr<QFile> file;     ///< Run file
+        std::vector<Record> block;       ///< Records read ahead
+        size_t position = 0;             ///< Next record in block
+
+        bool refill(size_t blockRecords);
+        const Record &current() const { return block[position]; }
+    };
+
+    bool spillRun();
+    bool writeRecords(const QString &path, const Record *records, size_t count);
+    bool openReaders(const QStringList &runs, std::vector<RunReader> &readers);
+    bool popSmallest(std::vector<RunReader> &readers, Record &record);
+    bool mergeRuns(const QStringList &runs, const QString &target);
+    QString newRunPath();
+
+    QTemporaryDir m_tempDir;             ///< Run files
+    std::vector<Record> m_buffer;        ///< Records not yet spilled
+    size_t m_bufferRecords;              ///< Records buffered before a spill
+    size_t m_blockRecords;               ///< Records read ahead per run while merging
+    size_t m_bufferPosition;             ///< Next record when everything fit in memory
+    QStringList m_runs;                  ///< Sorted runs on disk
+    std::vector<RunReader> m_readers;    ///< Final merge
+    qint64 m_recordCount;                ///< Records added
+    int m_runCounter;                    ///< Names run files
+    bool m_finished;                     ///< finish() called
+    QString m_error;                     ///< Last error
+
+    static constexpr int MAX_MERGE_FAN_IN = 64;        // Runs merged at once
+    static constexpr size_t MIN_BUFFER_RECORDS = 4096;
+};
+
+#endif // EXTERNALSORTER_H
@@ -1,4 +1,5 @@
 #include "foldermanager.h"
+#include "taskscheduler.h"
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
 #include <QDir>
@@ -8,9 +9,16 @@
 #include <QMenu>
 #include <QAction>
 #include <QMessageBox>
+#include <QFuture>
+#include <QBrush>
+
+namespace {
+const QString DUMMY_MARKER = "DUMMY";
+const QString MISSING_FOLDER_TOOLTIP = "Folder not found: %1";
+}
 
 FolderManager::FolderManager(QTreeWidget *treeWidget, QObject *parent)
-    : QObject(parent), m_treeWidget(treeWidget)
+    : QObject(parent), m_treeWidget(treeWidget), m_restoreGeneration(0)
 {
     setupTreeWidget();
     addContextMenu();
@@ -68,10 +76,7 @@ void FolderManager::addFolder(const QString &folderPath)
 
     // LAZY LOADING: Only check if it has subfolders, don't load them yet
     if (hasSubfolders(folderPath)) {
-        // Add a dummy child to show the expand arrow
-        QTreeWidgetItem *dummyChild = new QTreeWidgetItem(item);
-        dummyChild->setText(0, "Loading...");
-        dummyChild->setData(0, Qt::UserRole, "DUMMY");
+        addExpandPlaceholder(item);
     }
 
     m_treeWidget->addTopLevelItem(item);
@@ -82,11 +87,92 @@ void FolderManager::addFolder(const QString &folderPath)
     emit folderAdded(folderPath);
 }
 
+void FolderManager::restoreFolders(const QStringList &folderPaths)
+{
+    // Build the tree from catalog data alone; the filesystem is checked later
+    // in the background so a slow or unmounted volume cannot stall opening
+    for (const QString &folderPath : folderPaths) {
+        if (folderPath.isEmpty() || folderAlreadyExists(folderPath)) {
+            continue;
+        }
+
+        QTreeWidgetItem *item = createFolderItem(folderPath, QFileInfo(folderPath).baseName());
+        addExpandPlaceholder(item);
+        m_treeWidget->addTopLevelItem(item);
+        m_projectFolders.append(folderPath);
+    }
+
+    validateRestoredFolders(m_projectFolders);
+}
+
+bool FolderManager::selectFolder(const QString &folderPath)
+{
+    QTreeWidgetItem *item = findItemByPath(folderPath);
+    if (!item) {
+        return false;
+    }
+
+    m_treeWidget->setCurrentItem(item);
+    return true;
+}
+
+void FolderManager::addExpandPlaceholder(QTreeWidgetItem *item)
+{
+    // Add a dummy child to show the expand arrow
+    QTreeWidgetItem *dummyChild = new QTreeWidgetItem(item);
+    dummyChild->setText(0, "Loading...");
+    dummyChild->setData(0, Qt::UserRole, DUMMY_MARKER);
+}
+
+void FolderManager::validateRestoredFolders(const QStringList &folderPaths)
+{
+    struct FolderState {
+        bool exists;
+        bool hasSubfolders;
+    };
+
+    const int generation = ++m_restoreGeneration;
+    TaskScheduler::instance()->run(TaskScheduler::Priority::Background, [folderPaths]() {
+        QList<FolderState> states;
+        states.reserve(folderPaths.size());
+        for (const QString &folderPath : folderPaths) {
+            const QDir dir(folderPath);
+            const bool exists = dir.exists();
+            const bool subfolders = exists &&
+                !dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot).isEmpty();
+            states.append({exists, subfolders});
+        }
+        return states;
+    }).then(this, [this, folderPaths, generation](const QList<FolderState> &states) {
+        if (generation != m_restoreGeneration) {
+            return; // The tree was rebuilt meanwhile
+        }
+
+        for (int i = 0; i < folderPaths.size(); ++i) {
+            QTreeWidgetItem *item = findItemByPath(folderPaths.at(i));
+            if (!item) {
+                continue;
+            }
+
+            if (!states.at(i).exists) {
+                item->setForeground(0, QBrush(Qt::gray));
+                item->setToolTip(0, MISSING_FOLDER_TOOLTIP.arg(folderPaths.at(i)));
+            }
+
+            // Drop the expand arrow of roots that turned out to have no subfolders
+            if (!states.at(i).hasSubfolders && item->childCount() == 1 &&
+                item->child(0)->data(0, Qt::UserRole).toString() == DUMMY_MARKER) {
+                delete item->takeChild(0);
+            }
+        }
+    });
+}
+
 void FolderManager::onItemExpanded(QTreeWidgetItem *item)
 {
     // Check if this item has dummy children that need to be replaced with real ones
     if (item->childCount() == 1 &&
-        item->child(0)->data(0, Qt::UserRole).toString() == "DUMMY") {
+        item->child(0)->data(0, Qt::UserRole).toString() == DUMMY_MARKER) {
 
         // Remove dummy child
         delete item->takeChild(0);
@@ -108,10 +194,7 @@ void FolderManager::loadSubfoldersLazy(QTreeWidgetItem *parentItem)
 
         // Check if this subfolder has its own subfolders
         if (hasSubfolders(subDirPath)) {
-            // Add dummy child to show expand arrow
-            QTreeWidgetItem *dummyChild = new QTreeWidgetItem(subItem);
-            dummyChild->setText(0, "Loading...");
-            dummyChild->setData(0, Qt::UserRole, "DUMMY");
+            addExpandPlaceholder(subItem);
         }
 
         parentItem->addChild(subItem);
@@ -163,6 +246,7 @@ void FolderManager::removeSelectedFolder()
 
 void FolderManager::clearAllFolders()
 {
+    m_restoreGeneration++;
     m_treeWidget->clear();
     m_projectFolders.clear();
     emit foldersCleared();
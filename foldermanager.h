@@ -17,6 +17,8 @@ public:
 
     // Main operations
     void addFolder(const QString &folderPath);
+    void restoreFolders(const QStringList &folderPaths);
+    bool selectFolder(const QString &folderPath);
     void removeSelectedFolder();
     void clearAllFolders();
     QString getCurrentFolderPath() const;
@@ -52,10 +54,13 @@ private:
     bool folderAlreadyExists(const QString &folderPath) const;
     void addContextMenu();
     bool hasSubfolders(const QString &path) const;
+    void addExpandPlaceholder(QTreeWidgetItem *item);
+    void validateRestoredFolders(const QStringList &folderPaths);
 
     QTreeWidget *m_treeWidget;
     QStringList m_supportedExtensions;
     QStringList m_projectFolders;
+    int m_restoreGeneration;
     static const int MAX_SUBFOLDER_DEPTH = 5;
 };
 
@@ -1,57 +1,225 @@
 #include "imagegridwidget.h"
 #include "thumbnailservice.h"
 #include <QVBoxLayout>
-#include <QGridLayout>
 #include <QLabel>
 #include <QDir>
 #include <QFileInfo>
 #include <QPixmap>
+#include <QPainter>
+#include <QPaintEvent>
 #include <QMouseEvent>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <QTimer>
 
 // === Constants ===
 namespace {
 constexpr int DEFAULT_THUMBNAIL_SIZE = 120;
 constexpr int DEFAULT_MAX_IMAGES = 100;
-constexpr int DEFAULT_GRID_COLUMNS = 4;
+constexpr int MIN_REQUEST_CHUNK = 16;          // Thumbnails requested per event loop turn
 constexpr int THUMBNAIL_MARGIN = 4;
 constexpr int GRID_SPACING = 5;
 constexpr int MIN_GRID_COLUMNS = 1;
-constexpr int COLUMN_SPACING = 10;
+constexpr int CANVAS_MARGIN = 9;               // Outer margin around the grid
+constexpr int CELL_INSET = 2;                  // Gap between cell edge and its border
+
+constexpr int ATLAS_PAGE_SIZE = 2048;
+constexpr int ATLAS_MAX_PAGES = 4;             // 4 x 16 MB pages at 32 bpp
+
+const QColor CELL_BORDER_COLOR = QColor(211, 211, 211);   // lightgray
+const QColor CELL_BACKGROUND_COLOR = Qt::white;
 
 const QString PLACEHOLDER_STYLE = "font-size: 14px; color: gray; padding: 20px;";
-const QString THUMBNAIL_STYLE = "border: 1px solid lightgray; margin: 2px; background-color: white;";
 
 const QString MSG_SELECT_FOLDER = "Select a folder to view images";
 const QString MSG_NO_FOLDER = "No folder selected";
 const QString MSG_NO_IMAGES = "No images found in this folder";
 }
 
-// === ClickableLabel Implementation ===
+// === ThumbnailGridCanvas Implementation ===
 
-ClickableLabel::ClickableLabel(const QString &imagePath, QWidget *parent)
-    : QLabel(parent)
-    , m_imagePath(imagePath)
+ThumbnailGridCanvas::ThumbnailGridCanvas(ThumbnailService *thumbnailService, int thumbnailSize,
+                                         QWidget *parent)
+    : QWidget(parent)
+    , m_thumbnailService(thumbnailService)
+    , m_atlas(ATLAS_PAGE_SIZE, ATLAS_MAX_PAGES)
+    , m_thumbnailSize(thumbnailSize)
 {
-    setupThumbnailLabel();
+    setCursor(Qt::PointingHandCursor);
+    updateContentHeight();
 }
 
-void ClickableLabel::setupThumbnailLabel()
+void ThumbnailGridCanvas::addThumbnail(const QString &imagePath, const QPixmap &thumbnail)
 {
-    setCursor(Qt::PointingHandCursor);
-    setStyleSheet(THUMBNAIL_STYLE);
-    setAlignment(Qt::AlignCenter);
+    m_imagePaths.append(imagePath);
+    packThumbnail(imagePath, thumbnail);
 
-    // Set tooltip with filename
-    const QFileInfo fileInfo(m_imagePath);
-    setToolTip(fileInfo.fileName());
+    updateContentHeight();
+    update(cellRect(m_imagePaths.size() - 1));
 }
 
-void ClickableLabel::mousePressEvent(QMouseEvent *event)
+void ThumbnailGridCanvas::paintEvent(QPaintEvent *event)
+{
+    if (m_imagePaths.isEmpty()) {
+        return;
+    }
+
+    QPainter painter(this);
+
+    // Only walk the rows intersecting the exposed area
+    const int columns = columnCount();
+    const int pitch = m_thumbnailSize + THUMBNAIL_MARGIN + GRID_SPACING;
+    const QRect exposed = event->rect();
+    const int firstRow = qMax(0, (exposed.top() - CANVAS_MARGIN) / pitch);
+    const int lastRow = qMax(0, (exposed.bottom() - CANVAS_MARGIN) / pitch);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            const int index = row * columns + col;
+            if (index >= m_imagePaths.size()) {
+                return;
+            }
+            if (cellRect(index).intersects(exposed)) {
+                paintCell(painter, index);
+            }
+        }
+    }
+}
+
+void ThumbnailGridCanvas::mousePressEvent(QMouseEvent *event)
 {
     if (event->button() == Qt::LeftButton) {
-        emit clicked(m_imagePath);
+        const int index = cellAt(event->position().toPoint());
+        if (index >= 0) {
+            emit clicked(m_imagePaths.at(index));
+        }
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void ThumbnailGridCanvas::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateContentHeight();
+}
+
+bool ThumbnailGridCanvas::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        const int index = cellAt(helpEvent->pos());
+        if (index >= 0) {
+            QToolTip::showText(helpEvent->globalPos(),
+                               QFileInfo(m_imagePaths.at(index)).fileName(),
+                               this, cellRect(index));
+        } else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+int ThumbnailGridCanvas::columnCount() const
+{
+    const int pitch = m_thumbnailSize + THUMBNAIL_MARGIN + GRID_SPACING;
+    const int availableWidth = width() - 2 * CANVAS_MARGIN + GRID_SPACING;
+    return qMax(MIN_GRID_COLUMNS, availableWidth / pitch);
+}
+
+QRect ThumbnailGridCanvas::cellRect(int index) const
+{
+    const int columns = columnCount();
+    const int cellSize = m_thumbnailSize + THUMBNAIL_MARGIN;
+    const int pitch = cellSize + GRID_SPACING;
+
+    return QRect(CANVAS_MARGIN + (index % columns) * pitch,
+                 CANVAS_MARGIN + (index / columns) * pitch,
+                 cellSize, cellSize);
+}
+
+int ThumbnailGridCanvas::cellAt(const QPoint &pos) const
+{
+    const int columns = columnCount();
+    const int pitch = m_thumbnailSize + THUMBNAIL_MARGIN + GRID_SPACING;
+    if (pos.x() < CANVAS_MARGIN || pos.y() < CANVAS_MARGIN) {
+        return -1;
     }
-    QLabel::mousePressEvent(event);
+
+    const int col = (pos.x() - CANVAS_MARGIN) / pitch;
+    const int row = (pos.y() - CANVAS_MARGIN) / pitch;
+    const int index = row * columns + col;
+    if (col >= columns || index >= m_imagePaths.size()) {
+        return -1;
+    }
+
+    // Ignore clicks in the spacing between cells
+    return cellRect(index).contains(pos) ? index : -1;
+}
+
+void ThumbnailGridCanvas::updateContentHeight()
+{
+    const int columns = columnCount();
+    const int rows = (m_imagePaths.size() + columns - 1) / columns;
+    const int pitch = m_thumbnailSize + THUMBNAIL_MARGIN + GRID_SPACING;
+    const int contentHeight = 2 * CANVAS_MARGIN + qMax(0, rows * pitch - GRID_SPACING);
+    const int contentWidth = 2 * CANVAS_MARGIN + m_thumbnailSize + THUMBNAIL_MARGIN;
+
+    if (minimumHeight() != contentHeight || minimumWidth() != contentWidth) {
+        setMinimumSize(contentWidth, contentHeight);
+    }
+}
+
+ThumbnailAtlas::Region ThumbnailGridCanvas::packThumbnail(const QString &imagePath,
+                                                          const QPixmap &thumbnail)
+{
+    ThumbnailAtlas::Region region = m_atlas.insert(imagePath, thumbnail);
+    if (region.isValid() || thumbnail.isNull()) {
+        return region;
+    }
+
+    // Atlas full: start over, cells outside the view are refilled when painted
+    m_atlas.clear();
+    return m_atlas.insert(imagePath, thumbnail);
+}
+
+void ThumbnailGridCanvas::paintCell(QPainter &painter, int index)
+{
+    const QRect cell = cellRect(index);
+    const QRect frame = cell.adjusted(CELL_INSET, CELL_INSET, -CELL_INSET - 1, -CELL_INSET - 1);
+
+    painter.fillRect(frame, CELL_BACKGROUND_COLOR);
+    painter.setPen(CELL_BORDER_COLOR);
+    painter.drawRect(frame);
+
+    const QString &imagePath = m_imagePaths.at(index);
+    ThumbnailAtlas::Region region = m_atlas.region(imagePath);
+
+    if (!region.isValid() && m_thumbnailService) {
+        // Never decode while painting; the cell is repainted when the thumbnail is ready
+        const QPixmap thumbnail = m_thumbnailService->requestThumbnail(imagePath, m_thumbnailSize);
+        if (thumbnail.isNull()) {
+            return;
+        }
+        region = packThumbnail(imagePath, thumbnail);
+
+        if (!region.isValid()) {
+            // Larger than an atlas page: draw the pixmap directly
+            QRect target(QPoint(0, 0), thumbnail.size());
+            target.moveCenter(cell.center());
+            painter.drawPixmap(target, thumbnail);
+            return;
+        }
+    }
+
+    if (!region.isValid()) {
+        return;
+    }
+
+    QRect target(QPoint(0, 0), region.rect.size());
+    target.moveCenter(cell.center());
+    painter.drawPixmap(target, m_atlas.page(region.page), region.rect);
 }
 
 // === ImageGridWidget Implementation ===
@@ -60,13 +228,11 @@ ImageGridWidget::ImageGridWidget(ThumbnailService *thumbnailService, QWidget *pa
     : QScrollArea(parent)
     , m_thumbnailService(thumbnailService)
     , m_loadedCount(0)
+    , m_requestCursor(0)
+    , m_loadGeneration(0)
     , m_thumbnailSize(DEFAULT_THUMBNAIL_SIZE)
     , m_maxImagesPerLoad(DEFAULT_MAX_IMAGES)
-    , m_gridColumns(DEFAULT_GRID_COLUMNS)
-    , m_gridWidget(nullptr)
-    , m_gridLayout(nullptr)
-    , m_currentRow(0)
-    , m_currentCol(0)
+    , m_canvas(nullptr)
 {
     setupUI();
     connectSignals();
@@ -76,15 +242,20 @@ ImageGridWidget::ImageGridWidget(ThumbnailService *thumbnailService, QWidget *pa
 
 void ImageGridWidget::loadImagesFromFolder(const QString &folderPath)
 {
-    resetState();
-    m_currentFolder = folderPath;
-
     if (folderPath.isEmpty()) {
+        resetState();
         showPlaceholder(MSG_NO_FOLDER);
         return;
     }
 
-    const QStringList imageFiles = scanForImages(folderPath);
+    loadImages(folderPath, scanForImages(folderPath));
+}
+
+void ImageGridWidget::loadImages(const QString &folderPath, const QStringList &imageFiles)
+{
+    resetState();
+    m_currentFolder = folderPath;
+
     if (imageFiles.isEmpty()) {
         showPlaceholder(MSG_NO_IMAGES);
         emit loadingFinished(0);
@@ -125,6 +296,10 @@ void ImageGridWidget::onThumbnailReady(const QString &imagePath, const QPixmap &
 {
     // Only process if this image is part of current loading session
     if (!m_pendingImages.contains(imagePath)) {
+        // A cell dropped from the atlas was regenerated: repaint it
+        if (m_canvas && isImageAlreadyInGrid(imagePath)) {
+            m_canvas->update();
+        }
         return;
     }
 
@@ -167,17 +342,13 @@ void ImageGridWidget::connectSignals()
 
 void ImageGridWidget::createThumbnailGrid()
 {
-    // Create new grid widget and layout
-    m_gridWidget = new QWidget;
-    m_gridLayout = new QGridLayout(m_gridWidget);
-    m_gridLayout->setSpacing(GRID_SPACING);
-    m_gridLayout->setAlignment(Qt::AlignTop | Qt::AlignLeft);
-
-    calculateGridDimensions();
-    resetGridPosition();
+    // Create new canvas (replacing the old one also frees its atlas)
+    m_canvas = new ThumbnailGridCanvas(m_thumbnailService, m_thumbnailSize);
+    connect(m_canvas, &ThumbnailGridCanvas::clicked,
+            this, &ImageGridWidget::onThumbnailClicked);
 
     // Set the widget to scroll area
-    setWidget(m_gridWidget);
+    setWidget(m_canvas);
 }
 
 void ImageGridWidget::showPlaceholder(const QString &message)
@@ -191,6 +362,7 @@ void ImageGridWidget::showPlaceholder(const QString &message)
 
     layout->addWidget(placeholderLabel);
     setWidget(placeholderWidget);
+    m_canvas = nullptr; // Deleted by setWidget
 }
 
 QStringList ImageGridWidget::getSupportedExtensions() const
@@ -201,28 +373,9 @@ QStringList ImageGridWidget::getSupportedExtensions() const
 
 // === Private Methods - Thumbnail Management ===
 
-ClickableLabel* ImageGridWidget::createThumbnailWidget(const QString &imagePath)
-{
-    ClickableLabel *thumbnailLabel = new ClickableLabel(imagePath);
-    const int widgetSize = m_thumbnailSize + THUMBNAIL_MARGIN;
-    thumbnailLabel->setFixedSize(widgetSize, widgetSize);
-
-    connect(thumbnailLabel, &ClickableLabel::clicked,
-            this, &ImageGridWidget::onThumbnailClicked);
-
-    return thumbnailLabel;
-}
-
-void ImageGridWidget::calculateGridDimensions()
-{
-    const int availableWidth = viewport()->width();
-    const int columnWidth = m_thumbnailSize + COLUMN_SPACING;
-    m_gridColumns = qMax(MIN_GRID_COLUMNS, availableWidth / columnWidth);
-}
-
 void ImageGridWidget::addThumbnailToGrid(const QString &imagePath, const QPixmap &thumbnail)
 {
-    if (!m_gridLayout || thumbnail.isNull()) {
+    if (!m_canvas || thumbnail.isNull()) {
         return;
     }
 
@@ -231,18 +384,11 @@ void ImageGridWidget::addThumbnailToGrid(const QString &imagePath, const QPixmap
         return;
     }
 
-    ClickableLabel *thumbnailLabel = createThumbnailWidget(imagePath);
-    if (!thumbnailLabel) {
-        return;
-    }
-
-    thumbnailLabel->setPixmap(thumbnail);
-    m_gridLayout->addWidget(thumbnailLabel, m_currentRow, m_currentCol);
+    m_canvas->addThumbnail(imagePath, thumbnail);
 
     // Track that this image was added
     m_addedImages.insert(imagePath);
 
-    advanceGridPosition();
     incrementLoadedCount();
 }
 
@@ -250,28 +396,19 @@ void ImageGridWidget::addThumbnailToGrid(const QString &imagePath, const QPixmap
 
 void ImageGridWidget::resetState()
 {
+    if (m_thumbnailService) {
+        m_thumbnailService->cancelThumbnailRequests();
+    }
+
     m_currentImages.clear();
     m_pendingImages.clear();
     m_addedImages.clear(); // Clear tracking of added images
     m_loadedCount = 0;
+    m_requestCursor = 0;
+    m_loadGeneration++;
     m_currentFolder.clear();
 }
 
-void ImageGridWidget::resetGridPosition()
-{
-    m_currentRow = 0;
-    m_currentCol = 0;
-}
-
-void ImageGridWidget::advanceGridPosition()
-{
-    m_currentCol++;
-    if (m_currentCol >= m_gridColumns) {
-        m_currentCol = 0;
-        m_currentRow++;
-    }
-}
-
 void ImageGridWidget::incrementLoadedCount()
 {
     m_loadedCount++;
@@ -323,9 +460,26 @@ void ImageGridWidget::startLoading()
         return;
     }
 
-    // Request thumbnails from service
-    for (const QString &imagePath : m_currentImages) {
-        const QPixmap thumbnail = m_thumbnailService->getThumbnail(imagePath, m_thumbnailSize);
+    requestThumbnailChunk(m_loadGeneration);
+}
+
+void ImageGridWidget::requestThumbnailChunk(int generation)
+{
+    if (generation != m_loadGeneration || !m_thumbnailService) {
+        return; // A newer load replaced this one
+    }
+
+    // Request thumbnails from service: the first screen is interactive, the rest prefetch
+    const int visibleCells = visibleCellEstimate();
+    const int chunkEnd = qMin(m_currentImages.size(),
+                              m_requestCursor + qMax(visibleCells, MIN_REQUEST_CHUNK));
+    for (int i = m_requestCursor; i < chunkEnd; ++i) {
+        const QString &imagePath = m_currentImages.at(i);
+        const TaskScheduler::Priority priority = i < visibleCells
+            ? TaskScheduler::Priority::Interactive
+            : TaskScheduler::Priority::VisiblePrefetch;
+        const QPixmap thumbnail = m_thumbnailService->requestThumbnail(imagePath, m_thumbnailSize,
+                                                                       priority);
         if (!thumbnail.isNull()) {
             // Thumbnail was in cache - add immediately if not already added
             if (!isImageAlreadyInGrid(imagePath)) {
@@ -335,9 +489,27 @@ void ImageGridWidget::startLoading()
         }
         // If thumbnail wasn't cached, onThumbnailReady will be called when ready
     }
+    m_requestCursor = chunkEnd;
+
+    // Let the first screen paint before decoding further cached thumbnails
+    if (m_requestCursor < m_currentImages.size()) {
+        QTimer::singleShot(0, this, [this, generation]() {
+            requestThumbnailChunk(generation);
+        });
+        return;
+    }
 
     // If all thumbnails were cached, we're done
     if (m_pendingImages.isEmpty()) {
         emit loadingFinished(m_loadedCount);
     }
 }
+
+int ImageGridWidget::visibleCellEstimate() const
+{
+    const int pitch = m_thumbnailSize + THUMBNAIL_MARGIN + GRID_SPACING;
+    const int columns = qMax(MIN_GRID_COLUMNS,
+                             (viewport()->width() - 2 * CANVAS_MARGIN + GRID_SPACING) / pitch);
+    const int rows = viewport()->height() / pitch + 1;
+    return columns * rows;
+}
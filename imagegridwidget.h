@@ -3,62 +3,131 @@
 
 #include <QWidget>
 #include <QScrollArea>
-#include <QGridLayout>
 #include <QLabel>
 #include <QStringList>
 #include <QSet>
+#include "thumbnailatlas.h"
+
+// Forward declarations
+class QPainter;
+class ThumbnailService;
 
 /**
- * @brief Clickable thumbnail label widget
+ * @brief Painted thumbnail grid
  *
- * A QLabel that emits clicked signals and displays image thumbnails
- * with hover effects and tooltips.
+ * Draws all thumbnails of the grid in a single widget instead of one
+ * label per image. Thumbnails are packed into a ThumbnailAtlas; each cell
+ * is painted with one drawPixmap from an atlas page plus a procedural
+ * border. Cells evicted from a full atlas are refilled from the
+ * thumbnail service when they scroll back into view.
  */
-class ClickableLabel : public QLabel
+class ThumbnailGridCanvas : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit ClickableLabel(const QString &imagePath, QWidget *parent = nullptr);
+    explicit ThumbnailGridCanvas(ThumbnailService *thumbnailService, int thumbnailSize,
+                                 QWidget *parent = nullptr);
+
+    /**
+     * @brief Append a thumbnail cell to the grid
+     * @param imagePath Image file path
+     * @param thumbnail Thumbnail pixmap
+     */
+    void addThumbnail(const QString &imagePath, const QPixmap &thumbnail);
 
     /**
-     * @brief Get the associated image path
-     * @return Path to the image file
+     * @brief Get number of cells in the grid
+     * @return Cell count
      */
-    const QString& imagePath() const { return m_imagePath; }
+    int cellCount() const { return m_imagePaths.size(); }
 
 signals:
     /**
-     * @brief Emitted when the label is clicked
+     * @brief Emitted when a cell is clicked
      * @param imagePath Path to the associated image
      */
     void clicked(const QString &imagePath);
 
 protected:
+    /**
+     * @brief Paint the cells intersecting the exposed area
+     * @param event Paint event
+     */
+    void paintEvent(QPaintEvent *event) override;
+
     /**
      * @brief Handle mouse press events
      * @param event Mouse press event
      */
     void mousePressEvent(QMouseEvent *event) override;
 
+    /**
+     * @brief Reflow cells when the width changes
+     * @param event Resize event
+     */
+    void resizeEvent(QResizeEvent *event) override;
+
+    /**
+     * @brief Show per-cell tooltips
+     * @param event Generic event
+     * @return True if the event was handled
+     */
+    bool event(QEvent *event) override;
+
 private:
     /**
-     * @brief Setup thumbnail label properties
+     * @brief Get number of columns for the current width
+     * @return Column count
      */
-    void setupThumbnailLabel();
+    int columnCount() const;
 
-    QString m_imagePath;  ///< Associated image file path
-};
+    /**
+     * @brief Get the rectangle of a cell
+     * @param index Cell index
+     * @return Cell rectangle in widget coordinates
+     */
+    QRect cellRect(int index) const;
 
-// Forward declaration
-class ThumbnailService;
+    /**
+     * @brief Find the cell under a point
+     * @param pos Point in widget coordinates
+     * @return Cell index, or -1 if none
+     */
+    int cellAt(const QPoint &pos) const;
+
+    /**
+     * @brief Update minimum height to fit all rows
+     */
+    void updateContentHeight();
+
+    /**
+     * @brief Pack a thumbnail, restarting the atlas when it is full
+     * @param imagePath Image file path
+     * @param thumbnail Thumbnail pixmap
+     * @return Atlas region, invalid if the thumbnail does not fit
+     */
+    ThumbnailAtlas::Region packThumbnail(const QString &imagePath, const QPixmap &thumbnail);
+
+    /**
+     * @brief Paint a single cell
+     * @param painter Active painter
+     * @param index Cell index
+     */
+    void paintCell(QPainter &painter, int index);
+
+    ThumbnailService *m_thumbnailService;  ///< Source for evicted thumbnails
+    ThumbnailAtlas m_atlas;                ///< Packed thumbnail pages
+    QStringList m_imagePaths;              ///< Image path per cell, in grid order
+    int m_thumbnailSize;                   ///< Size of thumbnails in pixels
+};
 
 /**
  * @brief Grid widget for displaying image thumbnails
  *
  * Provides efficient thumbnail display with:
  * - Lazy loading of thumbnails
- * - Grid layout management
+ * - Atlas-backed painting of the grid
  * - Progress tracking
  * - Performance limits for large folders
  */
@@ -77,6 +146,16 @@ public:
      */
     void loadImagesFromFolder(const QString &folderPath);
 
+    /**
+     * @brief Display a known list of images without scanning the folder
+     *
+     * Used to restore a folder from catalog data; cached thumbnails are
+     * shown at once, the rest are generated in the background.
+     * @param folderPath Folder the images belong to
+     * @param imageFiles Image file paths in display order
+     */
+    void loadImages(const QString &folderPath, const QStringList &imageFiles);
+
     /**
      * @brief Clear all displayed images
      */
@@ -176,7 +255,7 @@ private:
     void connectSignals();
 
     /**
-     * @brief Create the thumbnail grid layout
+     * @brief Create the thumbnail grid canvas
      */
     void createThumbnailGrid();
 
@@ -195,19 +274,7 @@ private:
     // === Thumbnail Management ===
 
     /**
-     * @brief Create a clickable thumbnail widget
-     * @param imagePath Path to image file
-     * @return Configured ClickableLabel widget
-     */
-    ClickableLabel* createThumbnailWidget(const QString &imagePath);
-
-    /**
-     * @brief Calculate grid dimensions based on viewport
-     */
-    void calculateGridDimensions();
-
-    /**
-     * @brief Add thumbnail to the grid layout
+     * @brief Add thumbnail to the grid canvas
      * @param imagePath Image file path
      * @param thumbnail Thumbnail pixmap
      */
@@ -220,16 +287,6 @@ private:
      */
     void resetState();
 
-    /**
-     * @brief Reset grid position counters
-     */
-    void resetGridPosition();
-
-    /**
-     * @brief Advance to next grid position
-     */
-    void advanceGridPosition();
-
     /**
      * @brief Increment loaded count and emit progress
      */
@@ -255,6 +312,15 @@ private:
      */
     void startLoading();
 
+    /**
+     * @brief Request thumbnails for the next screenful of images
+     *
+     * Cached thumbnails are decoded synchronously, so requests are spread
+     * over event loop iterations to keep the first frame fast.
+     * @param generation Load generation the chunk belongs to
+     */
+    void requestThumbnailChunk(int generation);
+
     /**
      * @brief Check if image is already added to grid
      * @param imagePath Path to check
@@ -262,6 +328,12 @@ private:
      */
     bool isImageAlreadyInGrid(const QString &imagePath) const;
 
+    /**
+     * @brief Estimate how many cells fit in the viewport
+     * @return Number of cells on the first screen
+     */
+    int visibleCellEstimate() const;
+
     // === Service Reference ===
 
     ThumbnailService *m_thumbnailService;  ///< Thumbnail generation service
@@ -273,19 +345,17 @@ private:
     QStringList m_pendingImages;           ///< Images waiting for thumbnails
     QSet<QString> m_addedImages;           ///< Images already added to grid (prevents duplicates)
     int m_loadedCount;                     ///< Number of loaded thumbnails
+    int m_requestCursor;                   ///< Next image to request a thumbnail for
+    int m_loadGeneration;                  ///< Bumped per load to drop stale chunks
 
     // === Configuration ===
 
     int m_thumbnailSize;                   ///< Size of thumbnails in pixels
     int m_maxImagesPerLoad;               ///< Maximum images to load per folder
-    int m_gridColumns;                    ///< Number of columns in grid
 
     // === UI Components ===
 
-    QWidget *m_gridWidget;                ///< Container widget for grid
-    QGridLayout *m_gridLayout;            ///< Grid layout manager
-    int m_currentRow;                     ///< Current row in grid
-    int m_currentCol;                     ///< Current column in grid
+    ThumbnailGridCanvas *m_canvas;        ///< Painted thumbnail grid
 };
 
 #endif // IMAGEGRIDWIDGET_H
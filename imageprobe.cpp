@@ -0,0 +1,617 @@
+#include "imageprobe.h"
+#include "pagecacheadvisor.h"
+#include <QFile>
+#include <QImageReader>
+#include <QList>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QtEndian>
+#include <climits>
+
+// === Constants ===
+namespace {
+constexpr int HEADER_SIZE = 4096;              // Covers all fixed-position headers
+constexpr int MAX_JPEG_SEGMENTS = 64;          // Give up on pathological JPEG streams
+constexpr int MAX_TIFF_ENTRIES = 512;
+constexpr int MAX_TIFF_SUB_IFDS = 8;
+constexpr int TIFF_ENTRY_SIZE = 12;
+constexpr int HASH_READ_CHUNK = 1024 * 1024;   // Streaming chunk for the full-file hash
+constexpr int MAX_EXIF_STRING = 256;
+
+constexpr quint16 TIFF_TAG_NEW_SUBFILE_TYPE = 254;
+constexpr quint16 TIFF_TAG_IMAGE_WIDTH = 256;
+constexpr quint16 TIFF_TAG_IMAGE_LENGTH = 257;
+constexpr quint16 TIFF_TAG_MAKE = 0x010F;
+constexpr quint16 TIFF_TAG_MODEL = 0x0110;
+constexpr quint16 TIFF_TAG_ORIENTATION = 0x0112;
+constexpr quint16 TIFF_TAG_SUB_IFDS = 0x014A;
+constexpr quint16 TIFF_TAG_EXIF_IFD = 0x8769;
+constexpr quint16 EXIF_TAG_DATE_TIME_ORIGINAL = 0x9003;
+constexpr quint16 TIFF_TYPE_ASCII = 2;
+constexpr quint16 TIFF_TYPE_SHORT = 3;
+constexpr quint16 TIFF_TYPE_LONG = 4;
+constexpr quint16 TIFF_TYPE_IFD = 13;
+constexpr quint32 TIFF_SUBFILE_REDUCED = 1;    // NewSubfileType bit of previews and thumbnails
+
+constexpr uchar JPEG_MARKER_APP1 = 0xE1;
+const QByteArray EXIF_SIGNATURE("Exif\0\0", 6);
+const QString EXIF_DATE_FORMAT = "yyyy:MM:dd HH:mm:ss";
+
+const QByteArray JPEG_SIGNATURE("\xFF\xD8\xFF", 3);
+const QByteArray PNG_SIGNATURE("\x89PNG\r\n\x1A\n", 8);
+const QByteArray GIF87_SIGNATURE("GIF87a", 6);
+const QByteArray GIF89_SIGNATURE("GIF89a", 6);
+const QByteArray BMP_SIGNATURE("BM", 2);
+const QByteArray RIFF_SIGNATURE("RIFF", 4);
+const QByteArray WEBP_SIGNATURE("WEBP", 4);
+const QByteArray TIFF_LE_SIGNATURE("II*\0", 4);
+const QByteArray TIFF_BE_SIGNATURE("MM\0*", 4);
+const QByteArray CR2_SIGNATURE("CR", 2);       // At offset 8; IFD0 is a preview, no SubIFDs
+
+quint16 readU16(const QByteArray &data, int pos, bool littleEndian)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData()) + pos;
+    return littleEndian ? qFromLittleEndian<quint16>(bytes) : qFromBigEndian<quint16>(bytes);
+}
+
+quint32 readU32(const QByteArray &data, int pos, bool littleEndian)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData()) + pos;
+    return littleEndian ? qFromLittleEndian<quint32>(bytes) : qFromBigEndian<quint32>(bytes);
+}
+
+quint32 readU24LE(const QByteArray &data, int pos)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData()) + pos;
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+}
+
+bool isJpegStartOfFrame(uchar marker)
+{
+    // SOF0..SOF15 except DHT (C4), JPG (C8) and DAC (CC)
+    return marker >= 0xC0 && marker <= 0xCF &&
+           marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+ImageProbe::Info makeInfo(const char *format, qint64 width, qint64 height)
+{
+    ImageProbe::Info info;
+    if (width > 0 && height > 0 && width <= INT_MAX && height <= INT_MAX) {
+        info.format = format;
+        info.size = QSize(int(width), int(height));
+    }
+    return info;
+}
+}
+
+// === Source ===
+
+/**
+ * @brief Byte access that serves from the header buffer before touching the device
+ */
+class ImageProbe::Source
+{
+public:
+    Source(QIODevice *device, const QByteArray &head)
+        : m_device(device)
+        , m_head(head)
+    {
+    }
+
+    const QByteArray &head() const { return m_head; }
+
+    QByteArray read(qint64 offset, int length)
+    {
+        if (offset >= 0 && offset + length <= m_head.size()) {
+            return m_head.mid(int(offset), length);
+        }
+        if (!m_device || !m_device->seek(offset)) {
+            return QByteArray();
+        }
+        return m_device->read(length);
+    }
+
+private:
+    QIODevice *m_device;
+    const QByteArray &m_head;
+};
+
+// === Public Methods ===
+
+ImageProbe::Info ImageProbe::probe(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return Info();
+    }
+
+    const QByteArray head = file.read(HEADER_SIZE);
+    return probe(&file, head);
+}
+
+ImageProbe::Info ImageProbe::probe(QIODevice *device, const QByteArray &head)
+{
+    Source source(device, head);
+    Info info;
+
+    if (head.startsWith(JPEG_SIGNATURE)) {
+        info = parseJpeg(source);
+    } else if (head.startsWith(PNG_SIGNATURE)) {
+        info = parsePng(source);
+    } else if (head.startsWith(GIF87_SIGNATURE) || head.startsWith(GIF89_SIGNATURE)) {
+        info = parseGif(source);
+    } else if (head.startsWith(BMP_SIGNATURE)) {
+        info = parseBmp(source);
+    } else if (head.startsWith(RIFF_SIGNATURE) && head.mid(8, 4) == WEBP_SIGNATURE) {
+        info = parseWebp(source);
+    } else if (head.startsWith(TIFF_LE_SIGNATURE) || head.startsWith(TIFF_BE_SIGNATURE)) {
+        info = parseTiff(source);
+        // A RAW file without a full-size IFD stays unsized; the fallback
+        // decoder would only find its preview
+        if (!info.format.isEmpty()) {
+            return info;
+        }
+    }
+
+    if (info.isValid()) {
+        return info;
+    }
+
+    return fallbackProbe(device);
+}
+
+ImageProbe::FileProbe ImageProbe::probeFile(const QString &filePath, ProbeOptions options,
+                                            int hashBlockSize)
+{
+    FileProbe result;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open file for probing:" << filePath;
+        return result;
+    }
+
+    result.opened = true;
+    result.fileSize = file.size();
+
+    // 1. One head read shared by every consumer
+    const int headSize = qMax(HEADER_SIZE, hashBlockSize);
+    const QByteArray head = file.read(headSize);
+
+    // 2. Format, dimensions and EXIF from the head (rarely a few more bytes)
+    result.image = probe(&file, head);
+    if (options & Exif) {
+        Source source(&file, head);
+        result.exif = parseExif(source);
+    }
+
+    // 3. Head and tail blocks for the partial hash
+    if (options & PartialHash) {
+        QByteArray tail;
+        if (result.fileSize > qint64(hashBlockSize) * 2 && file.seek(result.fileSize - hashBlockSize)) {
+            tail = file.read(hashBlockSize);
+        }
+        result.partialHash = partialHash(head, tail, result.fileSize, hashBlockSize);
+    }
+
+    // 4. Rest of the body, streamed once into the full hash and/or the buffer
+    if (options & (FullHash | KeepContents)) {
+        const bool keepContents = options.testFlag(KeepContents);
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        hash.addData(head);
+
+        if (keepContents) {
+            result.contents.reserve(result.fileSize);
+            result.contents.append(head);
+        }
+
+        if (file.seek(head.size())) {
+            PageCacheAdvisor advisor(options.testFlag(DropCache) ? file.handle() : -1);
+            while (!file.atEnd()) {
+                const QByteArray chunk = file.read(HASH_READ_CHUNK);
+                if (chunk.isEmpty()) {
+                    break;
+                }
+                hash.addData(chunk);
+                if (keepContents) {
+                    result.contents.append(chunk);
+                }
+                advisor.advance(file.pos());
+            }
+        }
+
+        if (options & FullHash) {
+            result.fullHash = hash.result().toHex();
+        }
+    }
+
+    return result;
+}
+
+QString ImageProbe::partialHash(const QByteArray &head, const QByteArray &tail,
+                               qint64 fileSize, int blockSize)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(head.left(blockSize));
+
+    // Tail only counts when it does not overlap the head
+    if (fileSize > qint64(blockSize) * 2) {
+        hash.addData(tail);
+    }
+
+    return hash.result().toHex();
+}
+
+QList<qint64> ImageProbe::sampleOffsets(qint64 fileSize, int sampleCount, int edgeSize, int blockSize)
+{
+    QList<qint64> offsets;
+    const qint64 interior = fileSize - qint64(edgeSize) * 2;
+    if (interior <= 0 || sampleCount <= 0 || blockSize <= 0) {
+        return offsets;
+    }
+
+    // Never more blocks than fit side by side; the positions only depend on
+    // the file size, so copies are sampled at the same places
+    const int count = static_cast<int>(qMin<qint64>(sampleCount, qMax<qint64>(1, interior / blockSize)));
+    const qint64 span = qMax<qint64>(0, interior - blockSize);
+    for (int i = 0; i < count; ++i) {
+        offsets.append(edgeSize + span * (i + 1) / (count + 1));
+    }
+    return offsets;
+}
+
+QString ImageProbe::sampledHash(const QByteArray &head, const QList<QByteArray> &samples,
+                                const QByteArray &tail, qint64 fileSize, int edgeSize)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(QByteArray::number(fileSize));
+    hash.addData(head.left(edgeSize));
+    for (const QByteArray &sample : samples) {
+        hash.addData(sample);
+    }
+
+    if (fileSize > qint64(edgeSize) * 2) {
+        hash.addData(tail);
+    }
+
+    return hash.result().toHex();
+}
+
+int ImageProbe::headerSize()
+{
+    return HEADER_SIZE;
+}
+
+// === Private Methods - Format Parsers ===
+
+ImageProbe::Info ImageProbe::parseJpeg(Source &source)
+{
+    qint64 offset = 2;
+
+    for (int i = 0; i < MAX_JPEG_SEGMENTS; ++i) {
+        // FF <marker> <length:2> [<precision:1> <height:2> <width:2>]
+        const QByteArray segment = source.read(offset, 9);
+        if (segment.size() < 4 || uchar(segment[0]) != 0xFF) {
+            return Info();
+        }
+
+        const uchar marker = uchar(segment[1]);
+        if (marker == 0xFF) {
+            offset += 1; // Fill byte
+            continue;
+        }
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            offset += 2; // Standalone marker
+            continue;
+        }
+        if (marker == 0xD9 || marker == 0xDA) {
+            return Info(); // End of image or start of scan without a frame header
+        }
+
+        if (isJpegStartOfFrame(marker)) {
+            if (segment.size() < 9) {
+                return Info();
+            }
+            return makeInfo("jpeg", readU16(segment, 7, false), readU16(segment, 5, false));
+        }
+
+        const quint16 length = readU16(segment, 2, false);
+        if (length < 2) {
+            return Info();
+        }
+        offset += 2 + length;
+    }
+
+    return Info();
+}
+
+ImageProbe::Info ImageProbe::parsePng(Source &source)
+{
+    // Signature (8), IHDR length (4), "IHDR" (4), width (4), height (4)
+    const QByteArray &head = source.head();
+    if (head.size() < 24 || head.mid(12, 4) != "IHDR") {
+        return Info();
+    }
+
+    return makeInfo("png", readU32(head, 16, false), readU32(head, 20, false));
+}
+
+ImageProbe::Info ImageProbe::parseGif(Source &source)
+{
+    // Logical screen descriptor follows the 6-byte signature
+    const QByteArray &head = source.head();
+    if (head.size() < 10) {
+        return Info();
+    }
+
+    return makeInfo("gif", readU16(head, 6, true), readU16(head, 8, true));
+}
+
+ImageProbe::Info ImageProbe::parseBmp(Source &source)
+{
+    // File header (14), then the DIB header starting with its own size
+    const QByteArray &head = source.head();
+    if (head.size() < 26) {
+        return Info();
+    }
+
+    const quint32 dibSize = readU32(head, 14, true);
+    if (dibSize == 12) {
+        // BITMAPCOREHEADER: 16-bit dimensions
+        return makeInfo("bmp", readU16(head, 18, true), readU16(head, 20, true));
+    }
+
+    // Negative height means a top-down bitmap
+    const qint32 width = qint32(readU32(head, 18, true));
+    const qint32 height = qint32(readU32(head, 22, true));
+    return makeInfo("bmp", width, qAbs(qint64(height)));
+}
+
+ImageProbe::Info ImageProbe::parseWebp(Source &source)
+{
+    // RIFF header (12), first chunk FourCC (4) and size (4), chunk payload
+    const QByteArray &head = source.head();
+    if (head.size() < 30) {
+        return Info();
+    }
+
+    const QByteArray chunk = head.mid(12, 4);
+
+    if (chunk == "VP8 ") {
+        // Frame tag (3), start code 9D 01 2A, then 14-bit dimensions
+        if (uchar(head[23]) != 0x9D || uchar(head[24]) != 0x01 || uchar(head[25]) != 0x2A) {
+            return Info();
+        }
+        return makeInfo("webp", readU16(head, 26, true) & 0x3FFF, readU16(head, 28, true) & 0x3FFF);
+    }
+
+    if (chunk == "VP8L") {
+        // Signature 0x2F, then 14-bit (width - 1) and (height - 1)
+        if (uchar(head[20]) != 0x2F) {
+            return Info();
+        }
+        const quint32 bits = readU32(head, 21, true);
+        return makeInfo("webp", (bits & 0x3FFF) + 1, ((bits >> 14) & 0x3FFF) + 1);
+    }
+
+    if (chunk == "VP8X") {
+        // Flags (4), then 24-bit (canvas width - 1) and (canvas height - 1)
+        return makeInfo("webp", readU24LE(head, 24) + 1, readU24LE(head, 27) + 1);
+    }
+
+    return Info();
+}
+
+ImageProbe::Info ImageProbe::parseTiff(Source &source)
+{
+    const QByteArray &head = source.head();
+    if (head.size() < 8) {
+        return Info();
+    }
+
+    const bool littleEndian = head.startsWith(TIFF_LE_SIGNATURE);
+
+    struct Ifd {
+        qint64 width = 0;
+        qint64 height = 0;
+        quint32 subfileType = 0;
+        QList<quint32> subIfds;
+    };
+    auto readIfd = [&](quint32 ifdOffset) {
+        Ifd ifd;
+        const QByteArray entries = readIfdEntries(source, 0, ifdOffset, littleEndian);
+        for (int pos = 0; pos + TIFF_ENTRY_SIZE <= entries.size(); pos += TIFF_ENTRY_SIZE) {
+            const quint16 tag = readU16(entries, pos, littleEndian);
+            if (tag != TIFF_TAG_IMAGE_WIDTH && tag != TIFF_TAG_IMAGE_LENGTH &&
+                tag != TIFF_TAG_NEW_SUBFILE_TYPE && tag != TIFF_TAG_SUB_IFDS) {
+                continue;
+            }
+
+            // Values that fit in 4 bytes are stored inline, left-justified
+            const quint16 type = readU16(entries, pos + 2, littleEndian);
+            const quint32 count = readU32(entries, pos + 4, littleEndian);
+            qint64 value = 0;
+            if (type == TIFF_TYPE_SHORT) {
+                value = readU16(entries, pos + 8, littleEndian);
+            } else if (type == TIFF_TYPE_LONG || type == TIFF_TYPE_IFD) {
+                value = readU32(entries, pos + 8, littleEndian);
+            }
+
+            if (tag == TIFF_TAG_IMAGE_WIDTH) {
+                ifd.width = value;
+            } else if (tag == TIFF_TAG_IMAGE_LENGTH) {
+                ifd.height = value;
+            } else if (tag == TIFF_TAG_NEW_SUBFILE_TYPE) {
+                ifd.subfileType = quint32(value);
+            } else if (count == 1) {
+                ifd.subIfds.append(quint32(value));
+            } else if (type == TIFF_TYPE_LONG || type == TIFF_TYPE_IFD) {
+                const int listed = int(qMin<quint32>(count, MAX_TIFF_SUB_IFDS));
+                const QByteArray offsets = source.read(quint32(value), listed * 4);
+                for (int i = 0; i + 4 <= offsets.size(); i += 4) {
+                    ifd.subIfds.append(readU32(offsets, i, littleEndian));
+                }
+            }
+        }
+        return ifd;
+    };
+
+    // TIFF-based RAW files (DNG, NEF, ARW, ...) keep a reduced preview in
+    // IFD0 and the sensor image in a SubIFD; the largest full-size one wins
+    const Ifd ifd0 = readIfd(readU32(head, 4, littleEndian));
+    Ifd full;
+    for (quint32 offset : ifd0.subIfds) {
+        const Ifd sub = readIfd(offset);
+        if (!(sub.subfileType & TIFF_SUBFILE_REDUCED) &&
+            sub.width * sub.height > full.width * full.height) {
+            full = sub;
+        }
+    }
+
+    if (full.width == 0 || full.height == 0) {
+        const bool ifd0IsPreview = (ifd0.subfileType & TIFF_SUBFILE_REDUCED) ||
+                                   head.mid(8, 2) == CR2_SIGNATURE;
+        if (ifd0IsPreview) {
+            Info info;
+            info.format = "tiff";
+            return info;
+        }
+        full = ifd0;
+    }
+
+    return makeInfo("tiff", full.width, full.height);
+}
+
+// === Private Methods - EXIF ===
+
+ImageProbe::ExifInfo ImageProbe::parseExif(Source &source)
+{
+    const QByteArray &head = source.head();
+
+    if (head.startsWith(TIFF_LE_SIGNATURE) || head.startsWith(TIFF_BE_SIGNATURE)) {
+        return parseExifTiff(source, 0);
+    }
+
+    if (!head.startsWith(JPEG_SIGNATURE)) {
+        return ExifInfo();
+    }
+
+    // APP1 "Exif\0\0" precedes the frame header
+    qint64 offset = 2;
+    for (int i = 0; i < MAX_JPEG_SEGMENTS; ++i) {
+        const QByteArray segment = source.read(offset, 10);
+        if (segment.size() < 4 || uchar(segment[0]) != 0xFF) {
+            break;
+        }
+
+        const uchar marker = uchar(segment[1]);
+        if (marker == 0xFF) {
+            offset += 1;
+            continue;
+        }
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            offset += 2;
+            continue;
+        }
+        if (marker == 0xD9 || marker == 0xDA || isJpegStartOfFrame(marker)) {
+            break;
+        }
+
+        if (marker == JPEG_MARKER_APP1 && segment.mid(4, 6) == EXIF_SIGNATURE) {
+            return parseExifTiff(source, offset + 10);
+        }
+
+        const quint16 length = readU16(segment, 2, false);
+        if (length < 2) {
+            break;
+        }
+        offset += 2 + length;
+    }
+
+    return ExifInfo();
+}
+
+ImageProbe::ExifInfo ImageProbe::parseExifTiff(Source &source, qint64 base)
+{
+    ExifInfo exif;
+
+    const QByteArray header = source.read(base, 8);
+    if (header.size() < 8 ||
+        (!header.startsWith(TIFF_LE_SIGNATURE) && !header.startsWith(TIFF_BE_SIGNATURE))) {
+        return exif;
+    }
+
+    const bool littleEndian = header.startsWith(TIFF_LE_SIGNATURE);
+
+    // ASCII values up to 4 bytes are inline, longer ones live at an offset
+    auto readString = [&](const QByteArray &entries, int pos) {
+        const quint32 count = qMin<quint32>(readU32(entries, pos + 4, littleEndian), MAX_EXIF_STRING);
+        const QByteArray raw = count <= 4
+            ? entries.mid(pos + 8, int(count))
+            : source.read(base + readU32(entries, pos + 8, littleEndian), int(count));
+        const int end = raw.indexOf('\0');
+        return QString::fromLatin1(end >= 0 ? raw.left(end) : raw).trimmed();
+    };
+
+    quint32 exifIfdOffset = 0;
+    const QByteArray ifd0 = readIfdEntries(source, base, readU32(header, 4, littleEndian), littleEndian);
+    for (int pos = 0; pos + TIFF_ENTRY_SIZE <= ifd0.size(); pos += TIFF_ENTRY_SIZE) {
+        const quint16 tag = readU16(ifd0, pos, littleEndian);
+        const quint16 type = readU16(ifd0, pos + 2, littleEndian);
+
+        if (tag == TIFF_TAG_MAKE && type == TIFF_TYPE_ASCII) {
+            exif.cameraMake = readString(ifd0, pos);
+        } else if (tag == TIFF_TAG_MODEL && type == TIFF_TYPE_ASCII) {
+            exif.cameraModel = readString(ifd0, pos);
+        } else if (tag == TIFF_TAG_ORIENTATION && type == TIFF_TYPE_SHORT) {
+            exif.orientation = readU16(ifd0, pos + 8, littleEndian);
+        } else if (tag == TIFF_TAG_EXIF_IFD && type == TIFF_TYPE_LONG) {
+            exifIfdOffset = readU32(ifd0, pos + 8, littleEndian);
+        }
+    }
+
+    if (exifIfdOffset == 0) {
+        return exif;
+    }
+
+    const QByteArray exifIfd = readIfdEntries(source, base, exifIfdOffset, littleEndian);
+    for (int pos = 0; pos + TIFF_ENTRY_SIZE <= exifIfd.size(); pos += TIFF_ENTRY_SIZE) {
+        const quint16 tag = readU16(exifIfd, pos, littleEndian);
+        const quint16 type = readU16(exifIfd, pos + 2, littleEndian);
+
+        if (tag == EXIF_TAG_DATE_TIME_ORIGINAL && type == TIFF_TYPE_ASCII) {
+            exif.dateTaken = QDateTime::fromString(readString(exifIfd, pos), EXIF_DATE_FORMAT);
+            break;
+        }
+    }
+
+    return exif;
+}
+
+QByteArray ImageProbe::readIfdEntries(Source &source, qint64 base, quint32 ifdOffset,
+                                      bool littleEndian)
+{
+    const QByteArray countBytes = source.read(base + ifdOffset, 2);
+    if (countBytes.size() < 2) {
+        return QByteArray();
+    }
+
+    const int entryCount = qMin<int>(readU16(countBytes, 0, littleEndian), MAX_TIFF_ENTRIES);
+    return source.read(base + ifdOffset + 2, entryCount * TIFF_ENTRY_SIZE);
+}
+
+ImageProbe::Info ImageProbe::fallbackProbe(QIODevice *device)
+{
+    Info info;
+    if (!device || !device->seek(0)) {
+        return info;
+    }
+
+    QImageReader reader(device);
+    if (reader.canRead()) {
+        info.format = reader.format();
+        info.size = reader.size();
+    }
+
+    return info;
+}
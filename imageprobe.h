@@ -0,0 +1,201 @@
+#ifndef IMAGEPROBE_H
+#define IMAGEPROBE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFlags>
+#include <QList>
+#include <QSize>
+#include <QString>
+
+class QIODevice;
+
+/**
+ * @brief Fast image format and dimension probe
+ *
+ * Reads image dimensions straight from the file header instead of going
+ * through QImageReader plugin lookup and format probing:
+ * - JPEG (SOFn marker), PNG (IHDR), GIF (logical screen descriptor)
+ * - BMP (DIB header), WebP (VP8/VP8L/VP8X), TIFF (full-size IFD)
+ * Unknown or malformed files fall back to QImageReader. TIFF-based RAW
+ * files are sized from their full-size SubIFD; when none is found they
+ * report no size rather than the size of their embedded preview.
+ *
+ * probeFile() fuses the per-file metadata work into a single open: the
+ * head block read once serves the dimension parser, the EXIF parser and
+ * the head part of the content hashes; only the tail (partial hash) or
+ * the rest of the body (full hash) is read in addition. With KeepContents
+ * the streamed body is also returned, so a thumbnail can be decoded from
+ * memory without reading the file a second time. With DropCache the
+ * streamed body does not stay in the page cache after the probe.
+ */
+class ImageProbe
+{
+public:
+    /**
+     * @brief Result of a probe
+     */
+    struct Info {
+        QByteArray format;           ///< Lower-case format name ("jpeg", "png", ...)
+        QSize size;                  ///< Image dimensions, invalid if unreadable
+
+        bool isValid() const { return size.isValid() && !size.isEmpty(); }
+    };
+
+    /**
+     * @brief Subset of EXIF metadata
+     */
+    struct ExifInfo {
+        QString cameraMake;          ///< Make (0x010F)
+        QString cameraModel;         ///< Model (0x0110)
+        QDateTime dateTaken;         ///< DateTimeOriginal (0x9003)
+        int orientation = 0;         ///< Orientation (0x0112), 0 if absent
+    };
+
+    /**
+     * @brief What probeFile() should derive besides format and dimensions
+     */
+    enum ProbeOption {
+        NoOptions = 0x0,
+        PartialHash = 0x1,           ///< MD5 of head block and tail block
+        FullHash = 0x2,              ///< MD5 of the whole file
+        Exif = 0x4,                  ///< Parse EXIF metadata
+        KeepContents = 0x8,          ///< Return the whole file (implies a full read)
+        DropCache = 0x10             ///< Drop streamed pages from the page cache
+    };
+    Q_DECLARE_FLAGS(ProbeOptions, ProbeOption)
+
+    /**
+     * @brief Result of a fused file probe
+     */
+    struct FileProbe {
+        bool opened = false;         ///< False if the file could not be opened
+        qint64 fileSize = 0;         ///< File size in bytes
+        Info image;                  ///< Format and dimensions
+        ExifInfo exif;               ///< EXIF subset (if requested)
+        QString partialHash;         ///< Hex MD5 of head and tail blocks (if requested)
+        QString fullHash;            ///< Hex MD5 of the file (if requested)
+        QByteArray contents;         ///< Whole file (if KeepContents was requested)
+    };
+
+    /**
+     * @brief Probe an image file
+     * @param filePath Path to image file
+     * @return Format and dimensions (invalid if unreadable)
+     */
+    static Info probe(const QString &filePath);
+
+    /**
+     * @brief Probe an open device using already-read header bytes
+     * @param device Open, seekable device positioned anywhere
+     * @param head Bytes read from the start of the device
+     * @return Format and dimensions (invalid if unreadable)
+     *
+     * Most formats are parsed from @p head alone; only JPEG files with large
+     * metadata segments and TIFF files with a distant IFD read more.
+     */
+    static Info probe(QIODevice *device, const QByteArray &head);
+
+    /**
+     * @brief Open a file once and derive all requested metadata
+     * @param filePath Path to image file
+     * @param options Hashes and metadata to derive
+     * @param hashBlockSize Size of the head and tail blocks of the partial hash
+     * @return Probe result
+     *
+     * The partial hash covers the first @p hashBlockSize bytes, plus the last
+     * @p hashBlockSize bytes when the file is larger than twice that.
+     */
+    static FileProbe probeFile(const QString &filePath, ProbeOptions options,
+                               int hashBlockSize = 16384);
+
+    /**
+     * @brief Combine head and tail blocks into the partial hash used by probeFile()
+     * @param head Bytes from the start of the file (at least @p blockSize if available)
+     * @param tail Last @p blockSize bytes of the file
+     * @param fileSize File size in bytes
+     * @param blockSize Head and tail block size
+     * @return Hex MD5
+     */
+    static QString partialHash(const QByteArray &head, const QByteArray &tail,
+                               qint64 fileSize, int blockSize);
+
+    /**
+     * @brief Get the offsets of the interior blocks of a sampled hash
+     * @param fileSize File size in bytes
+     * @param sampleCount Number of interior blocks
+     * @param edgeSize Size of the head and tail blocks, which are not sampled again
+     * @param blockSize Interior block size
+     * @return Offsets spread evenly between head and tail; fewer when the
+     *         interior is small, none when head and tail cover the file
+     */
+    static QList<qint64> sampleOffsets(qint64 fileSize, int sampleCount, int edgeSize, int blockSize);
+
+    /**
+     * @brief Combine file size, head, interior samples and tail into a sampled hash
+     *
+     * Unlike partialHash(), this tells apart files that only differ in the
+     * middle, such as re-saved burst shots with identical headers and trailers.
+     * @param head Bytes from the start of the file (at least @p edgeSize if available)
+     * @param samples Blocks read at sampleOffsets()
+     * @param tail Last @p edgeSize bytes of the file
+     * @param fileSize File size in bytes
+     * @param edgeSize Head and tail block size
+     * @return Hex MD5
+     */
+    static QString sampledHash(const QByteArray &head, const QList<QByteArray> &samples,
+                               const QByteArray &tail, qint64 fileSize, int edgeSize);
+
+    /**
+     * @brief Get number of header bytes worth reading up front
+     * @return Header size in bytes
+     */
+    static int headerSize();
+
+private:
+    class Source;
+
+    static Info parseJpeg(Source &source);
+    static Info parsePng(Source &source);
+    static Info parseGif(Source &source);
+    static Info parseBmp(Source &source);
+    static Info parseWebp(Source &source);
+    static Info parseTiff(Source &source);
+
+    /**
+     * @brief Parse EXIF from a JPEG APP1 segment or a TIFF file
+     * @param source Byte source
+     * @return EXIF subset (empty if none found)
+     */
+    static ExifInfo parseExif(Source &source);
+
+    /**
+     * @brief Parse EXIF tags from an embedded TIFF structure
+     * @param source Byte source
+     * @param base Offset of the TIFF header
+     * @return EXIF subset
+     */
+    static ExifInfo parseExifTiff(Source &source, qint64 base);
+
+    /**
+     * @brief Read the raw entries of a TIFF image file directory
+     * @param source Byte source
+     * @param base Offset of the TIFF header
+     * @param ifdOffset IFD offset relative to @p base
+     * @param littleEndian Byte order of the TIFF structure
+     * @return Entry bytes (12 per entry, may be truncated)
+     */
+    static QByteArray readIfdEntries(Source &source, qint64 base, quint32 ifdOffset,
+                                     bool littleEndian);
+
+    /**
+     * @brief Decode the header with QImageReader
+     * @param device Open device
+     * @return Format and dimensions (invalid if unreadable)
+     */
+    static Info fallbackProbe(QIODevice *device);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ImageProbe::ProbeOptions)
+
+#endif // IMAGEPROBE_H
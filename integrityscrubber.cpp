@@ -0,0 +1,505 @@
+#include "integrityscrubber.h"
+#include "projectmanager.h"
+#include "taskscheduler.h"
+#include "ioconcurrencycontroller.h"
+#include "pagecacheadvisor.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QEvent>
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+#include <QDebug>
+
+// === Constants ===
+namespace {
+const QString CURSOR_KEY = "integrity_scrub_cursor";
+const QString ACTIVE_KEY = "integrity_scrub_active";
+const QString RATE_KEY = "integrity_scrub_rate";
+const QString LAST_PASS_KEY = "integrity_scrub_last_pass";
+
+constexpr int BATCH_SIZE = 200;
+constexpr int REFILL_THRESHOLD = BATCH_SIZE / 2;   // Fetch when fewer files are queued
+constexpr int MAX_QUEUED = BATCH_SIZE * 8;         // Fetch for a starved volume up to this
+constexpr int CURSOR_SAVE_INTERVAL = 50;
+constexpr int PROGRESS_UPDATE_INTERVAL = 10;
+constexpr int DEFAULT_RATE_MBPS = 40;              // 4 TB in about 30 hours of idle time
+constexpr int USER_IDLE_MS = 1500;                 // Pause while input is more recent than this
+constexpr int IDLE_RECHECK_MS = 500;
+constexpr int PERMIT_RETRY_MS = 20;                // Requeue delay while a volume is at its I/O limit
+constexpr int READ_CHUNK_SIZE = 1024 * 1024;
+constexpr qint64 BYTES_PER_MB = 1024 * 1024;
+}
+
+// === Constructor & Destructor ===
+
+IntegrityScrubber::IntegrityScrubber(ProjectManager *projectManager, QObject *parent)
+    : QObject(parent)
+    , m_projectManager(projectManager)
+    , m_nextReadMs(0)
+    , m_cursor(0)
+    , m_fetchCursor(0)
+    , m_exhausted(false)
+    , m_queuedCount(0)
+    , m_doneCount(0)
+    , m_session(0)
+    , m_stopFlag(std::make_shared<QAtomicInt>(0))
+    , m_verifiedCount(0)
+    , m_corruptedCount(0)
+    , m_bytesRead(0)
+    , m_rateLimit(DEFAULT_RATE_MBPS)
+    , m_running(false)
+{
+    m_stepTimer = new QTimer(this);
+    m_stepTimer->setSingleShot(true);
+    connect(m_stepTimer, &QTimer::timeout, this, &IntegrityScrubber::processNext);
+
+    m_lastInteraction.start();
+    QCoreApplication::instance()->installEventFilter(this);
+}
+
+IntegrityScrubber::~IntegrityScrubber()
+{
+    // In-flight reads own their stop flag and stop at the next chunk;
+    // nothing is waited for on this thread
+    m_running = false;
+    m_stopFlag->storeRelaxed(1);
+}
+
+// === Control ===
+
+void IntegrityScrubber::start()
+{
+    if (m_running || !m_projectManager || !m_projectManager->hasOpenProject()) {
+        return;
+    }
+
+    m_running = true;
+    m_session++;
+    m_stopFlag = std::make_shared<QAtomicInt>(0);
+    m_verifiedCount = 0;
+    m_corruptedCount = 0;
+    m_doneCount = 0;
+    m_bytesRead = 0;
+    m_cursor = m_projectManager->getProjectValue(CURSOR_KEY, 0).toInt();
+    m_fetchCursor = m_cursor;
+    m_exhausted = false;
+    m_rateLimit = rateLimit();
+
+    const QStringList corrupted = m_projectManager->getCorruptedFiles();
+    m_knownCorrupted = QSet<QString>(corrupted.begin(), corrupted.end());
+
+    m_projectManager->setProjectValue(ACTIVE_KEY, true);
+    m_clock.start();
+    m_nextReadMs = 0;
+
+    qDebug() << "Integrity scrub starting after record" << m_cursor << "at" << m_rateLimit << "MB/s";
+    scheduleNext(IDLE_RECHECK_MS);
+}
+
+void IntegrityScrubber::resumePendingPass()
+{
+    if (m_projectManager && m_projectManager->hasOpenProject() &&
+        m_projectManager->getProjectValue(ACTIVE_KEY, false).toBool()) {
+        start();
+    }
+}
+
+void IntegrityScrubber::pause()
+{
+    if (!m_running) {
+        return;
+    }
+
+    halt();
+    saveCursor();
+    m_projectManager->setProjectValue(ACTIVE_KEY, false);
+    qDebug() << "Integrity scrub paused at record" << m_cursor;
+}
+
+void IntegrityScrubber::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    // In-flight reads are canceled; those files are read again next session
+    halt();
+    saveCursor();
+}
+
+void IntegrityScrubber::setRateLimit(int megabytesPerSecond)
+{
+    m_rateLimit = qMax(1, megabytesPerSecond);
+    if (m_projectManager && m_projectManager->hasOpenProject()) {
+        m_projectManager->setProjectValue(RATE_KEY, m_rateLimit);
+    }
+}
+
+// === Information ===
+
+int IntegrityScrubber::rateLimit() const
+{
+    if (!m_projectManager || !m_projectManager->hasOpenProject()) {
+        return m_rateLimit;
+    }
+    return qMax(1, m_projectManager->getProjectValue(RATE_KEY, DEFAULT_RATE_MBPS).toInt());
+}
+
+QDateTime IntegrityScrubber::lastCompletedPass() const
+{
+    if (!m_projectManager || !m_projectManager->hasOpenProject()) {
+        return QDateTime();
+    }
+    return m_projectManager->getProjectValue(LAST_PASS_KEY).toDateTime();
+}
+
+// === Event Filter ===
+
+bool IntegrityScrubber::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+        m_lastInteraction.restart();
+        break;
+    default:
+        break;
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
+// === Private Slots ===
+
+void IntegrityScrubber::processNext()
+{
+    if (!m_running) {
+        return;
+    }
+
+    if (!isUserIdle()) {
+        scheduleNext(IDLE_RECHECK_MS);
+        return;
+    }
+
+    // Keep every volume supplied; a volume whose files are rare in ID order
+    // may pull more batches, up to MAX_QUEUED files in all
+    bool starved = false;
+    for (const Volume &volume : std::as_const(m_volumes)) {
+        starved |= !volume.busy && volume.queue.isEmpty();
+    }
+    if (!m_exhausted && (m_queuedCount < REFILL_THRESHOLD || (starved && m_queuedCount < MAX_QUEUED))) {
+        fetchNextBatch();
+        if (!m_running) {
+            return;
+        }
+    }
+
+    if (m_queuedCount == 0 && inFlightCount() == 0) {
+        if (m_exhausted) {
+            finishPass();
+        }
+        return;
+    }
+
+    // One file in flight per volume; the read budget is shared, each file
+    // pays for its size before it starts
+    const qint64 bytesPerSecond = qint64(m_rateLimit) * BYTES_PER_MB;
+    for (auto it = m_volumes.begin(); it != m_volumes.end(); ++it) {
+        Volume &volume = it.value();
+        if (volume.busy || volume.queue.isEmpty()) {
+            continue;
+        }
+
+        const qint64 now = m_clock.elapsed();
+        if (m_nextReadMs > now) {
+            scheduleNext(static_cast<int>(m_nextReadMs - now));
+            return;
+        }
+
+        const Item item = volume.queue.takeFirst();
+        m_queuedCount--;
+        const qint64 chargeMs = item.fileSize * 1000 / bytesPerSecond;
+        m_nextReadMs = qMax(m_nextReadMs, now) + chargeMs;
+
+        volume.inFlight = item;
+        volume.inFlightSession = m_session;
+        volume.inFlightChargeMs = chargeMs;
+        volume.busy = true;
+        const std::shared_ptr<QAtomicInt> stopFlag = m_stopFlag;
+        volume.watcher->setFuture(TaskScheduler::instance()->run(TaskScheduler::Priority::Background,
+                                                                 [item, stopFlag]() {
+            return verifyFile(item, stopFlag);
+        }));
+    }
+}
+
+// === Private Methods ===
+
+IntegrityScrubber::Result IntegrityScrubber::verifyFile(const Item &item,
+                                                       const std::shared_ptr<QAtomicInt> &stopFlag)
+{
+    Result result;
+    if (stopFlag->loadRelaxed()) {
+        result.outcome = Outcome::Canceled;
+        return result;
+    }
+
+    const QFileInfo info(item.filePath);
+    if (!info.exists()) {
+        result.outcome = Outcome::Missing;
+        return result;
+    }
+
+    // A file rewritten on purpose has a new size; sync re-hashes it. A new
+    // date alone (touched, restored from a backup) is verified like the rest
+    if (info.size() != item.fileSize) {
+        result.outcome = Outcome::Changed;
+        return result;
+    }
+    result.dateModified = info.lastModified();
+
+    // Read under a volume permit so slow mounts are not flooded; a volume at
+    // its limit hands the file back instead of parking this worker
+    IoConcurrencyController::Permit permit(item.filePath);
+    if (!permit.isGranted()) {
+        result.outcome = Outcome::Deferred;
+        return result;
+    }
+
+    QFile file(item.filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.outcome = Outcome::Unreadable;
+        result.error = file.errorString();
+        return result;
+    }
+
+    // Every byte is read once: keep it out of the page cache
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    PageCacheAdvisor advisor(file.handle());
+    while (true) {
+        if (stopFlag->loadRelaxed()) {
+            permit.setBytes(result.bytesRead);
+            result.outcome = Outcome::Canceled;
+            return result;
+        }
+
+        const QByteArray chunk = file.read(READ_CHUNK_SIZE);
+        if (chunk.isEmpty()) {
+            break;
+        }
+        hash.addData(chunk);
+        result.bytesRead += chunk.size();
+        advisor.advance(file.pos());
+    }
+    permit.setBytes(result.bytesRead);
+
+    if (file.error() != QFileDevice::NoError) {
+        result.outcome = Outcome::Unreadable;
+        result.error = file.errorString();
+    } else if (result.bytesRead != item.fileSize) {
+        result.outcome = Outcome::Unreadable;
+        result.error = QString("read %1 of %2 bytes").arg(result.bytesRead).arg(item.fileSize);
+    } else if (QString(hash.result().toHex()) == item.fileHash) {
+        result.outcome = Outcome::Verified;
+    } else {
+        // Different contents under a new date were written on purpose
+        result.outcome = result.dateModified == item.dateModified ? Outcome::Corrupted
+                                                                  : Outcome::Changed;
+    }
+    return result;
+}
+
+void IntegrityScrubber::fetchNextBatch()
+{
+    if (!m_projectManager->hasOpenProject()) {
+        halt();
+        return;
+    }
+
+    const QList<ProjectManager::ImageRecord> records =
+        m_projectManager->getImagesToVerifyAfter(m_fetchCursor, BATCH_SIZE);
+    if (records.size() < BATCH_SIZE) {
+        m_exhausted = true;
+    }
+
+    for (const ProjectManager::ImageRecord &record : records) {
+        m_fetchCursor = record.id;
+        if (record.fileHash.isEmpty()) {
+            continue;  // Never hashed; nothing to verify against
+        }
+
+        const QString volumeKey = volumeFor(record.filePath);
+        Volume &volume = m_volumes[volumeKey];
+        if (!volume.watcher) {
+            volume.watcher = new QFutureWatcher<Result>(this);
+            connect(volume.watcher, &QFutureWatcher<Result>::finished, this, [this, volumeKey]() {
+                onFileFinished(volumeKey);
+            });
+        }
+
+        volume.queue.append({record.id, record.filePath, record.fileHash,
+                             record.fileSize, record.dateModified});
+        m_pending.insert(record.id, false);
+        m_queuedCount++;
+    }
+}
+
+void IntegrityScrubber::onFileFinished(const QString &volumeKey)
+{
+    Volume &volume = m_volumes[volumeKey];
+    volume.busy = false;
+
+    // Results of a paused or earlier session are dropped; the cursor was
+    // saved before them, so those files are read again
+    const QFuture<Result> future = volume.watcher->future();
+    if (!m_running || volume.inFlightSession != m_session ||
+        future.isCanceled() || future.resultCount() == 0) {
+        if (m_running) {
+            scheduleNext(0);
+        }
+        return;
+    }
+
+    const Item item = volume.inFlight;
+    const Result result = future.result();
+    m_bytesRead += result.bytesRead;
+
+    switch (result.outcome) {
+    case Outcome::Deferred:
+        // Nothing was read: refund the budget and retry the file once the
+        // volume has a free slot
+        m_nextReadMs -= volume.inFlightChargeMs;
+        volume.queue.prepend(item);
+        m_queuedCount++;
+        scheduleNext(PERMIT_RETRY_MS);
+        return;
+    case Outcome::Canceled:
+        scheduleNext(0);
+        return;
+    case Outcome::Verified:
+        m_verifiedCount++;
+        if (result.dateModified != item.dateModified) {
+            // Touched or restored with the same contents: record the new date
+            // so sync does not re-hash it
+            m_projectManager->updateModifiedDates({{item.filePath, result.dateModified}});
+        }
+        if (m_knownCorrupted.remove(item.filePath)) {
+            qDebug() << "Integrity scrub: restored file verifies again:" << item.filePath;
+            m_projectManager->setFileCorrupted(item.filePath, false);
+        }
+        break;
+    case Outcome::Corrupted:
+    case Outcome::Unreadable: {
+        if (result.outcome == Outcome::Corrupted) {
+            m_verifiedCount++;
+        }
+        m_corruptedCount++;
+        const QString reason = result.outcome == Outcome::Corrupted
+                                   ? QString("contents no longer match the stored hash")
+                                   : result.error;
+        qWarning() << "Integrity scrub:" << item.filePath << "-" << reason;
+        m_knownCorrupted.insert(item.filePath);
+        m_projectManager->setFileCorrupted(item.filePath, true);
+        emit corruptionFound(item.filePath, reason);
+        break;
+    }
+    case Outcome::Changed:
+    case Outcome::Missing:
+        break;
+    }
+
+    completeRecord(item.id);
+    scheduleNext(0);
+}
+
+void IntegrityScrubber::completeRecord(int id)
+{
+    auto it = m_pending.find(id);
+    if (it == m_pending.end()) {
+        return;
+    }
+    it.value() = true;
+
+    // Volumes finish out of order; the cursor only passes records that are done
+    while (!m_pending.isEmpty() && m_pending.first()) {
+        m_cursor = m_pending.firstKey();
+        m_pending.erase(m_pending.begin());
+    }
+
+    m_doneCount++;
+    if (m_doneCount % CURSOR_SAVE_INTERVAL == 0) {
+        saveCursor();
+    }
+
+    if (m_doneCount % PROGRESS_UPDATE_INTERVAL == 0) {
+        emit scrubProgress(m_verifiedCount, m_bytesRead);
+    }
+}
+
+void IntegrityScrubber::finishPass()
+{
+    halt();
+    m_cursor = 0;
+    saveCursor();
+    m_projectManager->setProjectValue(ACTIVE_KEY, false);
+    m_projectManager->setProjectValue(LAST_PASS_KEY, QDateTime::currentDateTime());
+
+    qDebug() << "Integrity scrub finished:" << m_verifiedCount << "files verified,"
+             << m_corruptedCount << "corrupted," << m_bytesRead / BYTES_PER_MB << "MB read";
+    emit scrubFinished(m_verifiedCount, m_corruptedCount);
+}
+
+void IntegrityScrubber::halt()
+{
+    m_running = false;
+    m_stopFlag->storeRelaxed(1);
+    m_stepTimer->stop();
+    for (Volume &volume : m_volumes) {
+        volume.queue.clear();
+    }
+    m_pending.clear();
+    m_queuedCount = 0;
+}
+
+void IntegrityScrubber::saveCursor()
+{
+    if (m_projectManager && m_projectManager->hasOpenProject()) {
+        m_projectManager->setProjectValue(CURSOR_KEY, m_cursor);
+    }
+}
+
+QString IntegrityScrubber::volumeFor(const QString &filePath)
+{
+    const QString directory = QFileInfo(filePath).absolutePath();
+    auto it = m_directoryVolumes.constFind(directory);
+    if (it != m_directoryVolumes.constEnd()) {
+        return it.value();
+    }
+
+    const QString volume = IoConcurrencyController::instance()->volumeFor(filePath);
+    m_directoryVolumes.insert(directory, volume);
+    return volume;
+}
+
+void IntegrityScrubber::scheduleNext(int delayMs)
+{
+    m_stepTimer->start(delayMs);
+}
+
+bool IntegrityScrubber::isUserIdle() const
+{
+    return m_lastInteraction.elapsed() >= USER_IDLE_MS;
+}
+
+int IntegrityScrubber::inFlightCount() const
+{
+    int count = 0;
+    for (const Volume &volume : m_volumes) {
+        count += volume.busy ? 1 : 0;
+    }
+    return count;
+}
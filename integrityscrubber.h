@@ -0,0 +1,288 @@
+#ifndef INTEGRITYSCRUBBER_H
+#define INTEGRITYSCRUBBER_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <memory>
+
+class QTimer;
+class ProjectManager;
+
+/**
+ * @brief Background verification of every catalog file against its stored hash
+ *
+ * Sync only re-hashes files whose size or modification date changed, so
+ * silent corruption (bit rot, bad sectors) would never be noticed. The
+ * scrubber re-reads the whole library and compares each file with the
+ * full-file hash stored at import:
+ * - Files are read as Background tasks on the TaskScheduler, one in flight
+ *   per volume, so several disks are scrubbed in parallel
+ * - A global MB/s budget spaces the reads out; pages are dropped behind
+ *   the read so the page cache is left alone
+ * - Pauses while the user interacts with the application
+ * - Resumes from a cursor persisted in the project catalog, so a pass can
+ *   span several sessions
+ *
+ * Files whose contents no longer match while size and modification date
+ * still do are marked "corrupted" in the catalog, as are files that fail
+ * with a read error. A file with a new date but the same size (touched,
+ * restored from a backup) is verified too: if it matches, its date is
+ * updated and a corrupted mark is cleared. Files changed on purpose are
+ * left to sync.
+ */
+class IntegrityScrubber : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IntegrityScrubber(ProjectManager *projectManager, QObject *parent = nullptr);
+    ~IntegrityScrubber();
+
+    // === Control ===
+
+    /**
+     * @brief Start a pass, or resume the interrupted one from the persisted cursor
+     */
+    void start();
+
+    /**
+     * @brief Resume a pass that was running when the last session ended
+     */
+    void resumePendingPass();
+
+    /**
+     * @brief Pause the pass and persist the cursor
+     *
+     * The pass is not resumed automatically afterwards; start() continues it.
+     */
+    void pause();
+
+    /**
+     * @brief Stop for this session and persist the cursor
+     *
+     * Used when the project closes; an active pass resumes when the project
+     * is opened again (see resumePendingPass()).
+     */
+    void stop();
+
+    /**
+     * @brief Set the read budget shared by all volumes
+     * @param megabytesPerSecond Maximum average read rate (persisted per project)
+     */
+    void setRateLimit(int megabytesPerSecond);
+
+    // === Information ===
+
+    /**
+     * @brief Get the read budget
+     * @return Maximum average read rate in MB/s
+     */
+    int rateLimit() const;
+
+    /**
+     * @brief Check if a pass is active
+     * @return True if scrubbing is in progress (possibly paused for input)
+     */
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief Get the number of files verified in the current session
+     * @return Number of files read and compared
+     */
+    int verifiedCount() const { return m_verifiedCount; }
+
+    /**
+     * @brief Get the end of the last complete pass
+     * @return Completion time, invalid if no pass has completed
+     */
+    QDateTime lastCompletedPass() const;
+
+signals:
+    /**
+     * @brief Emitted periodically while scrubbing
+     * @param verified Files verified in the current session
+     * @param bytesRead Bytes read in the current session
+     */
+    void scrubProgress(int verified, qint64 bytesRead);
+
+    /**
+     * @brief Emitted for every file found corrupted or unreadable
+     * @param filePath File path
+     * @param reason Mismatching hash or read error
+     */
+    void corruptionFound(const QString &filePath, const QString &reason);
+
+    /**
+     * @brief Emitted when a pass has covered the whole catalog
+     * @param verified Files verified in the current session
+     * @param corrupted Files marked corrupted in the current session
+     */
+    void scrubFinished(int verified, int corrupted);
+
+protected:
+    /**
+     * @brief Track user input to pause scrubbing during interaction
+     * @param watched Object receiving the event
+     * @param event Event being delivered
+     * @return Always false (events are never consumed)
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    /**
+     * @brief Dispatch files to idle volumes within the read budget
+     */
+    void processNext();
+
+private:
+    /**
+     * @brief Result of verifying one file
+     */
+    enum class Outcome {
+        Verified,                    ///< Contents match the stored hash
+        Corrupted,                   ///< Same size and date, different contents
+        Unreadable,                  ///< Read error or short read
+        Changed,                     ///< Modified since the last sync; left to sync
+        Missing,                     ///< Gone since the last sync; left to sync
+        Deferred,                    ///< Volume at its I/O limit; nothing was read
+        Canceled                     ///< Pass stopped during the read
+    };
+
+    /**
+     * @brief Catalog row to verify
+     */
+    struct Item {
+        int id = 0;                  ///< Record ID
+        QString filePath;            ///< File path
+        QString fileHash;            ///< Stored full-file hash
+        qint64 fileSize = 0;         ///< Stored size
+        QDateTime dateModified;      ///< Stored modification date
+    };
+
+    /**
+     * @brief Verification result handed back to the GUI thread
+     */
+    struct Result {
+        Outcome outcome = Outcome::Missing; ///< What was found
+        qint64 bytesRead = 0;        ///< Bytes read
+        QDateTime dateModified;      ///< Modification date on disk
+        QString error;               ///< Read error (Unreadable only)
+    };
+
+    /**
+     * @brief Per-volume queue; one file in flight per volume
+     */
+    struct Volume {
+        QList<Item> queue;           ///< Files waiting on this volume
+        QFutureWatcher<Result> *watcher = nullptr; ///< Watches the in-flight file
+        Item inFlight;               ///< File being read
+        int inFlightSession = 0;     ///< Session the in-flight file was started in
+        qint64 inFlightChargeMs = 0; ///< Read budget charged for the in-flight file
+        bool busy = false;           ///< True while a file is in flight
+    };
+
+    /**
+     * @brief Read a file and compare it with its stored hash (worker thread)
+     * @param item Catalog row
+     * @param stopFlag Set when the pass stops; checked between chunks
+     * @return Verification result
+     */
+    static Result verifyFile(const Item &item, const std::shared_ptr<QAtomicInt> &stopFlag);
+
+    /**
+     * @brief Load rows after the fetch cursor into the volume queues
+     */
+    void fetchNextBatch();
+
+    /**
+     * @brief Handle completion of a volume's in-flight file
+     * @param volumeKey Volume the file was read from
+     */
+    void onFileFinished(const QString &volumeKey);
+
+    /**
+     * @brief Mark a record done and advance the cursor past completed records
+     * @param id Record ID
+     */
+    void completeRecord(int id);
+
+    /**
+     * @brief Finish the pass once every record is done
+     */
+    void finishPass();
+
+    /**
+     * @brief Stop dispatching and drop the queued files
+     */
+    void halt();
+
+    /**
+     * @brief Persist the cursor in the project catalog
+     */
+    void saveCursor();
+
+    /**
+     * @brief Get the volume a file is read from
+     * @param filePath File path
+     * @return Volume key, looked up once per directory
+     */
+    QString volumeFor(const QString &filePath);
+
+    /**
+     * @brief Schedule the next dispatch step
+     * @param delayMs Delay before the step
+     */
+    void scheduleNext(int delayMs);
+
+    /**
+     * @brief Check if the user has been idle long enough
+     * @return True if no recent input was seen
+     */
+    bool isUserIdle() const;
+
+    /**
+     * @brief Count the files in flight on all volumes
+     * @return Files being read
+     */
+    int inFlightCount() const;
+
+    // === Services ===
+
+    ProjectManager *m_projectManager;       ///< Catalog access
+
+    // === Scheduling ===
+
+    QHash<QString, Volume> m_volumes;       ///< Volume key -> queue and worker
+    QHash<QString, QString> m_directoryVolumes; ///< Directory -> volume key
+    QTimer *m_stepTimer;                    ///< Drives dispatch steps
+    QElapsedTimer m_clock;                  ///< Time base of the read budget
+    qint64 m_nextReadMs;                    ///< Earliest start of the next read on m_clock
+    QElapsedTimer m_lastInteraction;        ///< Time since last user input
+
+    // === State ===
+
+    QMap<int, bool> m_pending;              ///< Fetched record ID -> done, in ID order
+    QSet<QString> m_knownCorrupted;         ///< Files marked corrupted before this session
+    int m_cursor;                           ///< Every record up to this ID is done
+    int m_fetchCursor;                      ///< Last record ID fetched
+    bool m_exhausted;                       ///< No rows left after m_fetchCursor
+    int m_queuedCount;                      ///< Files waiting in volume queues
+    int m_doneCount;                        ///< Records completed in this session
+    int m_session;                          ///< Bumped by start() to drop stale results
+    std::shared_ptr<QAtomicInt> m_stopFlag; ///< Cancels the reads of the current session
+    int m_verifiedCount;                    ///< Files verified in this session
+    int m_corruptedCount;                   ///< Files marked corrupted in this session
+    qint64 m_bytesRead;                     ///< Bytes read in this session
+    int m_rateLimit;                        ///< Read budget in MB/s
+    bool m_running;                         ///< True while a pass is active
+};
+
+#endif // INTEGRITYSCRUBBER_H
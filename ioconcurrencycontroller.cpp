@@ -0,0 +1,254 @@
+#include "ioconcurrencycontroller.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStorageInfo>
+#include <QStringList>
+#include <QDebug>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <sys/stat.h>
+#endif
+
+// === Constants ===
+namespace {
+constexpr int MIN_CONCURRENCY = 1;
+constexpr int LOCAL_INITIAL_CONCURRENCY = 32;
+constexpr int LOCAL_MAX_CONCURRENCY = 256;
+constexpr int NETWORK_INITIAL_CONCURRENCY = 4;   // Start gently on shared servers
+constexpr int NETWORK_MAX_CONCURRENCY = 64;
+
+constexpr int WINDOW_MIN_OPS = 32;               // Completions per evaluation window
+constexpr qint64 WINDOW_MIN_NS = 200 * 1000 * 1000;
+
+constexpr double INCREASE_STEP = 1.0;
+constexpr double DECREASE_FACTOR = 0.7;
+constexpr double LATENCY_CONGESTION_FACTOR = 2.0; // Latency over baseline that signals overload
+constexpr double THROUGHPUT_DROP_FACTOR = 0.9;
+constexpr double BASELINE_DRIFT = 1.02;          // Lets the baseline follow a slower server
+
+const QStringList NETWORK_FILESYSTEMS = {
+    "nfs", "nfs4", "cifs", "smb3", "smbfs", "9p", "afs", "ceph", "glusterfs",
+    "fuse.sshfs", "fuse.rclone", "fuse.glusterfs", "webdav", "davfs"
+};
+}
+
+// === Permit ===
+
+IoConcurrencyController::Permit::Permit(const QString &filePath)
+    : m_volume(IoConcurrencyController::instance()->volumeFor(filePath))
+    , m_bytes(0)
+    , m_granted(IoConcurrencyController::instance()->tryAcquire(m_volume))
+{
+    m_timer.start();
+}
+
+IoConcurrencyController::Permit::~Permit()
+{
+    if (m_granted) {
+        IoConcurrencyController::instance()->release(m_volume, m_bytes, m_timer.nsecsElapsed());
+    }
+}
+
+// === Constructor & Destructor ===
+
+IoConcurrencyController *IoConcurrencyController::instance()
+{
+    static IoConcurrencyController controller;
+    return &controller;
+}
+
+IoConcurrencyController::IoConcurrencyController()
+{
+}
+
+IoConcurrencyController::~IoConcurrencyController()
+{
+    qDeleteAll(m_volumes);
+}
+
+// === Volumes ===
+
+QString IoConcurrencyController::volumeFor(const QString &filePath)
+{
+    const QString directory = QFileInfo(filePath).absolutePath();
+
+    // Resolving a mount point parses the mount table; cache it per device
+#ifdef Q_OS_LINUX
+    struct stat fileStat;
+    const bool haveDevice = stat(QFile::encodeName(directory).constData(), &fileStat) == 0;
+    const quint64 device = haveDevice ? quint64(fileStat.st_dev) : 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (haveDevice && m_deviceVolumes.contains(device)) {
+            return m_deviceVolumes.value(device);
+        }
+    }
+#else
+    {
+        QMutexLocker locker(&m_mutex);
+        const auto cached = m_directoryVolumes.constFind(directory);
+        if (cached != m_directoryVolumes.constEnd()) {
+            return cached.value();
+        }
+    }
+#endif
+
+    const QStorageInfo storage(directory);
+    const QString rootPath = storage.isValid() ? storage.rootPath() : directory;
+
+    QMutexLocker locker(&m_mutex);
+#ifdef Q_OS_LINUX
+    if (haveDevice) {
+        m_deviceVolumes.insert(device, rootPath);
+    }
+#else
+    m_directoryVolumes.insert(directory, rootPath);
+#endif
+
+    if (!m_volumeInfo.contains(rootPath)) {
+        VolumeInfo info;
+        info.fileSystemType = QString::fromUtf8(storage.fileSystemType());
+        info.network = NETWORK_FILESYSTEMS.contains(info.fileSystemType);
+        m_volumeInfo.insert(rootPath, info);
+
+        qDebug() << "I/O volume" << rootPath << info.fileSystemType
+                 << (info.network ? "(network)" : "(local)");
+    }
+
+    return rootPath;
+}
+
+int IoConcurrencyController::concurrency(const QString &volume, Channel channel)
+{
+    QMutexLocker locker(&m_mutex);
+    return qMax(MIN_CONCURRENCY, int(volumeState(volume, channel).limit));
+}
+
+// === Feedback ===
+
+void IoConcurrencyController::recordCompletion(const QString &volume, Channel channel,
+                                               qint64 bytes, qint64 latencyNs, int inFlight)
+{
+    QMutexLocker locker(&m_mutex);
+    Volume &state = volumeState(volume, channel);
+
+    if (!state.window.isValid()) {
+        state.window.start();
+    }
+
+    state.windowBytes += bytes;
+    state.windowLatencyNs += latencyNs;
+    state.windowOps++;
+    state.windowPeakInFlight = qMax(state.windowPeakInFlight, inFlight);
+    state.stats.totalBytes += bytes;
+
+    evaluateWindow(state);
+}
+
+// === Statistics ===
+
+QList<IoConcurrencyController::VolumeStats> IoConcurrencyController::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QList<VolumeStats> result;
+    for (const Volume *volume : m_volumes) {
+        result.append(volume->stats);
+    }
+
+    std::sort(result.begin(), result.end(), [](const VolumeStats &a, const VolumeStats &b) {
+        if (a.rootPath != b.rootPath) {
+            return a.rootPath < b.rootPath;
+        }
+        return a.channel < b.channel;
+    });
+    return result;
+}
+
+// === Private Methods ===
+
+IoConcurrencyController::Volume &IoConcurrencyController::volumeState(const QString &volume,
+                                                                      Channel channel)
+{
+    Volume *&state = m_volumes[qMakePair(volume, static_cast<int>(channel))];
+    if (!state) {
+        const VolumeInfo info = m_volumeInfo.value(volume);
+
+        state = new Volume;
+        state->limit = info.network ? NETWORK_INITIAL_CONCURRENCY : LOCAL_INITIAL_CONCURRENCY;
+        state->maxLimit = info.network ? NETWORK_MAX_CONCURRENCY : LOCAL_MAX_CONCURRENCY;
+        state->stats.rootPath = volume;
+        state->stats.channel = channel;
+        state->stats.fileSystemType = info.fileSystemType;
+        state->stats.network = info.network;
+        state->stats.concurrency = int(state->limit);
+    }
+    return *state;
+}
+
+void IoConcurrencyController::evaluateWindow(Volume &volume)
+{
+    const qint64 elapsedNs = volume.window.nsecsElapsed();
+    if (volume.windowOps < WINDOW_MIN_OPS || elapsedNs < WINDOW_MIN_NS) {
+        return;
+    }
+
+    const double throughput = double(volume.windowBytes) * 1e9 / double(elapsedNs);
+    const double latency = double(volume.windowLatencyNs) / volume.windowOps;
+    const bool limitBound = volume.windowPeakInFlight >= int(volume.limit);
+
+    // The baseline tracks the best latency seen, drifting up slowly so a
+    // server that got permanently slower does not look congested forever
+    if (volume.baselineLatencyNs <= 0 || latency < volume.baselineLatencyNs) {
+        volume.baselineLatencyNs = latency;
+    } else {
+        volume.baselineLatencyNs *= BASELINE_DRIFT;
+    }
+
+    const bool latencyCongested = latency > volume.baselineLatencyNs * LATENCY_CONGESTION_FACTOR;
+    const bool throughputDropped = limitBound && volume.lastThroughput > 0 &&
+                                   throughput < volume.lastThroughput * THROUGHPUT_DROP_FACTOR;
+
+    if (latencyCongested || throughputDropped) {
+        volume.limit = qMax<double>(MIN_CONCURRENCY, volume.limit * DECREASE_FACTOR);
+    } else if (limitBound) {
+        volume.limit = qMin<double>(volume.maxLimit, volume.limit + INCREASE_STEP);
+    }
+
+    volume.stats.concurrency = qMax(MIN_CONCURRENCY, int(volume.limit));
+    volume.stats.throughputMBps = throughput / (1024.0 * 1024.0);
+    volume.stats.latencyMs = latency / 1e6;
+    volume.lastThroughput = throughput;
+
+    volume.window.restart();
+    volume.windowBytes = 0;
+    volume.windowLatencyNs = 0;
+    volume.windowOps = 0;
+    volume.windowPeakInFlight = 0;
+}
+
+bool IoConcurrencyController::tryAcquire(const QString &volume)
+{
+    QMutexLocker locker(&m_mutex);
+    Volume &state = volumeState(volume, Channel::Files);
+
+    if (state.inFlight >= qMax(MIN_CONCURRENCY, int(state.limit))) {
+        return false;
+    }
+    state.inFlight++;
+    return true;
+}
+
+void IoConcurrencyController::release(const QString &volume, qint64 bytes, qint64 latencyNs)
+{
+    QMutexLocker locker(&m_mutex);
+    Volume &state = volumeState(volume, Channel::Files);
+
+    const int inFlight = state.inFlight;
+    state.inFlight--;
+    locker.unlock();
+
+    recordCompletion(volume, Channel::Files, bytes, latencyNs, inFlight);
+}
@@ -0,0 +1,205 @@
+#ifndef IOCONCURRENCYCONTROLLER_H
+#define IOCONCURRENCYCONTROLLER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+/**
+ * @brief Finds the I/O parallelism each volume handles best
+ *
+ * Local SSDs want deep queues while NFS/SMB servers slow down for everyone
+ * when flooded, so no single thread count suits a library spread over
+ * several mounts. The controller keeps one concurrency limit per mount
+ * point and tunes it with AIMD (additive increase, multiplicative
+ * decrease) from the completions it is told about:
+ * - every window of completions yields a throughput and a mean latency
+ * - latency well above the volume's baseline, or throughput falling while
+ *   the limit was fully used, is congestion: the limit shrinks by 30%
+ * - otherwise, if the window actually used the whole limit, it grows by one
+ *
+ * Batched chunk reads and whole-file work (Permit) are tuned as separate
+ * channels of a volume, since their request sizes and latencies differ by
+ * orders of magnitude. Batched readers ask for the current limit per
+ * batch; per-file work holds a Permit. A Permit never blocks: when the
+ * channel is at its limit it is not granted, and the caller requeues the
+ * work instead of tying up a worker thread. Thread-safe.
+ */
+class IoConcurrencyController
+{
+public:
+    /**
+     * @brief Kind of I/O a limit applies to
+     */
+    enum class Channel {
+        Chunks,                      ///< Batched fixed-size reads (BatchFileReader)
+        Files                        ///< One whole file per request (Permit)
+    };
+
+    /**
+     * @brief Current state of one volume channel
+     */
+    struct VolumeStats {
+        QString rootPath;            ///< Mount point
+        Channel channel = Channel::Chunks; ///< Channel the values apply to
+        QString fileSystemType;      ///< Filesystem type ("ext4", "nfs4", ...)
+        bool network = false;        ///< True for network filesystems
+        int concurrency = 0;         ///< Current limit
+        double throughputMBps = 0;   ///< Throughput of the last window
+        double latencyMs = 0;        ///< Mean latency of the last window
+        qint64 totalBytes = 0;       ///< Bytes completed since start
+    };
+
+    /**
+     * @brief Scoped slot on a volume for one unit of file I/O
+     *
+     * Granted only if the volume is below its limit; on destruction a
+     * granted permit feeds the elapsed time and the reported bytes to the
+     * controller.
+     */
+    class Permit
+    {
+    public:
+        explicit Permit(const QString &filePath);
+        ~Permit();
+
+        Permit(const Permit &) = delete;
+        Permit &operator=(const Permit &) = delete;
+
+        /**
+         * @brief Check if a slot was taken
+         * @return True if the work may proceed, false if it must be requeued
+         */
+        bool isGranted() const { return m_granted; }
+
+        /**
+         * @brief Set the number of bytes this unit of work read
+         * @param bytes Bytes read
+         */
+        void setBytes(qint64 bytes) { m_bytes = bytes; }
+
+    private:
+        QString m_volume;            ///< Volume the slot was taken on
+        qint64 m_bytes;              ///< Bytes read under the permit
+        QElapsedTimer m_timer;       ///< Started once the slot was granted
+        bool m_granted;              ///< True if a slot was taken
+    };
+
+    /**
+     * @brief Get the controller instance
+     * @return Process-wide controller
+     */
+    static IoConcurrencyController *instance();
+
+    // === Volumes ===
+
+    /**
+     * @brief Get the volume a file lives on
+     * @param filePath File path
+     * @return Mount point used as the volume key
+     */
+    QString volumeFor(const QString &filePath);
+
+    /**
+     * @brief Get the current concurrency limit of a volume channel
+     * @param volume Volume key from volumeFor()
+     * @param channel I/O channel
+     * @return Number of requests to keep in flight
+     */
+    int concurrency(const QString &volume, Channel channel);
+
+    // === Feedback ===
+
+    /**
+     * @brief Report a completed request
+     * @param volume Volume key from volumeFor()
+     * @param channel I/O channel
+     * @param bytes Bytes transferred
+     * @param latencyNs Time from issue to completion
+     * @param inFlight Requests in flight on the channel when it was issued
+     */
+    void recordCompletion(const QString &volume, Channel channel, qint64 bytes,
+                          qint64 latencyNs, int inFlight);
+
+    // === Statistics ===
+
+    /**
+     * @brief Get the state of every volume channel used so far
+     * @return Volume statistics, sorted by mount point and channel
+     */
+    QList<VolumeStats> statistics() const;
+
+private:
+    /**
+     * @brief Mount information of a volume
+     */
+    struct VolumeInfo {
+        QString fileSystemType;      ///< Filesystem type
+        bool network = false;        ///< True for network filesystems
+    };
+
+    /**
+     * @brief Controller state of one volume channel
+     */
+    struct Volume {
+        VolumeStats stats;           ///< Exposed state
+        double limit = 1;            ///< Concurrency limit (fractional for AIMD)
+        int maxLimit = 1;            ///< Upper bound of the limit
+        int inFlight = 0;            ///< Permits currently held
+
+        QElapsedTimer window;        ///< Start of the current window
+        qint64 windowBytes = 0;      ///< Bytes completed in the window
+        qint64 windowLatencyNs = 0;  ///< Sum of latencies in the window
+        int windowOps = 0;           ///< Completions in the window
+        int windowPeakInFlight = 0;  ///< Highest concurrency seen in the window
+
+        double baselineLatencyNs = 0; ///< Latency of an uncongested volume
+        double lastThroughput = 0;   ///< Throughput of the previous window
+    };
+
+    IoConcurrencyController();
+    ~IoConcurrencyController();
+
+    IoConcurrencyController(const IoConcurrencyController &) = delete;
+    IoConcurrencyController &operator=(const IoConcurrencyController &) = delete;
+
+    /**
+     * @brief Find or create the state of a volume channel (caller holds the lock)
+     * @param volume Volume key
+     * @param channel I/O channel
+     * @return Channel state
+     */
+    Volume &volumeState(const QString &volume, Channel channel);
+
+    /**
+     * @brief Close the current window and adjust the limit (caller holds the lock)
+     * @param volume Volume state
+     */
+    void evaluateWindow(Volume &volume);
+
+    /**
+     * @brief Take a permit slot if the volume is below its limit
+     * @param volume Volume key
+     * @return True if a slot was taken
+     */
+    bool tryAcquire(const QString &volume);
+
+    /**
+     * @brief Return a permit slot and record its completion
+     * @param volume Volume key
+     * @param bytes Bytes read under the permit
+     * @param latencyNs Time the permit was held
+     */
+    void release(const QString &volume, qint64 bytes, qint64 latencyNs);
+
+    mutable QMutex m_mutex;                   ///< Guards all state
+    QHash<QString, VolumeInfo> m_volumeInfo;  ///< Mount point -> mount information
+    QHash<QPair<QString, int>, Volume *> m_volumes; ///< (Mount point, channel) -> state
+    QHash<quint64, QString> m_deviceVolumes;  ///< Device number -> mount point (cached)
+    QHash<QString, QString> m_directoryVolumes; ///< Directory -> mount point (non-Linux cache)
+};
+
+#endif // IOCONCURRENCYCONTROLLER_H
@@ -4,8 +4,14 @@
 #include "zoomableimagelabel.h"
 #include "projectmanager.h"
 #include "syncdialog.h"
+#include "asyncprojectmanager.h"
 #include "duplicatedialog.h"
 #include "thumbnailservice.h"
+#include "thumbnailwarmer.h"
+#include "integrityscrubber.h"
+#include "taskscheduler.h"
+#include "ioconcurrencycontroller.h"
+#include "spacereclaimer.h"
 #include <QApplication>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -27,6 +33,16 @@
 #include <QInputDialog>
 #include <QLineEdit>
 
+namespace {
+// Thumbnail warming competes with restoring the grid; start it once the window settled
+constexpr int WARMER_START_DELAY_MS = 1000;
+
+// The integrity scrub reads whole files; let the warmer and the grid go first
+constexpr int SCRUB_RESUME_DELAY_MS = 30000;
+constexpr int MAX_SCRUB_RATE_MBPS = 2000;
+constexpr int MAX_LISTED_CORRUPTED = 10;
+}
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , welcomeWidget(nullptr)
@@ -34,6 +50,11 @@ MainWindow::MainWindow(QWidget *parent)
     // Create services
     thumbnailService = new ThumbnailService(this);
     projectManager = new ProjectManager(this);
+    projectManager->setThumbnailService(thumbnailService);
+    asyncProjectManager = new AsyncProjectManager(projectManager, this);
+    asyncProjectManager->setThumbnailService(thumbnailService);
+    thumbnailWarmer = new ThumbnailWarmer(thumbnailService, projectManager, this);
+    integrityScrubber = new IntegrityScrubber(projectManager, this);
 
     setupUI();
     connectSignals();
@@ -51,6 +72,23 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // Join the catalog thread first: a running sync feeds the thumbnail service
+    delete asyncProjectManager;
+    asyncProjectManager = nullptr;
+
+    // Stop and join the warmer before the thumbnail service it uses is destroyed
+    thumbnailWarmer->stop();
+    delete thumbnailWarmer;
+    thumbnailWarmer = nullptr;
+
+    // Persist the scrub cursor while the catalog is still open
+    integrityScrubber->stop();
+    delete integrityScrubber;
+    integrityScrubber = nullptr;
+
+    // Drop queued work and join running tasks while the services still exist
+    TaskScheduler::instance()->shutdown();
+
     saveSettings();
 }
 
@@ -84,6 +122,7 @@ void MainWindow::createMenuBar()
     projectMenu->addAction("&Synchronize...", QKeySequence::Refresh, this, &MainWindow::synchronizeProject);
     projectMenu->addSeparator();
     projectMenu->addAction("&Analyze Duplicates...", QKeySequence("Ctrl+D"), this, &MainWindow::analyzeDuplicates);
+    projectMenu->addAction("&Verify Integrity...", this, &MainWindow::verifyIntegrity);
     projectMenu->addSeparator();
     projectMenu->addAction("&Project Info", this, &MainWindow::showProjectInfo);
 
@@ -181,6 +220,22 @@ void MainWindow::connectSignals()
     connect(projectManager, &ProjectManager::projectOpened, this, &MainWindow::onProjectOpened);
     connect(projectManager, &ProjectManager::projectClosed, this, &MainWindow::onProjectClosed);
 
+    // Pre-generate thumbnails for imported/modified files once sync is done
+    connect(projectManager, &ProjectManager::syncCompleted, thumbnailWarmer, &ThumbnailWarmer::start);
+    connect(asyncProjectManager, &AsyncProjectManager::syncCompleted, thumbnailWarmer, &ThumbnailWarmer::start);
+
+    // Integrity scrub reports
+    connect(integrityScrubber, &IntegrityScrubber::scrubProgress, this, [this](int verified, qint64 bytesRead) {
+        updateStatus(QString("Verifying integrity: %1 files, %2 MB read")
+                         .arg(verified)
+                         .arg(bytesRead / (1024 * 1024)));
+    });
+    connect(integrityScrubber, &IntegrityScrubber::corruptionFound, this,
+            [this](const QString &filePath, const QString &reason) {
+        updateStatus(QString("Corrupted file: %1 (%2)").arg(QFileInfo(filePath).fileName(), reason));
+    });
+    connect(integrityScrubber, &IntegrityScrubber::scrubFinished, this, &MainWindow::onIntegrityScrubFinished);
+
     // FolderManager signals
     connect(folderManager, &FolderManager::folderSelected, this, &MainWindow::onFolderSelected);
     connect(folderManager, &FolderManager::folderAdded, this, &MainWindow::onFolderAdded);
@@ -235,13 +290,18 @@ void MainWindow::openProject()
 
 void MainWindow::openProject(const QString &projectPath)
 {
-    if (projectManager->openProject(projectPath)) {
-        hideWelcomeScreen();
-        updateStatus("Opened project: " + projectManager->currentProjectName());
-    } else {
-        QMessageBox::warning(this, "Error",
-                             "Failed to open project. Please ensure the folder contains a valid PhotoManager project.");
-    }
+    updateStatus("Opening project...");
+    integrityScrubber->stop();
+
+    asyncProjectManager->openProject(projectPath).then(this, [this](bool opened) {
+        if (opened) {
+            hideWelcomeScreen();
+            updateStatus("Opened project: " + projectManager->currentProjectName());
+        } else {
+            QMessageBox::warning(this, "Error",
+                                 "Failed to open project. Please ensure the folder contains a valid PhotoManager project.");
+        }
+    });
 }
 
 void MainWindow::closeProject()
@@ -254,6 +314,8 @@ void MainWindow::closeProject()
         return;
     }
 
+    thumbnailWarmer->stop();
+    integrityScrubber->stop();
     projectManager->closeProject();
     showWelcomeScreen();
 }
@@ -265,7 +327,7 @@ void MainWindow::synchronizeProject()
         return;
     }
 
-    SyncDialog dialog(projectManager, this);
+    SyncDialog dialog(asyncProjectManager, this);
     dialog.exec();
 }
 
@@ -292,7 +354,7 @@ void MainWindow::analyzeDuplicates()
     updateStatus("Opening duplicate analysis...");
 
     // Create and show the duplicate analysis dialog
-    DuplicateDialog *dialog = new DuplicateDialog(projectManager, folderManager, this);
+    DuplicateDialog *dialog = new DuplicateDialog(projectManager, asyncProjectManager, folderManager, this);
 
     // Connect the show folder signal to our handler
     connect(dialog, &DuplicateDialog::showFolderInTree,
@@ -307,6 +369,45 @@ void MainWindow::analyzeDuplicates()
     updateStatus("Duplicate analysis completed");
 }
 
+void MainWindow::verifyIntegrity()
+{
+    if (!projectManager->hasOpenProject()) {
+        QMessageBox::information(this, "No Project", "Please open a project first.");
+        return;
+    }
+
+    if (integrityScrubber->isRunning()) {
+        const QMessageBox::StandardButton result = QMessageBox::question(
+            this, "Verify Integrity",
+            QString("Integrity verification is running (%1 files verified this session).\n\n"
+                    "Pause it? Starting it again continues where it stopped.")
+                .arg(integrityScrubber->verifiedCount()),
+            QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+        if (result == QMessageBox::Yes) {
+            integrityScrubber->pause();
+            updateStatus("Integrity verification paused");
+        }
+        return;
+    }
+
+    const QDateTime lastPass = integrityScrubber->lastCompletedPass();
+    bool ok;
+    const int rate = QInputDialog::getInt(this, "Verify Integrity",
+                                          QString("Re-read every catalog file and compare it with the hash stored at import.\n"
+                                                  "Runs in the background while you are idle and continues across sessions.\n\n"
+                                                  "Last complete pass: %1\n\n"
+                                                  "Maximum read rate (MB/s):")
+                                              .arg(lastPass.isValid() ? lastPass.toString("yyyy-MM-dd hh:mm") : "never"),
+                                          integrityScrubber->rateLimit(), 1, MAX_SCRUB_RATE_MBPS, 1, &ok);
+    if (!ok) {
+        return;
+    }
+
+    integrityScrubber->setRateLimit(rate);
+    integrityScrubber->start();
+    updateStatus(QString("Integrity verification started at up to %1 MB/s").arg(rate));
+}
+
 void MainWindow::showProjectInfo()
 {
     if (projectManager && projectManager->hasOpenProject()) {
@@ -314,13 +415,32 @@ void MainWindow::showProjectInfo()
                                "Location: %2\n"
                                "Total Images: %3\n"
                                "Missing Files: %4\n"
-                               "Folders: %5")
+                               "Corrupted Files: %5\n"
+                               "Folders: %6")
                            .arg(projectManager->currentProjectName())
                            .arg(projectManager->currentProjectPath())
                            .arg(projectManager->getTotalImageCount())
                            .arg(projectManager->getMissingFileCount())
+                           .arg(projectManager->getCorruptedFiles().size())
                            .arg(projectManager->getProjectFolders().size());
 
+        // Concurrency the adaptive I/O controller settled on per volume
+        const QList<IoConcurrencyController::VolumeStats> volumes =
+            IoConcurrencyController::instance()->statistics();
+        if (!volumes.isEmpty()) {
+            info += "\n\nI/O Concurrency:";
+        }
+        for (const IoConcurrencyController::VolumeStats &volume : volumes) {
+            const bool chunks = volume.channel == IoConcurrencyController::Channel::Chunks;
+            info += QString("\n%1 (%2, %3): %4 in flight, %5 MB/s, %6 ms")
+                        .arg(volume.rootPath)
+                        .arg(volume.fileSystemType)
+                        .arg(chunks ? "reads" : "files")
+                        .arg(volume.concurrency)
+                        .arg(volume.throughputMBps, 0, 'f', 1)
+                        .arg(volume.latencyMs, 0, 'f', 2);
+        }
+
         QMessageBox::information(this, "Project Information", info);
     } else {
         QMessageBox::information(this, "No Project",
@@ -432,17 +552,67 @@ void MainWindow::enableProjectActions(bool enabled)
 
 void MainWindow::onProjectOpened(const QString &projectName)
 {
-    // Load project folders into folder manager
-    QStringList projectFolders = projectManager->getProjectFolders();
+    // Restore the folder tree from the catalog; folders are validated in the background
+    const QStringList projectFolders = projectManager->getProjectFolders();
     folderManager->clearAllFolders();
-
-    for (const QString &folder : projectFolders) {
-        folderManager->addFolder(folder);
-    }
+    folderManager->restoreFolders(projectFolders);
 
     updateWindowTitle();
     enableProjectActions(true);
     updateStatus("Project opened: " + projectName);
+
+    restoreLastFolder();
+
+    // Clean up after a space reclamation that was interrupted by a crash;
+    // done here, before the duplicate dialog can start a new one. Without a
+    // journal this is a single failed open.
+    SpaceReclaimer(projectManager->currentProjectPath()).recoverJournal();
+
+    // Resume warming wherever the previous session left off
+    QTimer::singleShot(WARMER_START_DELAY_MS, thumbnailWarmer, &ThumbnailWarmer::start);
+
+    // Continue an integrity pass that was running when the last session ended
+    QTimer::singleShot(SCRUB_RESUME_DELAY_MS, integrityScrubber, &IntegrityScrubber::resumePendingPass);
+}
+
+void MainWindow::restoreLastFolder()
+{
+    const QString lastFolder = settings ? settings->value("lastFolder").toString() : QString();
+    if (lastFolder.isEmpty()) {
+        return;
+    }
+
+    // Only folders of this project; a string check, the filesystem is not touched
+    bool inProject = false;
+    for (const QString &root : folderManager->getAllFolderPaths()) {
+        if (lastFolder == root || lastFolder.startsWith(root + "/")) {
+            inProject = true;
+            break;
+        }
+    }
+    if (!inProject) {
+        return;
+    }
+
+    // The catalog knows the folder's images; cached thumbnails show without a directory scan
+    asyncProjectManager->getImagesInFolder(lastFolder).then(this,
+        [this, lastFolder](const QList<ProjectManager::ImageRecord> &records) {
+        if (!projectManager->hasOpenProject() || !imageGrid->currentFolder().isEmpty()) {
+            return; // Closed meanwhile, or the user already picked a folder
+        }
+
+        QStringList imagePaths;
+        for (const ProjectManager::ImageRecord &record : records) {
+            // The catalog query matches by prefix; keep direct children only
+            if (record.status != "missing" && QFileInfo(record.filePath).path() == lastFolder) {
+                imagePaths.append(record.filePath);
+            }
+        }
+
+        folderManager->selectFolder(lastFolder);
+        imageGrid->loadImages(lastFolder, imagePaths);
+        updateStatus("Restored folder: " + QDir(lastFolder).dirName());
+    });
 }
 
 void MainWindow::onProjectClosed()
@@ -554,6 +724,33 @@ void MainWindow::onShowFolderInTree(const QString &folderPath)
     updateStatus("Folder not found in project tree");
 }
 
+// ===== INTEGRITY SCRUB =====
+
+void MainWindow::onIntegrityScrubFinished(int verified, int corrupted)
+{
+    const QStringList corruptedFiles = projectManager->getCorruptedFiles();
+    if (corruptedFiles.isEmpty()) {
+        updateStatus(QString("Integrity verification complete: %1 files verified, no corruption found")
+                         .arg(verified));
+        return;
+    }
+
+    // Marks from earlier passes stay until a good copy verifies again
+    QString details = corruptedFiles.mid(0, MAX_LISTED_CORRUPTED).join("\n");
+    if (corruptedFiles.size() > MAX_LISTED_CORRUPTED) {
+        details += QString("\n... and %1 more").arg(corruptedFiles.size() - MAX_LISTED_CORRUPTED);
+    }
+
+    QMessageBox::warning(this, "Integrity Verification",
+                         QString("Verified %1 files; %2 newly found corrupted or unreadable.\n\n"
+                                 "%3 files no longer match the hash stored at import:\n\n%4\n\n"
+                                 "Restore them from a backup; the next pass clears the mark once they verify.")
+                             .arg(verified)
+                             .arg(corrupted)
+                             .arg(corruptedFiles.size())
+                             .arg(details));
+}
+
 // ===== IMAGE HANDLING =====
 
 void MainWindow::onImageClicked(const QString &imagePath)
@@ -567,7 +764,7 @@ void MainWindow::displayFullImage(const QString &imagePath)
 
     QPixmap fullImage(imagePath);
     if (!fullImage.isNull()) {
-        imageLabel->setImagePixmap(fullImage);
+        imageLabel->setImagePixmap(fullImage, imagePath);
 
         QFileInfo fileInfo(imagePath);
         updateStatus(QString("Viewing: %1 (%2x%3)")
@@ -626,8 +823,8 @@ void MainWindow::loadSettings()
     // Load last opened project instead of legacy folder system
     QString lastProjectPath = settings->value("lastProjectPath").toString();
     if (!lastProjectPath.isEmpty() && QDir(lastProjectPath).exists()) {
-        // Delay project loading to ensure UI is ready
-        QTimer::singleShot(100, [this, lastProjectPath]() {
+        // Open once the event loop runs, so the window is shown first
+        QTimer::singleShot(0, this, [this, lastProjectPath]() {
             openProject(lastProjectPath);
         });
     }
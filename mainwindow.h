@@ -13,7 +13,10 @@
 class ImageGridWidget;
 class FolderManager;
 class ThumbnailService;
+class ThumbnailWarmer;
+class IntegrityScrubber;
 class ProjectManager;
+class AsyncProjectManager;
 class ZoomableImageLabel;
 class QSplitter;
 
@@ -34,6 +37,7 @@ private slots:
     void synchronizeProject();
     void showProjectInfo();
     void analyzeDuplicates();
+    void verifyIntegrity();
 
     // === Folder Management ===
     void addFolder();
@@ -56,6 +60,9 @@ private slots:
     // === Duplicate Analysis ===
     void onShowFolderInTree(const QString &folderPath);
 
+    // === Integrity Scrub ===
+    void onIntegrityScrubFinished(int verified, int corrupted);
+
 private:
     // === UI Setup ===
     void setupUI();
@@ -69,6 +76,7 @@ private:
     void hideWelcomeScreen();
     bool confirmProjectClose();
     void enableProjectActions(bool enabled);
+    void restoreLastFolder();
 
     // === Image Display ===
     void displayFullImage(const QString &imagePath);
@@ -101,7 +109,10 @@ private:
 
     // === Services ===
     ThumbnailService *thumbnailService;
+    ThumbnailWarmer *thumbnailWarmer;
+    IntegrityScrubber *integrityScrubber;
     ProjectManager *projectManager;
+    AsyncProjectManager *asyncProjectManager;
 
     // === Data ===
     QSettings *settings;
@@ -0,0 +1,273 @@
+#include "memorygovernor.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QTimer>
+#include <algorithm>
+
+// === Constants ===
+namespace {
+constexpr qint64 MB = 1024 * 1024;
+constexpr qint64 MIN_BUDGET = 64 * MB;
+constexpr qint64 MAX_BUDGET = 1024 * MB;
+constexpr qint64 FALLBACK_BUDGET = 512 * MB;    // When available memory is unknown
+constexpr double CACHE_SHARE = 0.25;            // Share of available memory for caches
+constexpr qint64 UNLIMITED_THRESHOLD = qint64(1) << 60;  // cgroup v1 "no limit" value
+
+constexpr int POLL_INTERVAL_MS = 2000;
+
+constexpr double PRESSURE_MODERATE = 2.0;       // PSI "some avg10" percentages
+constexpr double PRESSURE_HIGH = 10.0;
+constexpr double MODERATE_PRESSURE_FACTOR = 0.75;
+constexpr double HIGH_PRESSURE_FACTOR = 0.5;
+
+const QString PROC_CGROUP = "/proc/self/cgroup";
+const QString PROC_MEMINFO = "/proc/meminfo";
+const QString PROC_PRESSURE = "/proc/pressure/memory";
+const QString CGROUP_V2_ROOT = "/sys/fs/cgroup";
+const QString CGROUP_V1_MEMORY_ROOT = "/sys/fs/cgroup/memory";
+
+QByteArray readSmallFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+/**
+ * @brief Find the cgroup path of this process for a hierarchy
+ * @param controller Controller name ("memory" for v1, empty for the v2 unified hierarchy)
+ */
+QString cgroupPath(const QByteArray &controller)
+{
+    const QList<QByteArray> lines = readSmallFile(PROC_CGROUP).split('\n');
+    for (const QByteArray &line : lines) {
+        // hierarchy-ID:controller-list:path
+        const QList<QByteArray> fields = line.split(':');
+        if (fields.size() < 3) {
+            continue;
+        }
+
+        const bool matches = controller.isEmpty()
+            ? fields.at(0) == "0" && fields.at(1).isEmpty()
+            : fields.at(1).split(',').contains(controller);
+        if (matches) {
+            return QString::fromUtf8(fields.mid(2).join(':'));
+        }
+    }
+    return QString();
+}
+
+qint64 parseLimit(const QByteArray &value)
+{
+    bool ok = false;
+    const qint64 limit = value.trimmed().toLongLong(&ok);
+    return (ok && limit > 0 && limit < UNLIMITED_THRESHOLD) ? limit : 0;
+}
+}
+
+// === Constructor ===
+
+MemoryGovernor *MemoryGovernor::instance()
+{
+    // Parented to the application so it is destroyed with it, after the windows
+    static MemoryGovernor *governor = new MemoryGovernor(QCoreApplication::instance());
+    return governor;
+}
+
+MemoryGovernor::MemoryGovernor(QObject *parent)
+    : QObject(parent)
+    , m_baseBudget(automaticBudget())
+    , m_pressureFactor(1.0)
+    , m_nextId(1)
+    , m_checkPending(false)
+{
+    m_pollTimer = new QTimer(this);
+    connect(m_pollTimer, &QTimer::timeout, this, &MemoryGovernor::rebalance);
+    m_pollTimer->start(POLL_INTERVAL_MS);
+}
+
+// === Registration ===
+
+int MemoryGovernor::registerConsumer(const QString &name, double weight,
+                                     UsageFunction usage, EvictFunction evict)
+{
+    Consumer consumer;
+    consumer.id = m_nextId++;
+    consumer.name = name;
+    consumer.weight = qMax(0.01, weight);
+    consumer.usage = std::move(usage);
+    consumer.evict = std::move(evict);
+    m_consumers.append(consumer);
+    return consumer.id;
+}
+
+void MemoryGovernor::unregisterConsumer(int id)
+{
+    m_consumers.removeIf([id](const Consumer &consumer) { return consumer.id == id; });
+}
+
+void MemoryGovernor::notifyGrowth()
+{
+    if (m_checkPending) {
+        return;
+    }
+
+    m_checkPending = true;
+    QTimer::singleShot(0, this, &MemoryGovernor::rebalance);
+}
+
+// === Budget ===
+
+void MemoryGovernor::setBudget(qint64 bytes)
+{
+    m_baseBudget = bytes > 0 ? bytes : automaticBudget();
+    rebalance();
+}
+
+qint64 MemoryGovernor::effectiveBudget() const
+{
+    return static_cast<qint64>(m_baseBudget * m_pressureFactor);
+}
+
+// === Private Slots ===
+
+void MemoryGovernor::rebalance()
+{
+    m_checkPending = false;
+
+    const double pressure = memoryPressure();
+    m_pressureFactor = pressure >= PRESSURE_HIGH     ? HIGH_PRESSURE_FACTOR
+                       : pressure >= PRESSURE_MODERATE ? MODERATE_PRESSURE_FACTOR
+                                                       : 1.0;
+
+    const qint64 budget = effectiveBudget();
+    double totalWeight = 0;
+    qint64 totalUsage = 0;
+    QList<qint64> usages;
+    usages.reserve(m_consumers.size());
+    for (const Consumer &consumer : std::as_const(m_consumers)) {
+        const qint64 usage = consumer.usage();
+        usages.append(usage);
+        totalUsage += usage;
+        totalWeight += consumer.weight;
+    }
+
+    if (totalUsage <= budget || m_consumers.isEmpty()) {
+        return;
+    }
+
+    // Caches furthest above their weighted share give memory back first
+    QList<int> order(m_consumers.size());
+    QList<qint64> overage(m_consumers.size());
+    for (int i = 0; i < m_consumers.size(); ++i) {
+        order[i] = i;
+        const qint64 share = static_cast<qint64>(budget * m_consumers.at(i).weight / totalWeight);
+        overage[i] = usages.at(i) - share;
+    }
+    std::sort(order.begin(), order.end(), [&overage](int a, int b) {
+        return overage.at(a) > overage.at(b);
+    });
+
+    // First pass: trim caches down to their share; second pass: take what is
+    // still missing from anyone (a cache may have refused, e.g. while in use)
+    for (int pass = 0; pass < 2 && totalUsage > budget; ++pass) {
+        for (int index : std::as_const(order)) {
+            const qint64 excess = totalUsage - budget;
+            if (excess <= 0) {
+                break;
+            }
+
+            const qint64 available = pass == 0 ? overage.at(index) : usages.at(index);
+            const qint64 request = qMin(excess, available);
+            if (request <= 0) {
+                continue;
+            }
+
+            const qint64 freed = qMax<qint64>(0, m_consumers.at(index).evict(request));
+            usages[index] -= freed;
+            overage[index] -= freed;
+            totalUsage -= freed;
+        }
+    }
+}
+
+// === Private Methods ===
+
+qint64 MemoryGovernor::automaticBudget()
+{
+    const qint64 available = availableMemory();
+    if (available <= 0) {
+        return FALLBACK_BUDGET;
+    }
+    return qBound(MIN_BUDGET, static_cast<qint64>(available * CACHE_SHARE), MAX_BUDGET);
+}
+
+qint64 MemoryGovernor::availableMemory()
+{
+    qint64 available = 0;
+
+#ifdef Q_OS_LINUX
+    // MemTotal:       16318412 kB
+    const QList<QByteArray> lines = readSmallFile(PROC_MEMINFO).split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("MemTotal:")) {
+            const QList<QByteArray> fields = line.simplified().split(' ');
+            if (fields.size() >= 2) {
+                available = fields.at(1).toLongLong() * 1024;
+            }
+            break;
+        }
+    }
+
+    // cgroup v2, then v1
+    qint64 cgroupLimit = 0;
+    const QString unifiedPath = cgroupPath(QByteArray());
+    if (!unifiedPath.isNull()) {
+        cgroupLimit = parseLimit(readSmallFile(CGROUP_V2_ROOT + unifiedPath + "/memory.max"));
+    }
+    if (cgroupLimit == 0) {
+        const QString memoryPath = cgroupPath("memory");
+        if (!memoryPath.isNull()) {
+            cgroupLimit = parseLimit(readSmallFile(CGROUP_V1_MEMORY_ROOT + memoryPath +
+                                                   "/memory.limit_in_bytes"));
+        }
+    }
+
+    if (cgroupLimit > 0 && (available == 0 || cgroupLimit < available)) {
+        available = cgroupLimit;
+    }
+#endif
+
+    return available;
+}
+
+double MemoryGovernor::memoryPressure()
+{
+#ifdef Q_OS_LINUX
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    QByteArray contents;
+    const QString unifiedPath = cgroupPath(QByteArray());
+    if (!unifiedPath.isNull()) {
+        contents = readSmallFile(CGROUP_V2_ROOT + unifiedPath + "/memory.pressure");
+    }
+    if (contents.isEmpty()) {
+        contents = readSmallFile(PROC_PRESSURE);
+    }
+
+    const QList<QByteArray> lines = contents.split('\n');
+    for (const QByteArray &line : lines) {
+        if (!line.startsWith("some ")) {
+            continue;
+        }
+        for (const QByteArray &field : line.split(' ')) {
+            if (field.startsWith("avg10=")) {
+                return field.mid(6).toDouble();
+            }
+        }
+    }
+#endif
+
+    return 0.0;
+}
@@ -0,0 +1,129 @@
+#ifndef MEMORYGOVERNOR_H
+#define MEMORYGOVERNOR_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <functional>
+
+class QTimer;
+
+/**
+ * @brief Process-wide memory budget shared by all caches
+ *
+ * Caches register with a weight, a usage callback and an eviction
+ * callback. The governor periodically sums their usage against one total
+ * budget; when it is exceeded, the caches furthest above their weighted
+ * share of the budget are asked to free memory first.
+ *
+ * The budget follows the environment:
+ * - a quarter of the memory actually available to the process: the cgroup
+ *   limit (v2 memory.max or v1 limit_in_bytes) or physical RAM, whichever
+ *   is lower, clamped to 64 MB .. 1 GB
+ * - under memory pressure (PSI "some avg10" of the cgroup, or
+ *   /proc/pressure/memory) the effective budget shrinks to 75% or 50%
+ *
+ * Lives on the GUI thread; callbacks are invoked there, which is also
+ * where every registered cache is used.
+ */
+class MemoryGovernor : public QObject
+{
+    Q_OBJECT
+
+public:
+    using UsageFunction = std::function<qint64()>;
+    using EvictFunction = std::function<qint64(qint64 bytes)>;
+
+    /**
+     * @brief Get the governor instance
+     * @return Process-wide governor (created on first use)
+     */
+    static MemoryGovernor *instance();
+
+    // === Registration ===
+
+    /**
+     * @brief Register a cache
+     * @param name Name used in log messages
+     * @param weight Relative share of the budget
+     * @param usage Returns the bytes the cache currently holds
+     * @param evict Frees at least the given bytes if possible, returns bytes freed
+     * @return Consumer ID for unregisterConsumer()
+     */
+    int registerConsumer(const QString &name, double weight,
+                         UsageFunction usage, EvictFunction evict);
+
+    /**
+     * @brief Unregister a cache (call before it is destroyed)
+     * @param id Consumer ID
+     */
+    void unregisterConsumer(int id);
+
+    /**
+     * @brief Ask for a budget check soon after a cache grew
+     *
+     * Coalesced: any number of calls before the check runs cost one check.
+     */
+    void notifyGrowth();
+
+    // === Budget ===
+
+    /**
+     * @brief Override the automatic budget
+     * @param bytes Total budget in bytes, 0 to use the automatic budget
+     */
+    void setBudget(qint64 bytes);
+
+    /**
+     * @brief Get the budget currently enforced
+     * @return Budget in bytes, after the pressure adjustment
+     */
+    qint64 effectiveBudget() const;
+
+private slots:
+    /**
+     * @brief Compare usage against the budget and evict if needed
+     */
+    void rebalance();
+
+private:
+    explicit MemoryGovernor(QObject *parent = nullptr);
+
+    /**
+     * @brief Registered cache
+     */
+    struct Consumer {
+        int id;                      ///< Consumer ID
+        QString name;                ///< Name for log messages
+        double weight;               ///< Relative share of the budget
+        UsageFunction usage;         ///< Current usage callback
+        EvictFunction evict;         ///< Eviction callback
+    };
+
+    /**
+     * @brief Compute the automatic budget from cgroup limit and RAM
+     * @return Budget in bytes
+     */
+    static qint64 automaticBudget();
+
+    /**
+     * @brief Read the memory available to the process
+     * @return Lower of cgroup limit and physical RAM, 0 if unknown
+     */
+    static qint64 availableMemory();
+
+    /**
+     * @brief Read the PSI memory pressure of the process's cgroup
+     * @return "some avg10" percentage, 0 if unavailable
+     */
+    static double memoryPressure();
+
+    QList<Consumer> m_consumers;            ///< Registered caches
+    QTimer *m_pollTimer;                    ///< Periodic budget check
+    qint64 m_baseBudget;                    ///< Budget without pressure adjustment
+    double m_pressureFactor;                ///< Share of the budget under current pressure
+    int m_nextId;                           ///< Next consumer ID
+    bool m_checkPending;                    ///< notifyGrowth() check queued
+};
+
+#endif // MEMORYGOVERNOR_H
@@ -0,0 +1,109 @@
+#include "pagecacheadvisor.h"
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#ifdef Q_OS_LINUX
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <fcntl.h>
+#endif
+
+// === Constants ===
+namespace {
+constexpr qint64 DROP_BEHIND_WINDOW = 8 * 1024 * 1024;  // Bytes consumed between drops
+
+const QString SYSFS_ROTATIONAL = "/sys/dev/block/%1:%2/queue/rotational";
+const QString SYSFS_PARENT_ROTATIONAL = "/sys/dev/block/%1:%2/../queue/rotational";
+
+QMutex rotationalMutex;
+QHash<quint64, bool> rotationalDevices;
+}
+
+// === Construction ===
+
+PageCacheAdvisor::PageCacheAdvisor(int fd, qint64 startOffset)
+    : m_fd(fd)
+    , m_dropped(startOffset)
+{
+#ifdef Q_OS_LINUX
+    if (m_fd < 0) {
+        return;
+    }
+
+    // Spinning disks gain from a larger readahead window; SSDs keep the default
+    struct stat fileStat;
+    if (fstat(m_fd, &fileStat) == 0 && isRotationalDevice(fileStat.st_dev)) {
+        posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+}
+
+PageCacheAdvisor::~PageCacheAdvisor()
+{
+    finish();
+}
+
+// === Advising ===
+
+void PageCacheAdvisor::advance(qint64 offset)
+{
+    if (m_fd < 0 || offset - m_dropped < DROP_BEHIND_WINDOW) {
+        return;
+    }
+
+    drop(m_dropped, offset - m_dropped);
+    m_dropped = offset;
+}
+
+void PageCacheAdvisor::finish()
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    drop(m_dropped, 0);
+    m_fd = -1;
+}
+
+void PageCacheAdvisor::drop(qint64 offset, qint64 length)
+{
+#ifdef Q_OS_LINUX
+    posix_fadvise(m_fd, offset, length, POSIX_FADV_DONTNEED);
+#else
+    Q_UNUSED(offset);
+    Q_UNUSED(length);
+#endif
+}
+
+// === Devices ===
+
+bool PageCacheAdvisor::isRotationalDevice(quint64 device)
+{
+#ifdef Q_OS_LINUX
+    QMutexLocker locker(&rotationalMutex);
+    const auto cached = rotationalDevices.constFind(device);
+    if (cached != rotationalDevices.constEnd()) {
+        return cached.value();
+    }
+
+    // Partitions have no queue directory of their own; ask the parent disk
+    const unsigned majorNumber = major(dev_t(device));
+    const unsigned minorNumber = minor(dev_t(device));
+    bool rotational = false;
+    for (const QString &pattern : {SYSFS_ROTATIONAL, SYSFS_PARENT_ROTATIONAL}) {
+        QFile file(pattern.arg(majorNumber).arg(minorNumber));
+        if (file.open(QIODevice::ReadOnly)) {
+            rotational = file.readAll().trimmed() == "1";
+            break;
+        }
+    }
+
+    rotationalDevices.insert(device, rotational);
+    return rotational;
+#else
+    Q_UNUSED(device);
+    return false;
+#endif
+}
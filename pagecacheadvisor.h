@@ -0,0 +1,63 @@
+#ifndef PAGECACHEADVISOR_H
+#define PAGECACHEADVISOR_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Keeps one-pass streaming reads out of the page cache
+ *
+ * Bulk hashing reads every byte of the library exactly once. Left alone,
+ * those pages push the catalog database and thumbnail cache out of memory.
+ * The advisor wraps a sequential read of one file descriptor:
+ * - readahead is tuned per device (a doubled window on spinning disks,
+ *   the kernel default on SSDs where the deep queue already hides latency)
+ * - pages behind the read cursor are dropped in windows with
+ *   posix_fadvise(DONTNEED), and the remainder when the advisor is destroyed
+ *
+ * Only affects Linux; elsewhere all calls are no-ops.
+ */
+class PageCacheAdvisor
+{
+public:
+    /**
+     * @brief Start advising a sequential read
+     * @param fd Open file descriptor (-1 disables the advisor)
+     * @param startOffset Offset the read starts at
+     */
+    explicit PageCacheAdvisor(int fd, qint64 startOffset = 0);
+    ~PageCacheAdvisor();
+
+    PageCacheAdvisor(const PageCacheAdvisor &) = delete;
+    PageCacheAdvisor &operator=(const PageCacheAdvisor &) = delete;
+
+    /**
+     * @brief Report the read cursor position
+     * @param offset Offset up to which the file has been consumed
+     */
+    void advance(qint64 offset);
+
+    /**
+     * @brief Drop everything read so far and stop advising
+     */
+    void finish();
+
+    /**
+     * @brief Check if a block device is rotational
+     * @param device Device number (st_dev)
+     * @return True for spinning disks (cached per device, thread-safe)
+     */
+    static bool isRotationalDevice(quint64 device);
+
+private:
+    /**
+     * @brief Drop cached pages of a range
+     * @param offset Range start
+     * @param length Range length, 0 for up to end of file
+     */
+    void drop(qint64 offset, qint64 length);
+
+    int m_fd;                         ///< Advised descriptor, -1 once finished
+    qint64 m_dropped;                 ///< Offset up to which pages were dropped
+};
+
+#endif // PAGECACHEADVISOR_H
@@ -1,19 +1,31 @@
 #include "projectmanager.h"
+#include "thumbnailservice.h"
+#include "taskscheduler.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
-#include <QCryptographicHash>
-#include <QImageReader>
+#include <QSet>
 #include <QDebug>
 #include <QStandardPaths>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QFuture>
+#include <QThread>
+#include <QCoreApplication>
+
+#ifdef Q_OS_LINUX
+#include <sys/stat.h>
+#endif
 
 // === Constants ===
 namespace {
 const QString DB_CONNECTION_NAME = "project_db";
+const QString DB_CONNECT_OPTIONS = "QSQLITE_BUSY_TIMEOUT=%1";
+constexpr int DB_BUSY_TIMEOUT_MS = 5000;       // Worker connections wait out other writers
+constexpr int DB_GUI_BUSY_TIMEOUT_MS = 250;    // Longest the GUI thread waits for a lock
 const QString DB_FILENAME = "catalog.db";
 const QString PROJECT_FILENAME = "project.json";
 const QString PROJECT_VERSION = "1.0";
@@ -21,23 +33,38 @@ const QString PROJECT_VERSION = "1.0";
 // Database table names
 const QString TABLE_FOLDERS = "project_folders";
 const QString TABLE_IMAGES = "images";
+const QString TABLE_STATE = "project_state";
+const QString TABLE_DUPLICATE_FOLDERS = "duplicate_folders";
+const QString TABLE_DUPLICATE_PAIRS = "duplicate_pairs";
 
 // Image status values
 const QString STATUS_OK = "ok";
 const QString STATUS_MISSING = "missing";
 const QString STATUS_MODIFIED = "modified";
 const QString STATUS_CONFLICT = "conflict";
+const QString STATUS_CORRUPTED = "corrupted";
 
 // Default values
 const int DEFAULT_RATING = 0;
 const QString DEFAULT_USER_STATUS = "";
 const QString DEFAULT_TAGS = "";
+
+// Ingestion
+constexpr qint64 INGEST_MAX_BUFFERED_SIZE = 64 * 1024 * 1024;  // Larger files are left to the warmer
+constexpr int INGEST_IN_FLIGHT_PER_THREAD = 2;                  // Buffered files awaiting decode
 }
 
 // === Constructor & Destructor ===
 
 ProjectManager::ProjectManager(QObject *parent)
+    : ProjectManager(DB_CONNECTION_NAME, parent)
+{
+}
+
+ProjectManager::ProjectManager(const QString &connectionName, QObject *parent)
     : QObject(parent)
+    , m_connectionName(connectionName)
+    , m_thumbnailService(nullptr)
 {
     initializeSupportedExtensions();
 }
@@ -80,6 +107,16 @@ bool ProjectManager::createProject(const QString &projectPath, const QString &pr
 }
 
 bool ProjectManager::openProject(const QString &projectPath)
+{
+    return openExistingProject(projectPath, true);
+}
+
+bool ProjectManager::attachProject(const QString &projectPath)
+{
+    return openExistingProject(projectPath, false);
+}
+
+bool ProjectManager::openExistingProject(const QString &projectPath, bool migrate)
 {
     closeProject();
 
@@ -97,7 +134,9 @@ bool ProjectManager::openProject(const QString &projectPath)
         return false;
     }
 
-    migrateDatabase();
+    if (migrate) {
+        migrateDatabase();
+    }
 
     emit projectOpened(m_projectName);
     return true;
@@ -107,7 +146,8 @@ bool ProjectManager::closeProject()
 {
     if (m_database.isOpen()) {
         m_database.close();
-        QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
+        m_database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
         emit projectClosed();
     }
 
@@ -227,6 +267,133 @@ ProjectManager::ImageRecord ProjectManager::getImageRecord(const QString &filePa
     return record;
 }
 
+QList<ProjectManager::ImageRecord> ProjectManager::getImagesAfter(int lastId, int limit) const
+{
+    QList<ImageRecord> images;
+    if (!m_database.isOpen()) {
+        return images;
+    }
+
+    QSqlQuery query(m_database);
+    query.prepare(QString("SELECT * FROM %1 WHERE id > ? AND status != ? ORDER BY id LIMIT ?").arg(TABLE_IMAGES));
+    query.addBindValue(lastId);
+    query.addBindValue(STATUS_MISSING);
+    query.addBindValue(limit);
+    query.exec();
+
+    while (query.next()) {
+        images.append(createImageRecordFromQuery(query));
+    }
+
+    return images;
+}
+
+QList<ProjectManager::ImageRecord> ProjectManager::getImagesToVerifyAfter(int lastId, int limit) const
+{
+    QList<ImageRecord> images;
+    if (!m_database.isOpen()) {
+        return images;
+    }
+
+    QSqlQuery query(m_database);
+    query.prepare(QString("SELECT * FROM %1 WHERE id > ? AND status IN (?, ?) ORDER BY id LIMIT ?").arg(TABLE_IMAGES));
+    query.addBindValue(lastId);
+    query.addBindValue(STATUS_OK);
+    query.addBindValue(STATUS_CORRUPTED);
+    query.addBindValue(limit);
+    query.exec();
+
+    while (query.next()) {
+        images.append(createImageRecordFromQuery(query));
+    }
+
+    return images;
+}
+
+ProjectManager::DuplicateFilePage ProjectManager::getDuplicateFiles(const QString &afterHash,
+                                                                   qint64 afterSize, int limit) const
+{
+    DuplicateFilePage page;
+    if (!m_database.isOpen()) {
+        return page;
+    }
+
+    // Keyset pagination walks the covering index in order, so every page is
+    // as cheap as the first
+    QSqlQuery groupQuery(m_database);
+    groupQuery.prepare(QString("SELECT file_hash, file_size FROM %1 "
+                               "WHERE status = ? AND file_hash != '' AND (file_hash, file_size) > (?, ?) "
+                               "GROUP BY file_hash, file_size HAVING COUNT(*) > 1 "
+                               "ORDER BY file_hash, file_size LIMIT ?").arg(TABLE_IMAGES));
+    groupQuery.addBindValue(STATUS_OK);
+    groupQuery.addBindValue(afterHash);
+    groupQuery.addBindValue(afterSize);
+    groupQuery.addBindValue(limit);
+    if (!groupQuery.exec()) {
+        qWarning() << "Failed to group duplicate files:" << groupQuery.lastError().text();
+        return page;
+    }
+
+    QList<QPair<QString, qint64>> keys;
+    while (groupQuery.next()) {
+        keys.append(qMakePair(groupQuery.value(0).toString(), groupQuery.value(1).toLongLong()));
+    }
+    if (keys.isEmpty()) {
+        return page;
+    }
+
+    page.lastHash = keys.last().first;
+    page.lastSize = keys.last().second;
+    page.exhausted = keys.size() < limit;
+
+    QSqlQuery fileQuery(m_database);
+    fileQuery.prepare(QString("SELECT * FROM %1 WHERE file_hash = ? AND file_size = ? AND status = ? "
+                              "ORDER BY file_path").arg(TABLE_IMAGES));
+
+    for (const auto &key : std::as_const(keys)) {
+        DuplicateFileGroup group;
+        group.fileHash = key.first;
+        group.fileSize = key.second;
+
+        // Hard-linked copies (e.g. after a reclaim) share one inode and take
+        // no extra space; copies that cannot be stat'ed count as distinct
+        QSet<QPair<quint64, quint64>> inodes;
+        int unknownInodes = 0;
+
+        fileQuery.addBindValue(key.first);
+        fileQuery.addBindValue(key.second);
+        fileQuery.addBindValue(STATUS_OK);
+        fileQuery.exec();
+
+        while (fileQuery.next()) {
+            const ImageRecord record = createImageRecordFromQuery(fileQuery);
+
+            // A stored hash only describes the file it was computed from
+            const QFileInfo fileInfo(record.filePath);
+            if (fileInfo.size() != record.fileSize || fileInfo.lastModified() != record.dateModified) {
+                continue;
+            }
+            group.files.append(record);
+
+#ifdef Q_OS_LINUX
+            struct stat fileStat;
+            if (::stat(QFile::encodeName(record.filePath).constData(), &fileStat) == 0) {
+                inodes.insert(qMakePair(quint64(fileStat.st_dev), quint64(fileStat.st_ino)));
+                continue;
+            }
+#endif
+            unknownInodes++;
+        }
+        group.distinctCopies = inodes.size() + unknownInodes;
+
+        if (group.files.size() > 1) {
+            page.groups.append(group);
+        }
+    }
+
+    return page;
+}
+
 void ProjectManager::updateImageStatus(const QString &filePath, const QString &status)
 {
     if (!m_database.isOpen()) {
@@ -245,9 +412,222 @@ void ProjectManager::updateImageStatus(const QString &filePath, const QString &s
     }
 }
 
+bool ProjectManager::updateModifiedDates(const QHash<QString, QDateTime> &modifiedDates)
+{
+    if (!m_database.isOpen()) {
+        return false;
+    }
+    if (modifiedDates.isEmpty()) {
+        return true;
+    }
+
+    m_database.transaction();
+
+    QSqlQuery query(m_database);
+    query.prepare(QString("UPDATE %1 SET date_modified = ? WHERE file_path = ?").arg(TABLE_IMAGES));
+    for (auto it = modifiedDates.constBegin(); it != modifiedDates.constEnd(); ++it) {
+        query.addBindValue(it.value());
+        query.addBindValue(it.key());
+        if (!query.exec()) {
+            qWarning() << "Failed to update modification date:" << query.lastError().text();
+            m_database.rollback();
+            return false;
+        }
+    }
+
+    return m_database.commit();
+}
+
+void ProjectManager::setFileCorrupted(const QString &filePath, bool corrupted)
+{
+    // Only rows with a trustworthy hash change state; a sync may have
+    // re-classified the file since it was read
+    if (!m_database.isOpen()) {
+        return;
+    }
+
+    const QString status = corrupted ? STATUS_CORRUPTED : STATUS_OK;
+    QSqlQuery query(m_database);
+    query.prepare(QString("UPDATE %1 SET status = ? WHERE file_path = ? AND status = ?").arg(TABLE_IMAGES));
+    query.addBindValue(status);
+    query.addBindValue(filePath);
+    query.addBindValue(corrupted ? STATUS_OK : STATUS_CORRUPTED);
+
+    if (!query.exec()) {
+        qWarning() << "Failed to update image status:" << query.lastError().text();
+    } else if (query.numRowsAffected() > 0) {
+        emit imageStatusChanged(filePath, status);
+    }
+}
+
+QStringList ProjectManager::getCorruptedFiles() const
+{
+    QStringList files;
+    if (!m_database.isOpen()) {
+        return files;
+    }
+
+    QSqlQuery query(m_database);
+    query.prepare(QString("SELECT file_path FROM %1 WHERE status = ? ORDER BY file_path").arg(TABLE_IMAGES));
+    query.addBindValue(STATUS_CORRUPTED);
+
+    if (query.exec()) {
+        while (query.next()) {
+            files.append(query.value(0).toString());
+        }
+    }
+    return files;
+}
+
+// === Project State ===
+
+QVariant ProjectManager::getProjectValue(const QString &key, const QVariant &defaultValue) const
+{
+    if (!m_database.isOpen()) {
+        return defaultValue;
+    }
+
+    QSqlQuery query(m_database);
+    query.prepare(QString("SELECT value FROM %1 WHERE key = ?").arg(TABLE_STATE));
+    query.addBindValue(key);
+
+    if (query.exec() && query.next()) {
+        return query.value(0);
+    }
+    return defaultValue;
+}
+
+void ProjectManager::setProjectValue(const QString &key, const QVariant &value)
+{
+    if (!m_database.isOpen()) {
+        return;
+    }
+
+    QSqlQuery query(m_database);
+    query.prepare(QString("INSERT OR REPLACE INTO %1 (key, value) VALUES (?, ?)").arg(TABLE_STATE));
+    query.addBindValue(key);
+    query.addBindValue(value);
+
+    if (!query.exec()) {
+        qWarning() << "Failed to save project state:" << query.lastError().text();
+    }
+}
+
+// === Duplicate Analysis Results ===
+
+QList<ProjectManager::DuplicateFolderRecord> ProjectManager::getDuplicateFolders() const
+{
+    QList<DuplicateFolderRecord> folders;
+    if (!m_database.isOpen()) {
+        return folders;
+    }
+
+    QSqlQuery query(QString("SELECT folder_path, fingerprint, file_count, total_size, subfolders FROM %1")
+                        .arg(TABLE_DUPLICATE_FOLDERS), m_database);
+    while (query.next()) {
+        DuplicateFolderRecord folder;
+        folder.folderPath = query.value(0).toString();
+        folder.fingerprint = query.value(1).toString();
+        folder.fileCount = query.value(2).toInt();
+        folder.totalSize = query.value(3).toLongLong();
+        const QString subfolders = query.value(4).toString();
+        if (!subfolders.isEmpty()) {
+            folder.subfolders = subfolders.split('\n');
+        }
+        folders.append(folder);
+    }
+
+    return folders;
+}
+
+QList<ProjectManager::DuplicatePairRecord> ProjectManager::getDuplicatePairs() const
+{
+    QList<DuplicatePairRecord> pairs;
+    if (!m_database.isOpen()) {
+        return pairs;
+    }
+
+    QSqlQuery query(QString("SELECT folder1, folder2, match_type, intersection, union_size FROM %1 ORDER BY id")
+                        .arg(TABLE_DUPLICATE_PAIRS), m_database);
+    while (query.next()) {
+        DuplicatePairRecord pair;
+        pair.folder1 = query.value(0).toString();
+        pair.folder2 = query.value(1).toString();
+        pair.matchType = query.value(2).toInt();
+        pair.intersection = query.value(3).toInt();
+        pair.unionSize = query.value(4).toInt();
+        pairs.append(pair);
+    }
+
+    return pairs;
+}
+
+bool ProjectManager::saveDuplicateAnalysis(const QList<DuplicateFolderRecord> &changedFolders,
+                                           const QStringList &removedFolders,
+                                           const QList<DuplicatePairRecord> &changedPairs,
+                                           const QList<DuplicatePairRecord> &removedPairs)
+{
+    if (!m_database.isOpen()) {
+        return false;
+    }
+
+    m_database.transaction();
+    QSqlQuery query(m_database);
+    bool success = true;
+
+    query.prepare(QString("DELETE FROM %1 WHERE folder_path = ?").arg(TABLE_DUPLICATE_FOLDERS));
+    for (const QString &folderPath : removedFolders) {
+        query.addBindValue(folderPath);
+        success &= query.exec();
+    }
+
+    query.prepare(QString("INSERT OR REPLACE INTO %1 (folder_path, fingerprint, file_count, total_size, subfolders) "
+                          "VALUES (?, ?, ?, ?, ?)").arg(TABLE_DUPLICATE_FOLDERS));
+    for (const DuplicateFolderRecord &folder : changedFolders) {
+        query.addBindValue(folder.folderPath);
+        query.addBindValue(folder.fingerprint);
+        query.addBindValue(folder.fileCount);
+        query.addBindValue(folder.totalSize);
+        query.addBindValue(folder.subfolders.join('\n'));
+        success &= query.exec();
+    }
+
+    query.prepare(QString("DELETE FROM %1 WHERE folder1 = ? AND folder2 = ?").arg(TABLE_DUPLICATE_PAIRS));
+    for (const DuplicatePairRecord &pair : removedPairs) {
+        query.addBindValue(pair.folder1);
+        query.addBindValue(pair.folder2);
+        success &= query.exec();
+    }
+
+    query.prepare(QString("INSERT INTO %1 (folder1, folder2, match_type, intersection, union_size) "
+                          "VALUES (?, ?, ?, ?, ?)").arg(TABLE_DUPLICATE_PAIRS));
+    for (const DuplicatePairRecord &pair : changedPairs) {
+        query.addBindValue(pair.folder1);
+        query.addBindValue(pair.folder2);
+        query.addBindValue(pair.matchType);
+        query.addBindValue(pair.intersection);
+        query.addBindValue(pair.unionSize);
+        success &= query.exec();
+    }
+
+    if (!success) {
+        qWarning() << "Failed to save duplicate analysis:" << query.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+    return m_database.commit();
+}
+
+// === Ingestion ===
+
+void ProjectManager::setThumbnailService(ThumbnailService *thumbnailService)
+{
+    m_thumbnailService = thumbnailService;
+}
+
 // === Synchronization ===
 
-ProjectManager::SyncResult ProjectManager::synchronizeProject()
+ProjectManager::SyncResult ProjectManager::synchronizeProject(const CancelCheck &isCanceled)
 {
     if (!m_database.isOpen()) {
         return SyncResult();
@@ -255,7 +635,9 @@ ProjectManager::SyncResult ProjectManager::synchronizeProject()
 
     emit syncStarted();
 
+    m_syncCanceled = isCanceled;
     SyncResult result = performSynchronization();
+    m_syncCanceled = CancelCheck();
 
     emit syncCompleted(result);
     return result;
@@ -294,40 +676,72 @@ int ProjectManager::getTotalImageCount() const
 bool ProjectManager::initializeDatabase()
 {
     const QString dbPath = m_projectPath + "/" + DB_FILENAME;
-    m_database = QSqlDatabase::addDatabase("QSQLITE", DB_CONNECTION_NAME);
+    m_database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
     m_database.setDatabaseName(dbPath);
 
+    // A GUI-thread statement gives up quickly rather than freeze the UI
+    // behind a long write on another connection
+    const QCoreApplication *app = QCoreApplication::instance();
+    const bool guiThread = app && QThread::currentThread() == app->thread();
+    m_database.setConnectOptions(DB_CONNECT_OPTIONS.arg(guiThread ? DB_GUI_BUSY_TIMEOUT_MS
+                                                                  : DB_BUSY_TIMEOUT_MS));
+
     if (!m_database.open()) {
         qWarning() << "Failed to open database:" << m_database.lastError().text();
         return false;
     }
 
+    // Write-ahead logging lets the UI connection read while a worker connection
+    // writes. It needs shared memory that network shares do not provide; SQLite
+    // then keeps the old mode, and the catalog falls back to a rollback journal.
+    QSqlQuery pragma(m_database);
+    const bool wal = pragma.exec("PRAGMA journal_mode=WAL") && pragma.next() &&
+                     pragma.value(0).toString().compare("wal", Qt::CaseInsensitive) == 0;
+    if (!wal) {
+        qWarning() << "WAL journal unavailable, using a rollback journal:" << m_projectPath;
+        pragma.finish();
+        if (!pragma.exec("PRAGMA journal_mode=DELETE")) {
+            qWarning() << "Failed to set rollback journal:" << pragma.lastError().text();
+        }
+    }
+
     return true;
 }
 
 bool ProjectManager::createTables()
 {
-    return createProjectFoldersTable() && createImagesTable() && createIndices();
+    return createProjectFoldersTable() && createImagesTable() &&
+           createProjectStateTable() && createDuplicateAnalysisTables() && createIndices();
 }
 
 void ProjectManager::migrateDatabase()
 {
     // Future: Handle database schema migrations
     // Check version and apply necessary migrations
+
+    // Tables added after the initial schema are created if missing
+    if (!createProjectStateTable()) {
+        qWarning() << "Failed to create project state table";
+    }
+    if (!createDuplicateIndex()) {
+        qWarning() << "Failed to create duplicate file index";
+    }
+    if (!createDuplicateAnalysisTables()) {
+        qWarning() << "Failed to create duplicate analysis tables";
+    }
 }
 
 // === Private Methods - File Operations ===
 
-QString ProjectManager::calculateFileHash(const QString &filePath) const
+QHash<QString, QString> ProjectManager::calculateFileHashes(const QStringList &filePaths) const
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return QString();
-    }
+    const QStringList hashes = m_batchReader.hashFiles(filePaths);
 
-    QCryptographicHash hash(QCryptographicHash::Md5);
-    hash.addData(file.readAll());
-    return hash.result().toHex();
+    QHash<QString, QString> result;
+    for (int i = 0; i < filePaths.size(); ++i) {
+        result.insert(filePaths.at(i), hashes.value(i));
+    }
+    return result;
 }
 
 void ProjectManager::scanFolder(const QString &folderPath, QStringList &foundFiles) const
@@ -350,7 +764,8 @@ void ProjectManager::scanFolder(const QString &folderPath, QStringList &foundFil
     }
 }
 
-ProjectManager::ImageRecord ProjectManager::createImageRecord(const QString &filePath) const
+ProjectManager::ImageRecord ProjectManager::createImageRecord(const QString &filePath,
+                                                              const ImageProbe::FileProbe &probe) const
 {
     ImageRecord record = {};
     record.filePath = filePath;
@@ -360,23 +775,76 @@ ProjectManager::ImageRecord ProjectManager::createImageRecord(const QString &fil
     record.fileSize = fileInfo.size();
     record.dateModified = fileInfo.lastModified();
     record.dateImported = QDateTime::currentDateTime();
-    record.fileHash = calculateFileHash(filePath);
+    record.fileHash = probe.fullHash;
     record.status = STATUS_OK;
     record.rating = DEFAULT_RATING;
     record.userStatus = DEFAULT_USER_STATUS;
     record.tags = DEFAULT_TAGS;
 
-    // Get image dimensions
-    const QImageReader reader(filePath);
-    if (reader.canRead()) {
-        const QSize size = reader.size();
-        record.width = size.width();
-        record.height = size.height();
+    if (probe.image.isValid()) {
+        record.width = probe.image.size.width();
+        record.height = probe.image.size.height();
     }
 
     return record;
 }
 
+void ProjectManager::ingestFiles(const QStringList &filePaths, const QHash<QString, QString> &knownHashes)
+{
+    QList<QFuture<bool>> pendingThumbnails;
+    const int maxInFlight = qMax(1, TaskScheduler::instance()->concurrencyLimit(
+                                        TaskScheduler::Priority::Background) *
+                                    INGEST_IN_FLIGHT_PER_THREAD);
+
+    for (const QString &filePath : filePaths) {
+        if (isSyncCanceled()) {
+            break;
+        }
+
+        const bool ingestThumbnail = m_thumbnailService &&
+                                     QFileInfo(filePath).size() <= INGEST_MAX_BUFFERED_SIZE;
+
+        // One streaming read: hash and metadata now, the buffer for the thumbnail;
+        // the body is read once, so it need not stay in the page cache. A hash
+        // the sync already computed is not read for again.
+        const QString knownHash = knownHashes.value(filePath);
+        ImageProbe::ProbeOptions options = ImageProbe::DropCache;
+        if (knownHash.isEmpty()) {
+            options |= ImageProbe::FullHash;
+        }
+        if (ingestThumbnail) {
+            options |= ImageProbe::KeepContents;
+        }
+
+        const ImageProbe::FileProbe probe = ImageProbe::probeFile(filePath, options);
+        ImageRecord record = createImageRecord(filePath, probe);
+        if (!knownHash.isEmpty()) {
+            record.fileHash = knownHash;
+        }
+        updateImageRecord(record);
+
+        if (!ingestThumbnail || probe.contents.isEmpty()) {
+            continue;
+        }
+
+        // Bound the memory held by buffers waiting to be decoded
+        while (pendingThumbnails.size() >= maxInFlight) {
+            pendingThumbnails.takeFirst().waitForFinished();
+        }
+
+        ThumbnailService *service = m_thumbnailService;
+        const QByteArray contents = probe.contents;
+        pendingThumbnails.append(TaskScheduler::instance()->run(TaskScheduler::Priority::Background,
+                                                                [service, filePath, contents]() {
+            return service->ingestThumbnail(filePath, contents);
+        }));
+    }
+
+    for (QFuture<bool> &pending : pendingThumbnails) {
+        pending.waitForFinished();
+    }
+}
+
 void ProjectManager::updateImageRecord(const ImageRecord &record)
 {
     if (!m_database.isOpen()) {
@@ -442,15 +910,22 @@ QStringList ProjectManager::findMissingFiles() const
     return missingFiles;
 }
 
-QStringList ProjectManager::findModifiedFiles() const
+QStringList ProjectManager::findModifiedFiles(QHash<QString, QString> &hashes) const
 {
     QStringList modifiedFiles;
     if (!m_database.isOpen()) {
         return modifiedFiles;
     }
 
-    QSqlQuery query(QString("SELECT file_path, file_hash, file_size, date_modified FROM %1 WHERE status = ?").arg(TABLE_IMAGES), m_database);
+    // Corrupted files are checked too: rewriting one is a legitimate change
+    QSqlQuery query(m_database);
+    query.prepare(QString("SELECT file_path, file_hash, file_size, date_modified FROM %1 WHERE status IN (?, ?)").arg(TABLE_IMAGES));
     query.addBindValue(STATUS_OK);
+    query.addBindValue(STATUS_CORRUPTED);
+    query.exec();
+
+    QStringList candidates;
+    QHash<QString, QString> storedHashes;
 
     while (query.next()) {
         const QString filePath = query.value(0).toString();
@@ -464,52 +939,87 @@ QStringList ProjectManager::findModifiedFiles() const
             // Quick check: if size or date changed, it's likely modified
             if (currentFile.size() != storedSize ||
                 currentFile.lastModified() != storedDate) {
-
-                // Verify with hash (slower but accurate)
-                const QString currentHash = calculateFileHash(filePath);
-                if (!currentHash.isEmpty() && currentHash != storedHash) {
-                    modifiedFiles.append(filePath);
-                }
+                candidates.append(filePath);
+                storedHashes.insert(filePath, storedHash);
             }
         }
     }
 
+    // Verify candidates with hash (slower but accurate), all reads batched
+    const QHash<QString, QString> currentHashes = calculateFileHashes(candidates);
+    for (const QString &filePath : std::as_const(candidates)) {
+        const QString currentHash = currentHashes.value(filePath);
+        if (!currentHash.isEmpty() && currentHash != storedHashes.value(filePath)) {
+            modifiedFiles.append(filePath);
+            hashes.insert(filePath, currentHash);
+        }
+    }
+
     return modifiedFiles;
 }
 
-QList<QPair<QString, QString>> ProjectManager::detectMovedFiles(const QStringList &missing, const QStringList &newFiles) const
+QList<QPair<QString, QString>> ProjectManager::detectMovedFiles(const QStringList &missing, const QStringList &newFiles,
+                                                                QHash<QString, QString> &hashes) const
 {
     QList<QPair<QString, QString>> movedFiles;
+    if (missing.isEmpty() || newFiles.isEmpty()) {
+        return movedFiles;
+    }
 
+    // Get hash, size and name of every missing file from database
+    struct MissingRecord {
+        QString filePath;
+        QString fileHash;
+        qint64 fileSize;
+        QString fileName;
+    };
+    QList<MissingRecord> missingRecords;
+    QSet<qint64> missingSizes;
     for (const QString &missingFile : missing) {
-        // Get hash of missing file from database
         QSqlQuery query(m_database);
         query.prepare(QString("SELECT file_hash, file_size, file_name FROM %1 WHERE file_path = ?").arg(TABLE_IMAGES));
         query.addBindValue(missingFile);
         query.exec();
 
         if (query.next()) {
-            const QString missingHash = query.value(0).toString();
-            const qint64 missingSize = query.value(1).toLongLong();
-            const QString missingName = query.value(2).toString();
-
-            // Look for matching file in new files
-            for (const QString &newFile : newFiles) {
-                const QString newHash = calculateFileHash(newFile);
-                const QFileInfo newFileInfo(newFile);
-
-                // Perfect match: same hash
-                if (!missingHash.isEmpty() && newHash == missingHash) {
-                    movedFiles.append(qMakePair(missingFile, newFile));
-                    break;
-                }
-
-                // Likely match: same name and size
-                if (newFileInfo.fileName() == missingName &&
-                    newFileInfo.size() == missingSize) {
-                    movedFiles.append(qMakePair(missingFile, newFile));
-                    break;
-                }
+            missingRecords.append({missingFile, query.value(0).toString(),
+                                   query.value(1).toLongLong(), query.value(2).toString()});
+            missingSizes.insert(missingRecords.last().fileSize);
+        }
+    }
+
+    // A moved file keeps its size: only new files of a missing file's size
+    // are hashed, each once; ingestion reuses the hashes of the others
+    QStringList candidates;
+    QHash<QString, qint64> newSizes;
+    for (const QString &newFile : newFiles) {
+        const qint64 size = QFileInfo(newFile).size();
+        newSizes.insert(newFile, size);
+        if (missingSizes.contains(size)) {
+            candidates.append(newFile);
+        }
+    }
+    const QHash<QString, QString> newHashes = calculateFileHashes(candidates);
+    for (auto it = newHashes.constBegin(); it != newHashes.constEnd(); ++it) {
+        if (!it.value().isEmpty()) {
+            hashes.insert(it.key(), it.value());
+        }
+    }
+
+    for (const MissingRecord &missingRecord : std::as_const(missingRecords)) {
+        // Look for matching file in new files
+        for (const QString &newFile : std::as_const(candidates)) {
+            // Perfect match: same hash
+            if (!missingRecord.fileHash.isEmpty() && newHashes.value(newFile) == missingRecord.fileHash) {
+                movedFiles.append(qMakePair(missingRecord.filePath, newFile));
+                break;
+            }
+
+            // Likely match: same name and size
+            if (QFileInfo(newFile).fileName() == missingRecord.fileName &&
+                newSizes.value(newFile) == missingRecord.fileSize) {
+                movedFiles.append(qMakePair(missingRecord.filePath, newFile));
+                break;
             }
         }
     }
@@ -526,6 +1036,10 @@ ProjectManager::SyncResult ProjectManager::performSynchronization()
     const QStringList projectFolders = getProjectFolders();
 
     for (int i = 0; i < projectFolders.size(); ++i) {
+        if (isSyncCanceled()) {
+            return result;
+        }
+
         const QString &folderPath = projectFolders.at(i);
         emit syncProgress(i, projectFolders.size(), folderPath);
         scanFolder(folderPath, allFiles);
@@ -536,13 +1050,19 @@ ProjectManager::SyncResult ProjectManager::performSynchronization()
     // Find changes
     result.newFiles = findNewFiles();
     result.missingFiles = findMissingFiles();
-    result.modifiedFiles = findModifiedFiles();
-    result.movedFiles = detectMovedFiles(result.missingFiles, result.newFiles);
+    // Files hashed while looking for changes are not hashed again on ingestion
+    QHash<QString, QString> knownHashes;
+    result.modifiedFiles = findModifiedFiles(knownHashes);
+    result.movedFiles = detectMovedFiles(result.missingFiles, result.newFiles, knownHashes);
+
+    if (isSyncCanceled()) {
+        return result;
+    }
 
     // Apply changes
-    processNewFiles(result.newFiles, result.movedFiles);
+    processNewFiles(result.newFiles, result.movedFiles, knownHashes);
     processMissingFiles(result.missingFiles, result.movedFiles);
-    processModifiedFiles(result.modifiedFiles);
+    processModifiedFiles(result.modifiedFiles, knownHashes);
     processMovedFiles(result.movedFiles);
 
     return result;
@@ -651,6 +1171,16 @@ bool ProjectManager::createImagesTable()
                           ")").arg(TABLE_IMAGES));
 }
 
+bool ProjectManager::createProjectStateTable()
+{
+    QSqlQuery query(m_database);
+    return query.exec(QString(
+                          "CREATE TABLE IF NOT EXISTS %1 ("
+                          "key TEXT PRIMARY KEY,"
+                          "value TEXT"
+                          ")").arg(TABLE_STATE));
+}
+
 bool ProjectManager::createIndices()
 {
     QSqlQuery query(m_database);
@@ -660,9 +1190,43 @@ bool ProjectManager::createIndices()
     success &= query.exec(QString("CREATE INDEX idx_images_hash ON %1(file_hash)").arg(TABLE_IMAGES));
     success &= query.exec(QString("CREATE INDEX idx_images_status ON %1(status)").arg(TABLE_IMAGES));
 
+    return success && createDuplicateIndex();
+}
+
+bool ProjectManager::createDuplicateAnalysisTables()
+{
+    QSqlQuery query(m_database);
+    bool success = query.exec(QString(
+                                  "CREATE TABLE IF NOT EXISTS %1 ("
+                                  "folder_path TEXT PRIMARY KEY,"
+                                  "fingerprint TEXT NOT NULL,"
+                                  "file_count INTEGER NOT NULL,"
+                                  "total_size INTEGER NOT NULL,"
+                                  "subfolders TEXT DEFAULT ''"
+                                  ")").arg(TABLE_DUPLICATE_FOLDERS));
+    success &= query.exec(QString(
+                              "CREATE TABLE IF NOT EXISTS %1 ("
+                              "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                              "folder1 TEXT NOT NULL,"
+                              "folder2 TEXT NOT NULL,"
+                              "match_type INTEGER NOT NULL,"
+                              "intersection INTEGER DEFAULT 0,"
+                              "union_size INTEGER DEFAULT 0"
+                              ")").arg(TABLE_DUPLICATE_PAIRS));
+    // Pair results are deleted one by one when a refresh changes them
+    success &= query.exec(QString("CREATE INDEX IF NOT EXISTS idx_duplicate_pairs_folders "
+                                  "ON %1(folder1, folder2)").arg(TABLE_DUPLICATE_PAIRS));
     return success;
 }
 
+bool ProjectManager::createDuplicateIndex()
+{
+    // Covers the duplicate grouping query, which then never touches the table
+    QSqlQuery query(m_database);
+    return query.exec(QString("CREATE INDEX IF NOT EXISTS idx_images_hash_size "
+                              "ON %1(file_hash, file_size, status)").arg(TABLE_IMAGES));
+}
+
 ProjectManager::ImageRecord ProjectManager::createImageRecordFromQuery(const QSqlQuery &query) const
 {
     ImageRecord record;
@@ -698,8 +1262,11 @@ void ProjectManager::bindImageRecordToQuery(QSqlQuery &query, const ImageRecord
     query.addBindValue(record.tags);
 }
 
-void ProjectManager::processNewFiles(const QStringList &newFiles, const QList<QPair<QString, QString>> &movedFiles)
+void ProjectManager::processNewFiles(const QStringList &newFiles, const QList<QPair<QString, QString>> &movedFiles,
+                                     const QHash<QString, QString> &knownHashes)
 {
+    QStringList filesToIngest;
+
     for (const QString &newFile : newFiles) {
         // Skip if this file is part of a move operation
         bool isMovedFile = false;
@@ -711,10 +1278,11 @@ void ProjectManager::processNewFiles(const QStringList &newFiles, const QList<QP
         }
 
         if (!isMovedFile) {
-            const ImageRecord record = createImageRecord(newFile);
-            updateImageRecord(record);
+            filesToIngest.append(newFile);
         }
     }
+
+    ingestFiles(filesToIngest, knownHashes);
 }
 
 void ProjectManager::processMissingFiles(const QStringList &missingFiles, const QList<QPair<QString, QString>> &movedFiles)
@@ -735,12 +1303,10 @@ void ProjectManager::processMissingFiles(const QStringList &missingFiles, const
     }
 }
 
-void ProjectManager::processModifiedFiles(const QStringList &modifiedFiles)
+void ProjectManager::processModifiedFiles(const QStringList &modifiedFiles,
+                                          const QHash<QString, QString> &knownHashes)
 {
-    for (const QString &modifiedFile : modifiedFiles) {
-        const ImageRecord record = createImageRecord(modifiedFile);
-        updateImageRecord(record);
-    }
+    ingestFiles(modifiedFiles, knownHashes);
 }
 
 void ProjectManager::processMovedFiles(const QList<QPair<QString, QString>> &movedFiles)
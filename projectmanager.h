@@ -6,6 +6,12 @@
 #include <QStringList>
 #include <QDateTime>
 #include <QHash>
+#include <QVariant>
+#include "imageprobe.h"
+#include "batchfilereader.h"
+#include <functional>
+
+class ThumbnailService;
 
 /**
  * @brief Manages photo projects with database storage and synchronization
@@ -16,6 +22,7 @@
  * - File synchronization and tracking
  * - Image metadata management
  * - Missing file detection
+ * - Single-pass ingestion (hash, metadata and thumbnail from one read)
  */
 class ProjectManager : public QObject
 {
@@ -35,7 +42,7 @@ public:
         QDateTime dateImported;      ///< Date added to project
         int width;                   ///< Image width in pixels
         int height;                  ///< Image height in pixels
-        QString status;              ///< File status: "ok", "missing", "modified", "conflict"
+        QString status;              ///< File status: "ok", "missing", "modified", "conflict", "corrupted"
 
         // User attributes
         QString userStatus;          ///< User status: "selected", "trash", "ok", etc.
@@ -54,7 +61,63 @@ public:
         int totalScanned;                                  ///< Total files scanned
     };
 
+    /**
+     * @brief Catalog files sharing one content hash and size
+     */
+    struct DuplicateFileGroup {
+        QString fileHash;            ///< MD5 hash shared by all copies
+        qint64 fileSize;             ///< Size of each copy in bytes
+        QList<ImageRecord> files;    ///< Verified copies, ordered by path
+        int distinctCopies = 0;      ///< Copies with their own data (hard links count once)
+    };
+
+    /**
+     * @brief One page of duplicate file groups
+     */
+    struct DuplicateFilePage {
+        QList<DuplicateFileGroup> groups;  ///< Groups with at least two verified copies
+        QString lastHash;                  ///< Paging key: hash of the last group examined
+        qint64 lastSize = 0;               ///< Paging key: size of the last group examined
+        bool exhausted = true;             ///< No groups remain after this page
+    };
+
+    /**
+     * @brief Folder as seen by the last duplicate folder analysis
+     */
+    struct DuplicateFolderRecord {
+        QString folderPath;          ///< Folder path
+        QString fingerprint;         ///< Hash of the folder's files (recursive) and analysis mode
+        int fileCount = 0;           ///< Image files in the folder and its subfolders
+        qint64 totalSize = 0;        ///< Total size of those files in bytes
+        QStringList subfolders;      ///< Subfolders (relative paths)
+    };
+
+    /**
+     * @brief Folder pair result of the last duplicate folder analysis
+     */
+    struct DuplicatePairRecord {
+        QString folder1;             ///< First folder
+        QString folder2;             ///< Second folder
+        int matchType = 0;           ///< DuplicateAnalyzer::DuplicateType value
+        int intersection = 0;        ///< Shared file signatures (partial matches)
+        int unionSize = 0;           ///< File signatures of both folders (partial matches)
+    };
+
+    /**
+     * @brief Returns true once a long-running operation should stop
+     */
+    using CancelCheck = std::function<bool()>;
+
     explicit ProjectManager(QObject *parent = nullptr);
+
+    /**
+     * @brief Create a project manager with its own database connection
+     *
+     * Every thread that opens the catalog needs a distinct connection name.
+     * @param connectionName Qt SQL connection name
+     * @param parent Parent object
+     */
+    explicit ProjectManager(const QString &connectionName, QObject *parent = nullptr);
     ~ProjectManager();
 
     // === Project Operations ===
@@ -74,6 +137,15 @@ public:
      */
     bool openProject(const QString &projectPath);
 
+    /**
+     * @brief Open a project another connection has already opened and migrated
+     *
+     * Skips schema migration, so it is only a connection open.
+     * @param projectPath Directory path containing project files
+     * @return True if project opened successfully
+     */
+    bool attachProject(const QString &projectPath);
+
     /**
      * @brief Close the current project
      * @return True if project closed successfully
@@ -147,6 +219,43 @@ public:
      */
     ImageRecord getImageRecord(const QString &filePath) const;
 
+    /**
+     * @brief Get images added or re-imported after a given record ID
+     *
+     * Modified files are re-inserted with a new ID, so walking IDs in
+     * ascending order visits both newly imported and modified rows.
+     * @param lastId Only records with a larger ID are returned
+     * @param limit Maximum number of records to return
+     * @return Image records ordered by ID
+     */
+    QList<ImageRecord> getImagesAfter(int lastId, int limit) const;
+
+    /**
+     * @brief Get images whose stored hash can be verified, after a given record ID
+     *
+     * Returns rows that are "ok" or already marked corrupted; missing,
+     * modified and conflicting rows have no trustworthy hash to check.
+     * @param lastId Only records with a larger ID are returned
+     * @param limit Maximum number of records to return
+     * @return Image records ordered by ID
+     */
+    QList<ImageRecord> getImagesToVerifyAfter(int lastId, int limit) const;
+
+    /**
+     * @brief Get a page of exact duplicate files from the catalog
+     *
+     * Groups come from the stored full-file hashes, grouped on the
+     * (file_hash, file_size) index: no file content is read. Each copy is
+     * verified against its size and modification date on disk; copies that
+     * changed since the last sync are left out, as are groups with fewer
+     * than two verified copies.
+     * @param afterHash lastHash of the previous page (empty for the first page)
+     * @param afterSize lastSize of the previous page
+     * @param limit Maximum number of catalog groups to examine
+     * @return Groups ordered by hash and size, with the key of the next page
+     */
+    DuplicateFilePage getDuplicateFiles(const QString &afterHash, qint64 afterSize, int limit) const;
+
     /**
      * @brief Update image status in database
      * @param filePath Path to image file
@@ -154,13 +263,101 @@ public:
      */
     void updateImageStatus(const QString &filePath, const QString &status);
 
+    /**
+     * @brief Record new modification dates of files, in one transaction
+     *
+     * Used after files were replaced in place (same contents, new inode),
+     * so the next sync does not report them as modified.
+     * @param modifiedDates File path -> modification date on disk
+     * @return True if all dates were committed
+     */
+    bool updateModifiedDates(const QHash<QString, QDateTime> &modifiedDates);
+
+    /**
+     * @brief Mark a file as failing or passing integrity verification
+     *
+     * A corrupted file keeps its stored hash, so the mark is cleared once a
+     * good copy is restored and verified again. Corrupted files are left
+     * out of duplicate file groups.
+     * @param filePath Path to image file
+     * @param corrupted True if the contents no longer match the stored hash
+     */
+    void setFileCorrupted(const QString &filePath, bool corrupted);
+
+    /**
+     * @brief Get the files marked corrupted by integrity verification
+     * @return File paths, sorted
+     */
+    QStringList getCorruptedFiles() const;
+
+    // === Project State ===
+
+    /**
+     * @brief Read a persisted project state value
+     * @param key State key
+     * @param defaultValue Value returned if key is not set
+     * @return Stored value or default
+     */
+    QVariant getProjectValue(const QString &key, const QVariant &defaultValue = QVariant()) const;
+
+    /**
+     * @brief Persist a project state value in the catalog
+     * @param key State key
+     * @param value Value to store
+     */
+    void setProjectValue(const QString &key, const QVariant &value);
+
+    // === Duplicate Analysis Results ===
+
+    /**
+     * @brief Get the folders of the last duplicate folder analysis
+     * @return Folder records
+     */
+    QList<DuplicateFolderRecord> getDuplicateFolders() const;
+
+    /**
+     * @brief Get the pair results of the last duplicate folder analysis
+     * @return Matching and candidate folder pairs
+     */
+    QList<DuplicatePairRecord> getDuplicatePairs() const;
+
+    /**
+     * @brief Store a duplicate folder analysis, in one transaction
+     *
+     * Only the folders and pair results that changed since the previous
+     * analysis are written.
+     * @param changedFolders New or changed folders
+     * @param removedFolders Folders no longer analyzed
+     * @param changedPairs New or changed pair results
+     * @param removedPairs Stored pair results to delete, as read
+     * @return True if committed
+     */
+    bool saveDuplicateAnalysis(const QList<DuplicateFolderRecord> &changedFolders,
+                               const QStringList &removedFolders,
+                               const QList<DuplicatePairRecord> &changedPairs,
+                               const QList<DuplicatePairRecord> &removedPairs);
+
+    // === Ingestion ===
+
+    /**
+     * @brief Attach the thumbnail service used during ingestion
+     *
+     * When set, new and modified files are read once: the same buffer feeds
+     * the content hash, the metadata probe and the thumbnail pyramid, which
+     * is decoded on worker threads while the next file is being read.
+     * @param thumbnailService Thumbnail service, or nullptr to disable
+     */
+    void setThumbnailService(ThumbnailService *thumbnailService);
+
     // === Synchronization ===
 
     /**
      * @brief Synchronize project with filesystem
+     * @param isCanceled Polled between folders and files; the catalog keeps
+     *                   what was applied before cancellation
      * @return Synchronization results
      */
-    SyncResult synchronizeProject();
+    SyncResult synchronizeProject(const CancelCheck &isCanceled = CancelCheck());
 
     /**
      * @brief Get count of missing files
@@ -215,6 +412,14 @@ signals:
 private:
     // === Database Operations ===
 
+    /**
+     * @brief Open an existing project's database
+     * @param projectPath Directory path containing project files
+     * @param migrate True to bring the schema up to date
+     * @return True if project opened successfully
+     */
+    bool openExistingProject(const QString &projectPath, bool migrate);
+
     /**
      * @brief Initialize database connection and schema
      * @return True if successful
@@ -235,11 +440,11 @@ private:
     // === File Operations ===
 
     /**
-     * @brief Calculate MD5 hash of file
-     * @param filePath Path to file
-     * @return MD5 hash string
+     * @brief Calculate MD5 hashes of many files with batched reads
+     * @param filePaths Files to hash
+     * @return File path -> MD5 hash string (empty for unreadable files)
      */
-    QString calculateFileHash(const QString &filePath) const;
+    QHash<QString, QString> calculateFileHashes(const QStringList &filePaths) const;
 
     /**
      * @brief Recursively scan folder for image files
@@ -251,9 +456,18 @@ private:
     /**
      * @brief Create image record from file
      * @param filePath Path to image file
+     * @param probe Result of probing the file with a full hash
      * @return Populated image record
      */
-    ImageRecord createImageRecord(const QString &filePath) const;
+    ImageRecord createImageRecord(const QString &filePath, const ImageProbe::FileProbe &probe) const;
+
+    /**
+     * @brief Add or refresh catalog records, reading each file once
+     * @param filePaths Files to ingest
+     * @param knownHashes Full hashes computed earlier in the sync, reused as is
+     */
+    void ingestFiles(const QStringList &filePaths,
+                     const QHash<QString, QString> &knownHashes = QHash<QString, QString>());
 
     /**
      * @brief Update image record in database
@@ -277,17 +491,22 @@ private:
 
     /**
      * @brief Find modified files based on hash comparison
+     * @param hashes Receives the full hash of every file hashed
      * @return List of modified file paths
      */
-    QStringList findModifiedFiles() const;
+    QStringList findModifiedFiles(QHash<QString, QString> &hashes) const;
 
     /**
      * @brief Detect moved files by comparing hashes
+     *
+     * Only new files with the size of a missing file are hashed.
      * @param missing List of missing files
      * @param newFiles List of new files
+     * @param hashes Receives the full hash of every file hashed
      * @return List of move pairs (old path, new path)
      */
-    QList<QPair<QString, QString>> detectMovedFiles(const QStringList &missing, const QStringList &newFiles) const;
+    QList<QPair<QString, QString>> detectMovedFiles(const QStringList &missing, const QStringList &newFiles,
+                                                    QHash<QString, QString> &hashes) const;
 
     // === Helper Methods ===
 
@@ -340,12 +559,30 @@ private:
      */
     bool createImagesTable();
 
+    /**
+     * @brief Create key/value project state table
+     * @return True if successful
+     */
+    bool createProjectStateTable();
+
     /**
      * @brief Create database indices for performance
      * @return True if successful
      */
     bool createIndices();
 
+    /**
+     * @brief Create the covering index used to group duplicate files
+     * @return True if successful
+     */
+    bool createDuplicateIndex();
+
+    /**
+     * @brief Create the duplicate folder analysis tables if missing
+     * @return True if successful
+     */
+    bool createDuplicateAnalysisTables();
+
     /**
      * @brief Create ImageRecord from database query result
      * @param query Query positioned on record
@@ -370,8 +607,10 @@ private:
      * @brief Process new files found during sync
      * @param newFiles List of new files
      * @param movedFiles List of moved files to exclude
+     * @param knownHashes Full hashes already computed by this sync
      */
-    void processNewFiles(const QStringList &newFiles, const QList<QPair<QString, QString>> &movedFiles);
+    void processNewFiles(const QStringList &newFiles, const QList<QPair<QString, QString>> &movedFiles,
+                         const QHash<QString, QString> &knownHashes);
 
     /**
      * @brief Process missing files found during sync
@@ -383,8 +622,9 @@ private:
     /**
      * @brief Process modified files found during sync
      * @param modifiedFiles List of modified files
+     * @param knownHashes Full hashes already computed by this sync
      */
-    void processModifiedFiles(const QStringList &modifiedFiles);
+    void processModifiedFiles(const QStringList &modifiedFiles, const QHash<QString, QString> &knownHashes);
 
     /**
      * @brief Process moved files found during sync
@@ -392,12 +632,25 @@ private:
      */
     void processMovedFiles(const QList<QPair<QString, QString>> &movedFiles);
 
+    /**
+     * @brief Check whether the running synchronization was canceled
+     * @return True if the caller asked to stop
+     */
+    bool isSyncCanceled() const { return m_syncCanceled && m_syncCanceled(); }
+
     // === Data Members ===
 
     QSqlDatabase m_database;              ///< Project database connection
+    QString m_connectionName;             ///< Qt SQL connection name
+    CancelCheck m_syncCanceled;           ///< Cancellation of the running sync
     QString m_projectPath;                ///< Path to project directory
     QString m_projectName;                ///< Project name
     QStringList m_supportedExtensions;    ///< Supported image file extensions
+
+    // === Ingestion ===
+
+    ThumbnailService *m_thumbnailService; ///< Receives thumbnails during ingestion
+    mutable BatchFileReader m_batchReader; ///< Batched full-file hashing
 };
 
 #endif // PROJECTMANAGER_H
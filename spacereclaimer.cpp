@@ -0,0 +1,285 @@
+#include "spacereclaimer.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+// === Constants ===
+namespace {
+const QString JOURNAL_FILENAME = "reclaim.journal";
+const QString TEMP_SUFFIX = ".pmreclaim";
+const QString JOURNAL_BEGIN = "BEGIN";
+const QString JOURNAL_DONE = "DONE";
+
+constexpr qint64 COMPARE_BLOCK_SIZE = 1024 * 1024;
+
+#ifdef Q_OS_LINUX
+bool statFile(const QString &path, struct stat &fileStat)
+{
+    return ::stat(QFile::encodeName(path).constData(), &fileStat) == 0;
+}
+
+void syncDirectory(const QString &path)
+{
+    const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+#endif
+}
+
+// === Constructor ===
+
+SpaceReclaimer::SpaceReclaimer(const QString &projectPath)
+    : m_journalPath(QDir(projectPath).filePath(JOURNAL_FILENAME))
+{
+}
+
+// === Planning ===
+
+SpaceReclaimer::Plan SpaceReclaimer::plan(const QList<ProjectManager::DuplicateFileGroup> &groups,
+                                          Method method) const
+{
+    Plan plan;
+    plan.method = method;
+
+#ifdef Q_OS_LINUX
+    for (const auto &group : groups) {
+        if (group.files.size() < 2 || group.fileSize <= 0) {
+            continue;
+        }
+
+        const QString keepPath = group.files.first().filePath;
+        struct stat keepStat;
+        if (!statFile(keepPath, keepStat) || keepStat.st_size != group.fileSize) {
+            plan.skipped.append(QString("%1: kept file changed since the last sync").arg(keepPath));
+            continue;
+        }
+
+        for (int i = 1; i < group.files.size(); ++i) {
+            const QString copyPath = group.files.at(i).filePath;
+            struct stat copyStat;
+            if (!statFile(copyPath, copyStat) || copyStat.st_size != group.fileSize) {
+                plan.skipped.append(QString("%1: changed since the last sync").arg(copyPath));
+            } else if (copyStat.st_dev != keepStat.st_dev) {
+                plan.skipped.append(QString("%1: on another volume than %2").arg(copyPath, keepPath));
+            } else if (copyStat.st_ino == keepStat.st_ino) {
+                plan.skipped.append(QString("%1: already linked").arg(copyPath));
+            } else {
+                plan.operations.append({keepPath, copyPath, group.fileSize});
+                plan.reclaimableBytes += group.fileSize;
+            }
+        }
+    }
+#else
+    for (const auto &group : groups) {
+        for (int i = 1; i < group.files.size(); ++i) {
+            plan.skipped.append(QString("%1: not supported on this platform").arg(group.files.at(i).filePath));
+        }
+    }
+    Q_UNUSED(method);
+#endif
+
+    return plan;
+}
+
+// === Execution ===
+
+SpaceReclaimer::Result SpaceReclaimer::execute(const Plan &plan, const CancelCheck &isCanceled)
+{
+    Result result;
+
+    for (const Operation &operation : plan.operations) {
+        if (isCanceled && isCanceled()) {
+            result.canceled = true;
+            break;
+        }
+
+        QString error;
+        if (!replaceCopy(operation, plan.method, error)) {
+            result.errors.append(QString("%1: %2").arg(operation.copyPath, error));
+            continue;
+        }
+
+        result.replaced++;
+        result.reclaimedBytes += operation.size;
+        result.modifiedDates.insert(operation.copyPath, QFileInfo(operation.copyPath).lastModified());
+    }
+
+    // Every temporary file is renamed or removed by now
+    QFile::remove(m_journalPath);
+
+    qDebug() << "Space reclamation: replaced" << result.replaced << "copies,"
+             << result.reclaimedBytes << "bytes," << result.errors.size() << "errors";
+    return result;
+}
+
+int SpaceReclaimer::recoverJournal() const
+{
+    QFile journal(m_journalPath);
+    if (!journal.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return 0;
+    }
+
+    // A temporary file still present was never renamed over its copy, which
+    // therefore still holds its original contents
+    int removed = 0;
+    while (!journal.atEnd()) {
+        const QStringList fields = QString::fromUtf8(journal.readLine()).trimmed().split('\t');
+        if (fields.size() == 2 && fields.at(0) == JOURNAL_BEGIN && QFile::remove(fields.at(1))) {
+            removed++;
+        }
+    }
+    journal.close();
+    journal.remove();
+
+    if (removed > 0) {
+        qWarning() << "Removed" << removed << "temporary files of an interrupted space reclamation";
+    }
+    return removed;
+}
+
+// === Private Methods ===
+
+bool SpaceReclaimer::replaceCopy(const Operation &operation, Method method, QString &error)
+{
+#ifdef Q_OS_LINUX
+    struct stat keepStat;
+    struct stat copyStat;
+    if (!statFile(operation.keepPath, keepStat) || !statFile(operation.copyPath, copyStat)) {
+        error = "file not found";
+        return false;
+    }
+    if (keepStat.st_dev != copyStat.st_dev || keepStat.st_ino == copyStat.st_ino) {
+        error = "no longer a separate copy on the same volume";
+        return false;
+    }
+    if (!filesIdentical(operation.keepPath, operation.copyPath)) {
+        error = "contents differ";
+        return false;
+    }
+
+    const QFileInfo copyInfo(operation.copyPath);
+    const QString tempPath = copyInfo.dir().filePath("." + copyInfo.fileName() + TEMP_SUFFIX);
+    const QByteArray keepName = QFile::encodeName(operation.keepPath);
+    const QByteArray copyName = QFile::encodeName(operation.copyPath);
+    const QByteArray tempName = QFile::encodeName(tempPath);
+
+    if (!appendJournal(JOURNAL_BEGIN + '\t' + tempPath)) {
+        error = "cannot write the journal";
+        return false;
+    }
+
+    bool cloned = false;
+    int savedErrno = 0;
+    QString failedStep;
+    if (method == Method::Reflink) {
+#ifdef FICLONE
+        const int source = ::open(keepName.constData(), O_RDONLY | O_CLOEXEC);
+        const int target = source < 0 ? -1 : ::open(tempName.constData(),
+                                                    O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                                                    copyStat.st_mode & 07777);
+        if (target < 0 || ::ioctl(target, FICLONE, source) != 0) {
+            savedErrno = errno;
+        } else {
+            // The clone takes the place of the copy, so it must keep the
+            // copy's owner, mode and dates; a clone that cannot is discarded
+            const struct timespec times[2] = {copyStat.st_atim, copyStat.st_mtim};
+            if (::fchown(target, copyStat.st_uid, copyStat.st_gid) != 0) {
+                failedStep = "keep the owner";
+            } else if (::fchmod(target, copyStat.st_mode & 07777) != 0) {
+                failedStep = "keep the permissions";
+            } else if (::futimens(target, times) != 0) {
+                failedStep = "keep the dates";
+            } else if (::fsync(target) != 0) {
+                failedStep = "write the clone";
+            }
+            savedErrno = errno;
+            cloned = failedStep.isEmpty();
+        }
+        if (target >= 0) {
+            ::close(target);
+        }
+        if (source >= 0) {
+            ::close(source);
+        }
+#else
+        savedErrno = EOPNOTSUPP;
+#endif
+    } else {
+        cloned = ::link(keepName.constData(), tempName.constData()) == 0;
+        savedErrno = errno;
+    }
+
+    if (cloned && ::rename(tempName.constData(), copyName.constData()) != 0) {
+        cloned = false;
+        savedErrno = errno;
+    }
+
+    if (!cloned) {
+        ::unlink(tempName.constData());
+        if (!failedStep.isEmpty()) {
+            error = QString("cannot %1: %2").arg(failedStep, QString::fromLocal8Bit(std::strerror(savedErrno)));
+        } else if (savedErrno == EOPNOTSUPP || savedErrno == EXDEV || savedErrno == EINVAL) {
+            error = QString("the file system does not support %1")
+                        .arg(method == Method::Reflink ? "reflinks" : "hard links");
+        } else {
+            error = QString::fromLocal8Bit(std::strerror(savedErrno));
+        }
+    }
+
+    syncDirectory(copyInfo.absolutePath());
+    appendJournal(JOURNAL_DONE + '\t' + tempPath);
+    return cloned;
+#else
+    Q_UNUSED(operation);
+    Q_UNUSED(method);
+    error = "not supported on this platform";
+    return false;
+#endif
+}
+
+bool SpaceReclaimer::filesIdentical(const QString &first, const QString &second)
+{
+    QFile firstFile(first);
+    QFile secondFile(second);
+    if (!firstFile.open(QIODevice::ReadOnly) || !secondFile.open(QIODevice::ReadOnly) ||
+        firstFile.size() != secondFile.size()) {
+        return false;
+    }
+
+    while (!firstFile.atEnd()) {
+        const QByteArray firstBlock = firstFile.read(COMPARE_BLOCK_SIZE);
+        const QByteArray secondBlock = secondFile.read(COMPARE_BLOCK_SIZE);
+        if (firstBlock.isEmpty() || firstBlock != secondBlock) {
+            return false;
+        }
+    }
+    return secondFile.atEnd();
+}
+
+bool SpaceReclaimer::appendJournal(const QString &line)
+{
+    QFile journal(m_journalPath);
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        return false;
+    }
+
+    const bool written = journal.write((line + '\n').toUtf8()) > 0 && journal.flush();
+#ifdef Q_OS_LINUX
+    ::fsync(journal.handle());
+#endif
+    return written;
+}
@@ -0,0 +1,135 @@
+#ifndef SPACERECLAIMER_H
+#define SPACERECLAIMER_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include "projectmanager.h"
+
+/**
+ * @brief Frees the space of duplicate files without moving or changing them
+ *
+ * Each redundant copy of a duplicate group is replaced, at its own path,
+ * by a clone of the kept copy:
+ * - Reflink: a copy-on-write clone (FICLONE on btrfs, XFS, bcachefs...);
+ *   the files stay independent and keep their own permissions and dates
+ * - Hardlink: the path becomes another name of the kept file; editing one
+ *   changes both, so this is an explicit choice
+ *
+ * Use in two steps: plan() is a dry run that only stats files, execute()
+ * applies a plan. Before replacing, every copy is compared byte for byte
+ * with the kept file. The clone is built under a temporary name next to
+ * the copy and renamed over it, so a copy is always either the original or
+ * a complete clone. A journal in the project directory records the
+ * temporary files; recoverJournal() removes leftovers of an interrupted run
+ * and is called once when the project is opened, before any execute().
+ *
+ * Only supported on Linux; elsewhere plans contain nothing to do.
+ */
+class SpaceReclaimer
+{
+public:
+    using CancelCheck = ProjectManager::CancelCheck;
+
+    /**
+     * @brief How redundant copies are replaced
+     */
+    enum class Method {
+        Reflink,                     ///< Copy-on-write clone of the kept file
+        Hardlink                     ///< Hard link to the kept file
+    };
+
+    /**
+     * @brief One copy to replace
+     */
+    struct Operation {
+        QString keepPath;            ///< File that is kept
+        QString copyPath;            ///< Redundant copy replaced by a clone
+        qint64 size;                 ///< Bytes freed
+    };
+
+    /**
+     * @brief Dry run result
+     */
+    struct Plan {
+        Method method = Method::Reflink;   ///< Replacement method
+        QList<Operation> operations;       ///< Copies to replace
+        qint64 reclaimableBytes = 0;       ///< Sum of operation sizes
+        QStringList skipped;               ///< "path: reason" for copies left alone
+    };
+
+    /**
+     * @brief Outcome of executing a plan
+     */
+    struct Result {
+        int replaced = 0;                          ///< Copies replaced
+        qint64 reclaimedBytes = 0;                 ///< Bytes freed
+        QStringList errors;                        ///< "path: reason" for failed copies
+        QHash<QString, QDateTime> modifiedDates;   ///< New modification dates for the catalog
+        bool canceled = false;                     ///< Stopped before the end of the plan
+    };
+
+    /**
+     * @brief Create a reclaimer journaling into a project directory
+     * @param projectPath Project directory holding the journal
+     */
+    explicit SpaceReclaimer(const QString &projectPath);
+
+    /**
+     * @brief Plan the replacement of all but the first copy of each group
+     *
+     * Stats files only: copies on another volume than the kept file,
+     * already sharing its inode, or no longer matching the catalog size
+     * are skipped.
+     * @param groups Duplicate groups (kept copy first)
+     * @param method Replacement method
+     * @return Plan to review and execute
+     */
+    Plan plan(const QList<ProjectManager::DuplicateFileGroup> &groups, Method method) const;
+
+    /**
+     * @brief Replace the copies of a plan
+     * @param plan Plan from plan()
+     * @param isCanceled Polled between copies
+     * @return Outcome; modifiedDates must be written to the catalog
+     */
+    Result execute(const Plan &plan, const CancelCheck &isCanceled = CancelCheck());
+
+    /**
+     * @brief Remove temporary files left by an interrupted run
+     * @return Number of temporary files removed
+     */
+    int recoverJournal() const;
+
+private:
+    /**
+     * @brief Replace one copy by a clone of the kept file
+     * @param operation Copy to replace
+     * @param method Replacement method
+     * @param error Set to the reason on failure
+     * @return True if the copy was replaced
+     */
+    bool replaceCopy(const Operation &operation, Method method, QString &error);
+
+    /**
+     * @brief Compare two files byte for byte
+     * @param first First file
+     * @param second Second file
+     * @return True if both files could be read and are identical
+     */
+    static bool filesIdentical(const QString &first, const QString &second);
+
+    /**
+     * @brief Append a line to the journal and flush it to disk
+     * @param line Journal line
+     * @return True if the line was written
+     */
+    bool appendJournal(const QString &line);
+
+    QString m_journalPath;           ///< Journal of temporary files
+};
+
+#endif // SPACERECLAIMER_H
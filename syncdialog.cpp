@@ -1,4 +1,5 @@
 #include "syncdialog.h"
+#include "asyncprojectmanager.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -37,6 +38,12 @@ const QString MSG_INITIAL = "Click 'Synchronize' to scan for changes...";
 const QString MSG_SUCCESS = "✓ Project is up to date! Scanned %1 files.";
 const QString MSG_CHANGES = "Found changes: %1";
 const QString MSG_SCANNING = "Scanning: %1";
+const QString MSG_CANCELING = "Canceling...";
+const QString MSG_CANCELED = "Synchronization canceled. Changes found so far were applied.";
+
+// Button labels
+const QString BUTTON_SYNCHRONIZE = "Synchronize";
+const QString BUTTON_CANCEL = "Cancel";
 
 // Tab titles
 const QString TAB_NEW_FILES = "New Files";
@@ -54,9 +61,9 @@ const QString IMAGE_FILTER = "Image Files (*.jpg *.jpeg *.png *.bmp *.gif *.tiff
 
 // === Constructor ===
 
-SyncDialog::SyncDialog(ProjectManager *projectManager, QWidget *parent)
+SyncDialog::SyncDialog(AsyncProjectManager *asyncProjectManager, QWidget *parent)
     : QDialog(parent)
-    , m_projectManager(projectManager)
+    , m_asyncProjectManager(asyncProjectManager)
 {
     setupUI();
     connectSignals();
@@ -65,6 +72,12 @@ SyncDialog::SyncDialog(ProjectManager *projectManager, QWidget *parent)
     resize(DEFAULT_WIDTH, DEFAULT_HEIGHT);
 }
 
+SyncDialog::~SyncDialog()
+{
+    // Closing the dialog stops a sync nobody would see the results of
+    m_syncWatcher.cancel();
+}
+
 // === Public Methods ===
 
 void SyncDialog::showSyncResults(const ProjectManager::SyncResult &result)
@@ -79,33 +92,49 @@ void SyncDialog::showSyncResults(const ProjectManager::SyncResult &result)
 
 // === Private Slots - Synchronization Events ===
 
-void SyncDialog::onSyncProgress(int current, int total, const QString &currentFile)
+void SyncDialog::onSyncProgress()
 {
+    if (m_syncWatcher.isCanceled()) {
+        return;
+    }
+
     m_progressBar->setVisible(true);
-    m_progressBar->setMaximum(total);
-    m_progressBar->setValue(current);
+    m_progressBar->setMaximum(m_syncWatcher.progressMaximum());
+    m_progressBar->setValue(m_syncWatcher.progressValue());
 
-    const QFileInfo fileInfo(currentFile);
+    const QFileInfo fileInfo(m_syncWatcher.progressText());
     m_statusLabel->setText(MSG_SCANNING.arg(fileInfo.fileName()));
-
-    QApplication::processEvents(); // Keep UI responsive
 }
 
-void SyncDialog::onSyncCompleted(const ProjectManager::SyncResult &result)
+void SyncDialog::onSyncFinished()
 {
     m_progressBar->setVisible(false);
     m_statusLabel->clear();
+    m_syncButton->setText(BUTTON_SYNCHRONIZE);
     m_syncButton->setEnabled(true);
 
-    showSyncResults(result);
+    if (m_syncWatcher.isCanceled() || m_syncWatcher.future().resultCount() == 0) {
+        m_summaryLabel->setText(MSG_CANCELED);
+        m_summaryLabel->setStyleSheet(STYLE_SUMMARY_NORMAL);
+        return;
+    }
+
+    showSyncResults(m_syncWatcher.result());
 }
 
 // === Private Slots - User Actions ===
 
 void SyncDialog::startSynchronization()
 {
-    m_syncButton->setEnabled(false);
-    m_projectManager->synchronizeProject();
+    if (m_syncWatcher.isRunning()) {
+        m_syncWatcher.cancel();
+        m_syncButton->setEnabled(false);
+        m_statusLabel->setText(MSG_CANCELING);
+        return;
+    }
+
+    m_syncButton->setText(BUTTON_CANCEL);
+    m_syncWatcher.setFuture(m_asyncProjectManager->synchronizeProject());
 }
 
 void SyncDialog::acceptAllMoves()
@@ -234,7 +263,7 @@ void SyncDialog::createButtonsSection(QVBoxLayout *mainLayout)
     QHBoxLayout *buttonLayout = new QHBoxLayout;
     buttonLayout->setSpacing(BUTTON_SPACING);
 
-    m_syncButton = new QPushButton("Synchronize");
+    m_syncButton = new QPushButton(BUTTON_SYNCHRONIZE);
     m_syncButton->setStyleSheet(STYLE_BUTTON_ACCEPT);
 
     m_closeButton = new QPushButton("Close");
@@ -248,11 +277,13 @@ void SyncDialog::createButtonsSection(QVBoxLayout *mainLayout)
 
 void SyncDialog::connectSignals()
 {
-    // Project manager signals
-    connect(m_projectManager, &ProjectManager::syncProgress,
+    // Synchronization signals
+    connect(&m_syncWatcher, &QFutureWatcherBase::progressValueChanged,
+            this, &SyncDialog::onSyncProgress);
+    connect(&m_syncWatcher, &QFutureWatcherBase::progressTextChanged,
             this, &SyncDialog::onSyncProgress);
-    connect(m_projectManager, &ProjectManager::syncCompleted,
-            this, &SyncDialog::onSyncCompleted);
+    connect(&m_syncWatcher, &QFutureWatcherBase::finished,
+            this, &SyncDialog::onSyncFinished);
 
     // Button signals
     connect(m_syncButton, &QPushButton::clicked, this, &SyncDialog::startSynchronization);
@@ -7,8 +7,11 @@
 #include <QPushButton>
 #include <QProgressBar>
 #include <QTabWidget>
+#include <QFutureWatcher>
 #include "projectmanager.h"
 
+class AsyncProjectManager;
+
 // Forward declarations
 class QVBoxLayout;
 
@@ -26,7 +29,8 @@ class SyncDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit SyncDialog(ProjectManager *projectManager, QWidget *parent = nullptr);
+    explicit SyncDialog(AsyncProjectManager *asyncProjectManager, QWidget *parent = nullptr);
+    ~SyncDialog();
 
     /**
      * @brief Display synchronization results
@@ -38,23 +42,19 @@ private slots:
     // === Synchronization Events ===
 
     /**
-     * @brief Handle sync progress updates
-     * @param current Current progress count
-     * @param total Total items to process
-     * @param currentFile Currently processing file
+     * @brief Show the progress reported by the running sync
      */
-    void onSyncProgress(int current, int total, const QString &currentFile);
+    void onSyncProgress();
 
     /**
-     * @brief Handle sync completion
-     * @param result Synchronization results
+     * @brief Handle sync completion or cancellation
      */
-    void onSyncCompleted(const ProjectManager::SyncResult &result);
+    void onSyncFinished();
 
     // === User Actions ===
 
     /**
-     * @brief Start synchronization process
+     * @brief Start synchronization, or cancel it while it runs
      */
     void startSynchronization();
 
@@ -221,7 +221,8 @@ private:
 
     // === Data Members ===
 
-    ProjectManager *m_projectManager;                ///< Project manager reference
+    AsyncProjectManager *m_asyncProjectManager;     ///< Runs the sync off the GUI thread
+    QFutureWatcher<ProjectManager::SyncResult> m_syncWatcher; ///< Running sync
 
     // === UI Components - Main Layout ===
 
@@ -0,0 +1,216 @@
+#include "taskscheduler.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// === Constants ===
+namespace {
+constexpr int MIN_WORKERS = 2;
+constexpr int RESERVED_FOREGROUND_WORKERS = 1;  // Never taken by Background/Maintenance
+
+#ifdef Q_OS_LINUX
+// From linux/ioprio.h (not always shipped with libc headers)
+constexpr int LINUX_IOPRIO_WHO_PROCESS = 1;
+constexpr int LINUX_IOPRIO_CLASS_BE = 2;
+constexpr int LINUX_IOPRIO_CLASS_IDLE = 3;
+constexpr int LINUX_IOPRIO_CLASS_SHIFT = 13;
+constexpr int LINUX_IOPRIO_BE_NORMAL = 4;
+constexpr int LINUX_IOPRIO_BE_LOWEST = 7;
+#endif
+
+int classIndex(TaskScheduler::Priority priority)
+{
+    return static_cast<int>(priority);
+}
+}
+
+// === Constructor & Destructor ===
+
+TaskScheduler *TaskScheduler::instance()
+{
+    static TaskScheduler scheduler;
+    return &scheduler;
+}
+
+TaskScheduler::TaskScheduler()
+    : m_workerCount(qMax(MIN_WORKERS, QThread::idealThreadCount()))
+    , m_stopping(false)
+{
+    for (int i = 0; i < PRIORITY_COUNT; ++i) {
+        m_running[i] = 0;
+    }
+
+    m_limits[classIndex(Priority::Interactive)] = m_workerCount;
+    m_limits[classIndex(Priority::VisiblePrefetch)] = qMax(1, m_workerCount / 2);
+    m_limits[classIndex(Priority::Background)] = m_workerCount - RESERVED_FOREGROUND_WORKERS;
+    m_limits[classIndex(Priority::Maintenance)] = 1;
+
+    startWorkers();
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    shutdown();
+}
+
+// === Submission ===
+
+void TaskScheduler::submit(Priority priority, std::function<void()> task)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stopping) {
+        return; // Dropping the task cancels any future attached to it
+    }
+
+    m_queues[classIndex(priority)].enqueue(std::move(task));
+    m_taskAvailable.wakeOne();
+}
+
+// === Control ===
+
+void TaskScheduler::shutdown()
+{
+    QList<std::function<void()>> dropped;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_stopping) {
+            return;
+        }
+        m_stopping = true;
+
+        for (QQueue<std::function<void()>> &queue : m_queues) {
+            dropped.append(queue);
+            queue.clear();
+        }
+        m_taskAvailable.wakeAll();
+    }
+
+    // Destroy dropped tasks outside the lock (their futures get canceled)
+    dropped.clear();
+
+    for (QThread *worker : std::as_const(m_workers)) {
+        worker->wait();
+        delete worker;
+    }
+    m_workers.clear();
+}
+
+void TaskScheduler::setConcurrencyLimit(Priority priority, int limit)
+{
+    QMutexLocker locker(&m_mutex);
+    m_limits[classIndex(priority)] = qMax(1, limit);
+    m_taskAvailable.wakeAll();
+}
+
+// === Information ===
+
+int TaskScheduler::concurrencyLimit(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_limits[classIndex(priority)];
+}
+
+int TaskScheduler::pendingCount(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_queues[classIndex(priority)].size();
+}
+
+// === Private Methods ===
+
+void TaskScheduler::startWorkers()
+{
+    for (int i = 0; i < m_workerCount; ++i) {
+        QThread *worker = QThread::create([this]() { workerLoop(); });
+        worker->setObjectName(QString("TaskScheduler-%1").arg(i));
+        m_workers.append(worker);
+        worker->start();
+    }
+
+    qDebug() << "Task scheduler started with" << m_workerCount << "workers";
+}
+
+void TaskScheduler::workerLoop()
+{
+    int appliedClass = -1;
+
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping) {
+        const int taskClass = nextRunnableClass();
+        if (taskClass < 0) {
+            m_taskAvailable.wait(&m_mutex);
+            continue;
+        }
+
+        std::function<void()> task = m_queues[taskClass].dequeue();
+        m_running[taskClass]++;
+        locker.unlock();
+
+        if (taskClass != appliedClass) {
+            applyIoPriority(static_cast<Priority>(taskClass));
+            appliedClass = taskClass;
+        }
+
+        task();
+        task = nullptr; // Release captured state before taking the lock
+
+        locker.relock();
+        m_running[taskClass]--;
+
+        // A slot freed in a capped class may let another idle worker proceed
+        if (!m_queues[taskClass].isEmpty()) {
+            m_taskAvailable.wakeOne();
+        }
+    }
+}
+
+int TaskScheduler::nextRunnableClass() const
+{
+    const int backgroundRunning = m_running[classIndex(Priority::Background)] +
+                                  m_running[classIndex(Priority::Maintenance)];
+    const int backgroundCapacity = m_workerCount - RESERVED_FOREGROUND_WORKERS;
+
+    for (int i = 0; i < PRIORITY_COUNT; ++i) {
+        if (m_queues[i].isEmpty() || m_running[i] >= m_limits[i]) {
+            continue;
+        }
+
+        if (i >= classIndex(Priority::Background) && backgroundRunning >= backgroundCapacity) {
+            continue;
+        }
+
+        return i;
+    }
+
+    return -1;
+}
+
+void TaskScheduler::applyIoPriority(Priority priority)
+{
+#ifdef Q_OS_LINUX
+    int ioPriority = (LINUX_IOPRIO_CLASS_BE << LINUX_IOPRIO_CLASS_SHIFT) | LINUX_IOPRIO_BE_NORMAL;
+    switch (priority) {
+    case Priority::Interactive:
+    case Priority::VisiblePrefetch:
+        break;
+    case Priority::Background:
+        ioPriority = (LINUX_IOPRIO_CLASS_BE << LINUX_IOPRIO_CLASS_SHIFT) | LINUX_IOPRIO_BE_LOWEST;
+        break;
+    case Priority::Maintenance:
+        ioPriority = LINUX_IOPRIO_CLASS_IDLE << LINUX_IOPRIO_CLASS_SHIFT;
+        break;
+    }
+
+    // Who 0 with IOPRIO_WHO_PROCESS is the calling thread on Linux
+    if (syscall(SYS_ioprio_set, LINUX_IOPRIO_WHO_PROCESS, 0, ioPriority) != 0) {
+        qWarning() << "Failed to set I/O priority for task class" << static_cast<int>(priority);
+    }
+#else
+    Q_UNUSED(priority);
+#endif
+}
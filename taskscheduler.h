@@ -0,0 +1,178 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+#include <QPromise>
+#include <QQueue>
+#include <QWaitCondition>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+class QThread;
+
+/**
+ * @brief Process-wide prioritized worker pool
+ *
+ * Arbitrates cores and disks between everything that runs off the GUI
+ * thread. Tasks are queued per priority class; whenever a worker finishes a
+ * task it takes the next one from the most urgent class that is below its
+ * concurrency cap, so long-running background work yields to interactive
+ * requests at every task boundary:
+ * - Interactive: thumbnails for cells on screen
+ * - VisiblePrefetch: thumbnails just outside the viewport
+ * - Background: sync hashing, ingest decoding, fingerprinting, warming
+ * - Maintenance: cache eviction and other housekeeping
+ *
+ * Background and Maintenance together never occupy the last worker, which
+ * stays free for Interactive and VisiblePrefetch tasks. On Linux each task
+ * runs with the I/O priority of its class (best-effort for the foreground
+ * classes, lowest best-effort for Background, idle for Maintenance).
+ * Thread nice values are left alone: an unprivileged thread could not
+ * raise its CPU priority again for the next interactive task.
+ */
+class TaskScheduler
+{
+public:
+    /**
+     * @brief Priority classes, most urgent first
+     */
+    enum class Priority {
+        Interactive,                 ///< Visible result the user is waiting for
+        VisiblePrefetch,             ///< Likely needed in the next moments
+        Background,                  ///< Bulk work the user started
+        Maintenance                  ///< Housekeeping nobody waits for
+    };
+
+    /**
+     * @brief Get the scheduler instance
+     * @return Process-wide scheduler (workers start on first use)
+     */
+    static TaskScheduler *instance();
+
+    // === Submission ===
+
+    /**
+     * @brief Queue a task
+     * @param priority Priority class
+     * @param task Work to run on a worker thread
+     */
+    void submit(Priority priority, std::function<void()> task);
+
+    /**
+     * @brief Queue a task and get a future for its result
+     * @param priority Priority class
+     * @param function Callable to run on a worker thread
+     * @return Future finished when the task ran (canceled if it was dropped)
+     */
+    template <typename Function>
+    auto run(Priority priority, Function function) -> QFuture<std::invoke_result_t<Function>>;
+
+    // === Control ===
+
+    /**
+     * @brief Drop queued tasks and wait for running ones
+     *
+     * Called before the services the tasks use are destroyed. Tasks submitted
+     * afterwards are dropped.
+     */
+    void shutdown();
+
+    /**
+     * @brief Set the number of workers a class may occupy at once
+     * @param priority Priority class
+     * @param limit Maximum concurrent tasks (at least 1)
+     */
+    void setConcurrencyLimit(Priority priority, int limit);
+
+    // === Information ===
+
+    /**
+     * @brief Get the number of workers a class may occupy at once
+     * @param priority Priority class
+     * @return Concurrency limit
+     */
+    int concurrencyLimit(Priority priority) const;
+
+    /**
+     * @brief Get the number of tasks waiting in a class
+     * @param priority Priority class
+     * @return Queued task count
+     */
+    int pendingCount(Priority priority) const;
+
+    /**
+     * @brief Get the number of worker threads
+     * @return Worker count
+     */
+    int workerCount() const { return m_workerCount; }
+
+private:
+    TaskScheduler();
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    /**
+     * @brief Start the worker threads
+     */
+    void startWorkers();
+
+    /**
+     * @brief Body of each worker thread
+     */
+    void workerLoop();
+
+    /**
+     * @brief Pick the class the next task is taken from (caller holds the lock)
+     * @return Class index, -1 if nothing may run now
+     */
+    int nextRunnableClass() const;
+
+    /**
+     * @brief Apply the I/O priority of a class to the calling thread
+     * @param priority Priority class
+     */
+    static void applyIoPriority(Priority priority);
+
+    static constexpr int PRIORITY_COUNT = 4;
+
+    mutable QMutex m_mutex;                        ///< Guards queues and counters
+    QWaitCondition m_taskAvailable;                ///< Wakes idle workers
+    QQueue<std::function<void()>> m_queues[PRIORITY_COUNT]; ///< Pending tasks per class
+    int m_running[PRIORITY_COUNT];                 ///< Running tasks per class
+    int m_limits[PRIORITY_COUNT];                  ///< Concurrency cap per class
+    QList<QThread *> m_workers;                    ///< Worker threads
+    int m_workerCount;                             ///< Number of workers
+    bool m_stopping;                               ///< Set by shutdown()
+};
+
+// === Template Implementation ===
+
+template <typename Function>
+auto TaskScheduler::run(Priority priority, Function function)
+    -> QFuture<std::invoke_result_t<Function>>
+{
+    using Result = std::invoke_result_t<Function>;
+
+    // Shared so that a dropped task still finishes (cancels) its future
+    auto promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+
+    submit(priority, [promise, function]() mutable {
+        promise->start();
+        if constexpr (std::is_void_v<Result>) {
+            function();
+        } else {
+            promise->addResult(function());
+        }
+        promise->finish();
+    });
+
+    return future;
+}
+
+#endif // TASKSCHEDULER_H
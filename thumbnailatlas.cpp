@@ -0,0 +1,134 @@
+#include "thumbnailatlas.h"
+#include <QPainter>
+
+// === Constants ===
+namespace {
+constexpr int ATLAS_PADDING = 1;              // Gap between packed thumbnails (avoids bleeding)
+constexpr double SHELF_MAX_WASTE = 1.25;      // Shelf may be at most 25% taller than the item
+}
+
+// === Constructor ===
+
+ThumbnailAtlas::ThumbnailAtlas(int pageSize, int maxPages)
+    : m_pageSize(qMax(64, pageSize))
+    , m_maxPages(qMax(1, maxPages))
+{
+}
+
+// === Public Methods ===
+
+ThumbnailAtlas::Region ThumbnailAtlas::insert(const QString &key, const QPixmap &thumbnail)
+{
+    if (thumbnail.isNull()) {
+        return Region();
+    }
+
+    // A new thumbnail for the key is painted over the old one; one of a
+    // different size moves, leaving its old slot to a later thumbnail
+    Region region = m_regions.value(key);
+    if (region.isValid() && region.rect.size() != thumbnail.size()) {
+        release(region);
+        m_regions.remove(key);
+        region = Region();
+    }
+    if (!region.isValid() && !allocate(thumbnail.size(), region)) {
+        return Region();
+    }
+
+    QPainter painter(&m_pages[region.page].pixmap);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawPixmap(region.rect.topLeft(), thumbnail);
+    painter.end();
+
+    m_regions.insert(key, region);
+    return region;
+}
+
+void ThumbnailAtlas::clear()
+{
+    m_pages.clear();
+    m_regions.clear();
+}
+
+// === Private Methods ===
+
+bool ThumbnailAtlas::allocate(const QSize &size, Region &region)
+{
+    const QSize paddedSize = size + QSize(ATLAS_PADDING, ATLAS_PADDING);
+    if (paddedSize.width() > m_pageSize || paddedSize.height() > m_pageSize) {
+        return false;
+    }
+
+    QPoint position;
+    for (int i = 0; i < m_pages.size(); ++i) {
+        if (allocateOnPage(m_pages[i], paddedSize, position)) {
+            region.page = i;
+            region.rect = QRect(position, size);
+            return true;
+        }
+    }
+
+    if (m_pages.size() >= m_maxPages) {
+        return false;
+    }
+
+    Page page;
+    page.pixmap = QPixmap(m_pageSize, m_pageSize);
+    page.pixmap.fill(Qt::transparent);
+    page.nextShelfY = 0;
+    m_pages.append(page);
+
+    if (!allocateOnPage(m_pages.last(), paddedSize, position)) {
+        return false;
+    }
+
+    region.page = m_pages.size() - 1;
+    region.rect = QRect(position, size);
+    return true;
+}
+
+void ThumbnailAtlas::release(const Region &region)
+{
+    const QSize paddedSize = region.rect.size() + QSize(ATLAS_PADDING, ATLAS_PADDING);
+    m_pages[region.page].freeSlots.append(QRect(region.rect.topLeft(), paddedSize));
+}
+
+bool ThumbnailAtlas::allocateOnPage(Page &page, const QSize &size, QPoint &position) const
+{
+    // 0. Slot released by a resized thumbnail, under the same height rule as shelves
+    for (int i = 0; i < page.freeSlots.size(); ++i) {
+        const QRect &slot = page.freeSlots.at(i);
+        if (size.width() <= slot.width() && size.height() <= slot.height() &&
+            slot.height() <= size.height() * SHELF_MAX_WASTE) {
+            position = slot.topLeft();
+            page.freeSlots.removeAt(i);
+            return true;
+        }
+    }
+
+    // 1. Existing shelf of fitting height with room left
+    for (Shelf &shelf : page.shelves) {
+        const bool fitsHeight = size.height() <= shelf.height &&
+                                shelf.height <= size.height() * SHELF_MAX_WASTE;
+        if (fitsHeight && shelf.nextX + size.width() <= m_pageSize) {
+            position = QPoint(shelf.nextX, shelf.y);
+            shelf.nextX += size.width();
+            return true;
+        }
+    }
+
+    // 2. New shelf below the last one
+    if (page.nextShelfY + size.height() > m_pageSize) {
+        return false;
+    }
+
+    Shelf shelf;
+    shelf.y = page.nextShelfY;
+    shelf.height = size.height();
+    shelf.nextX = size.width();
+    page.shelves.append(shelf);
+    page.nextShelfY += size.height();
+
+    position = QPoint(0, shelf.y);
+    return true;
+}
@@ -0,0 +1,123 @@
+#ifndef THUMBNAILATLAS_H
+#define THUMBNAILATLAS_H
+
+#include <QHash>
+#include <QList>
+#include <QPixmap>
+#include <QRect>
+#include <QString>
+
+/**
+ * @brief Packs thumbnails into a few large atlas pages
+ *
+ * Thumbnails are copied into shared pixmap pages using a shelf allocator:
+ * each page is split into horizontal shelves, and a thumbnail goes onto the
+ * first shelf tall enough (without wasting too much height) that still has
+ * horizontal room. Painting a cell is then a single drawPixmap from a page.
+ */
+class ThumbnailAtlas
+{
+public:
+    /**
+     * @brief Location of a thumbnail inside the atlas
+     */
+    struct Region {
+        int page = -1;               ///< Page index, -1 if not present
+        QRect rect;                  ///< Source rectangle within the page
+
+        bool isValid() const { return page >= 0; }
+    };
+
+    /**
+     * @brief Create an empty atlas
+     * @param pageSize Width and height of each page in pixels
+     * @param maxPages Maximum number of pages to allocate
+     */
+    explicit ThumbnailAtlas(int pageSize = 2048, int maxPages = 4);
+
+    /**
+     * @brief Copy a thumbnail into the atlas
+     *
+     * A key already packed is repainted with the new thumbnail; if the size
+     * changed it moves to a new region and its old space is reused.
+     * @param key Key identifying the thumbnail (image path)
+     * @param thumbnail Thumbnail to pack
+     * @return Region of the thumbnail, or invalid region if the atlas is full
+     */
+    Region insert(const QString &key, const QPixmap &thumbnail);
+
+    /**
+     * @brief Look up a packed thumbnail
+     * @param key Thumbnail key
+     * @return Region, or invalid region if not packed
+     */
+    Region region(const QString &key) const { return m_regions.value(key); }
+
+    /**
+     * @brief Get an atlas page
+     * @param index Page index from a Region
+     * @return Page pixmap
+     */
+    const QPixmap &page(int index) const { return m_pages.at(index).pixmap; }
+
+    /**
+     * @brief Drop all pages and regions
+     */
+    void clear();
+
+    /**
+     * @brief Get number of packed thumbnails
+     * @return Thumbnail count
+     */
+    int count() const { return m_regions.size(); }
+
+private:
+    /**
+     * @brief Horizontal strip of a page holding thumbnails of similar height
+     */
+    struct Shelf {
+        int y;                       ///< Top of the shelf
+        int height;                  ///< Shelf height
+        int nextX;                   ///< First free column
+    };
+
+    /**
+     * @brief Atlas page with its shelves
+     */
+    struct Page {
+        QPixmap pixmap;              ///< Page contents
+        QList<Shelf> shelves;        ///< Allocated shelves, top to bottom
+        QList<QRect> freeSlots;      ///< Padded slots released by resized thumbnails
+        int nextShelfY;              ///< First free row for a new shelf
+    };
+
+    /**
+     * @brief Find space for a rectangle, adding shelves or pages as needed
+     * @param size Size to allocate
+     * @param region Output region
+     * @return True if space was found
+     */
+    bool allocate(const QSize &size, Region &region);
+
+    /**
+     * @brief Return a region's space to its page for reuse
+     * @param region Region being dropped
+     */
+    void release(const Region &region);
+
+    /**
+     * @brief Try to allocate on one page
+     * @param page Page to allocate on
+     * @param size Size to allocate
+     * @param position Output top-left position
+     * @return True if space was found
+     */
+    bool allocateOnPage(Page &page, const QSize &size, QPoint &position) const;
+
+    QList<Page> m_pages;                   ///< Allocated pages
+    QHash<QString, Region> m_regions;      ///< Key -> packed region
+    int m_pageSize;                        ///< Page width and height
+    int m_maxPages;                        ///< Page limit
+};
+
+#endif // THUMBNAILATLAS_H
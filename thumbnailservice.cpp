@@ -1,19 +1,51 @@
 #include "thumbnailservice.h"
+#include "ioconcurrencycontroller.h"
+#include "memorygovernor.h"
 #include <QPixmap>
+#include <QFile>
+#include <QSaveFile>
 #include <QFileInfo>
 #include <QDir>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QBuffer>
 #include <QCryptographicHash>
 #include <QStandardPaths>
 #include <QTimer>
+#include <QSet>
+#include <QDataStream>
+#include <QMutexLocker>
 #include <QDebug>
 
 // === Constants ===
 namespace {
 constexpr int DEFAULT_MEMORY_CACHE_SIZE = 200;
 constexpr int DEFAULT_DISK_CACHE_SIZE_MB = 500;
+constexpr int DEFAULT_COMPRESSED_CACHE_SIZE_MB = 256;
+constexpr int COMPRESSED_QUALITY = 80;          // ~5-10 KB per 120px thumbnail
 constexpr int DEFAULT_THUMBNAIL_SIZE = 120;
 constexpr int CLEANUP_INTERVAL_MS = 5 * 60 * 1000; // 5 minutes
 constexpr int PROGRESS_UPDATE_INTERVAL = 10;
+constexpr qint64 WARM_MAX_BUFFERED_SIZE = 64 * 1024 * 1024; // Larger sources are decoded from the file
+constexpr int PERMIT_RETRY_MS = 20;             // Requeue delay while a volume is at its I/O limit
+
+// Disk cache eviction (CLOCK over the persisted cache index)
+const QString DISK_INDEX_FILENAME = "cache_index.dat";
+const QString DISK_INDEX_VERSION = "ThumbnailCacheIndex_v1";
+constexpr int EVICTION_STEP_INTERVAL_MS = 50;
+constexpr int EVICTION_STEP_ENTRIES = 64;       // Ring slots examined per step
+constexpr int EVICTION_LOW_WATER_PERCENT = 90;  // Evict down to this share of the budget
+
+// Shares of the process-wide memory budget (see MemoryGovernor)
+constexpr double PIXMAP_CACHE_WEIGHT = 2.0;
+constexpr double COMPRESSED_CACHE_WEIGHT = 1.0;
+
+// Pyramid levels generated from a single decode, smallest first.
+// Requests are served by downscaling from the nearest larger level.
+constexpr int PYRAMID_LEVELS[] = {96, 192, 384, 768};
+constexpr int PYRAMID_LEVEL_COUNT = sizeof(PYRAMID_LEVELS) / sizeof(PYRAMID_LEVELS[0]);
+constexpr int PYRAMID_MAX_LEVEL = PYRAMID_LEVELS[PYRAMID_LEVEL_COUNT - 1];
 }
 
 // === Constructor & Destructor ===
@@ -22,15 +54,39 @@ ThumbnailService::ThumbnailService(QObject *parent)
     : QObject(parent)
     , m_maxMemoryCache(DEFAULT_MEMORY_CACHE_SIZE)
     , m_maxDiskCacheSizeMB(DEFAULT_DISK_CACHE_SIZE_MB)
+    , m_compressedFormat(selectCompressedFormat())
     , m_defaultThumbnailSize(DEFAULT_THUMBNAIL_SIZE)
+    , m_diskCacheBytes(0)
+    , m_clockHand(0)
+    , m_clockTombstones(0)
+    , m_diskIndexDirty(false)
+    , m_pixmapConsumerId(0)
+    , m_compressedConsumerId(0)
 {
+    m_compressedCache.setMaxCost(static_cast<qsizetype>(DEFAULT_COMPRESSED_CACHE_SIZE_MB) * 1024 * 1024);
+
     initializeCacheDirectory();
+    loadDiskIndex();
     setupCleanupTimer();
+
+    MemoryGovernor *governor = MemoryGovernor::instance();
+    m_pixmapConsumerId = governor->registerConsumer(
+        "Thumbnail pixmaps", PIXMAP_CACHE_WEIGHT,
+        [this]() { return memoryCacheBytes(); },
+        [this](qint64 bytes) { return evictMemoryCache(bytes); });
+    m_compressedConsumerId = governor->registerConsumer(
+        "Compressed thumbnails", COMPRESSED_CACHE_WEIGHT,
+        [this]() { return static_cast<qint64>(m_compressedCache.totalCost()); },
+        [this](qint64 bytes) { return evictCompressedCache(bytes); });
 }
 
 ThumbnailService::~ThumbnailService()
 {
-    // Cache will be automatically cleaned up
+    MemoryGovernor::instance()->unregisterConsumer(m_pixmapConsumerId);
+    MemoryGovernor::instance()->unregisterConsumer(m_compressedConsumerId);
+
+    // Memory cache is cleaned up automatically; keep access history for next run
+    saveDiskIndex();
 }
 
 // === Core Functionality ===
@@ -41,36 +97,94 @@ QPixmap ThumbnailService::getThumbnail(const QString &imagePath, int size)
         size = m_defaultThumbnailSize;
     }
 
-    const QString cacheKey = getCacheKey(imagePath, size);
+    const QString sourceKey = getSourceKey(imagePath);
+    const QString cacheKey = getCacheKey(sourceKey, size);
 
-    // 1. Check memory cache first (fastest)
-    if (m_memoryCache.contains(cacheKey)) {
-        return m_memoryCache[cacheKey];
+    // 1. Check memory tiers first (fastest)
+    const QPixmap memoryCached = loadFromMemoryCache(cacheKey);
+    if (!memoryCached.isNull()) {
+        // Sizes within the pyramid are backed by a level file, not their own
+        touchDiskEntry(size <= PYRAMID_MAX_LEVEL ? getCacheKey(sourceKey, pyramidLevelFor(size)) : cacheKey);
+        return memoryCached;
     }
 
-    // 2. Check disk cache (fast)
-    QPixmap diskCached = loadFromDiskCache(cacheKey);
-    if (!diskCached.isNull()) {
-        // Add to memory cache for faster future access
-        m_memoryCache[cacheKey] = diskCached;
+    // 2. Sizes beyond the pyramid are decoded directly (slow, rare)
+    if (size > PYRAMID_MAX_LEVEL) {
+        QPixmap diskCached = loadFromDiskCache(cacheKey);
+        if (!diskCached.isNull()) {
+            m_memoryCache[cacheKey] = diskCached;
+            cleanupMemoryCache();
+            return diskCached;
+        }
+
+        const QImage image = createThumbnail(imagePath, size);
+        if (image.isNull()) {
+            return QPixmap();
+        }
+
+        const QPixmap thumbnail = QPixmap::fromImage(image);
+        m_memoryCache[cacheKey] = thumbnail;
+        saveToDiskCache(cacheKey, image);
+        touchDiskEntry(cacheKey);
         cleanupMemoryCache();
-        return diskCached;
+
+        emit thumbnailReady(imagePath, thumbnail);
+        return thumbnail;
     }
 
-    // 3. Create new thumbnail (slow)
-    QPixmap thumbnail = createThumbnail(imagePath, size);
-    if (!thumbnail.isNull()) {
-        // Cache in both memory and disk
+    // 3. Serve from the nearest larger pyramid level (decodes the source at most once)
+    const int level = pyramidLevelFor(size);
+    bool created = false;
+    const QPixmap levelPixmap = loadPyramidLevel(imagePath, sourceKey, level, created);
+    if (levelPixmap.isNull()) {
+        return QPixmap();
+    }
+
+    QPixmap thumbnail = levelPixmap;
+    if (level != size) {
+        thumbnail = levelPixmap.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
         m_memoryCache[cacheKey] = thumbnail;
-        saveToDiskCache(cacheKey, thumbnail);
         cleanupMemoryCache();
+    }
 
+    if (created) {
         emit thumbnailReady(imagePath, thumbnail);
     }
 
     return thumbnail;
 }
 
+QPixmap ThumbnailService::requestThumbnail(const QString &imagePath, int size,
+                                           TaskScheduler::Priority priority)
+{
+    if (size <= 0) {
+        size = m_defaultThumbnailSize;
+    }
+
+    // Anything already cached is cheap enough to serve synchronously
+    const QString sourceKey = getSourceKey(imagePath);
+    const QString cacheKey = getCacheKey(sourceKey, size);
+    const bool diskCached = size > PYRAMID_MAX_LEVEL ? isDiskCached(cacheKey)
+                                                     : isPyramidCached(sourceKey);
+    if (diskCached || m_memoryCache.contains(cacheKey) || m_compressedCache.contains(cacheKey)) {
+        return getThumbnail(imagePath, size);
+    }
+
+    if (m_pendingRequests.contains(imagePath)) {
+        return QPixmap();
+    }
+    m_pendingRequests.insert(imagePath, size);
+
+    dispatchThumbnailRequest(imagePath, size, priority, m_requestGeneration.loadRelaxed());
+    return QPixmap();
+}
+
+void ThumbnailService::cancelThumbnailRequests()
+{
+    m_requestGeneration.fetchAndAddRelaxed(1);
+    m_pendingRequests.clear();
+}
+
 void ThumbnailService::preloadThumbnails(const QStringList &imagePaths, int size)
 {
     if (size <= 0) {
@@ -91,12 +205,78 @@ void ThumbnailService::preloadThumbnails(const QStringList &imagePaths, int size
     }
 }
 
+ThumbnailService::WarmResult ThumbnailService::warmThumbnail(const QString &imagePath)
+{
+    const QString sourceKey = getSourceKey(imagePath);
+    if (isPyramidCached(sourceKey)) {
+        return WarmResult::Cached;
+    }
+
+    // Read under a volume permit so slow mounts are not flooded; decode after.
+    // A volume at its limit defers the image rather than parking this worker.
+    QByteArray contents;
+    QList<QImage> pyramid;
+    {
+        IoConcurrencyController::Permit permit(imagePath);
+        if (!permit.isGranted()) {
+            return WarmResult::Deferred;
+        }
+        QFile file(imagePath);
+        const qint64 fileSize = file.size();
+        if (fileSize <= WARM_MAX_BUFFERED_SIZE && file.open(QIODevice::ReadOnly)) {
+            contents = file.readAll();
+        }
+
+        if (contents.isEmpty()) {
+            // Too large to buffer (or the read failed): decoded straight from
+            // the file, so the permit covers the whole read
+            permit.setBytes(fileSize);
+            pyramid = createThumbnailPyramid(imagePath);
+        } else {
+            permit.setBytes(contents.size());
+        }
+    }
+
+    if (!contents.isEmpty()) {
+        return ingestThumbnail(imagePath, contents) ? WarmResult::Cached : WarmResult::Failed;
+    }
+
+    if (pyramid.isEmpty()) {
+        return WarmResult::Failed;
+    }
+
+    savePyramidToDiskCache(sourceKey, pyramid);
+    return WarmResult::Cached;
+}
+
+bool ThumbnailService::ingestThumbnail(const QString &imagePath, const QByteArray &contents)
+{
+    const QString sourceKey = getSourceKey(imagePath);
+    if (isPyramidCached(sourceKey)) {
+        return true;
+    }
+
+    QBuffer buffer;
+    buffer.setData(contents);
+    buffer.open(QIODevice::ReadOnly);
+
+    QImageReader reader(&buffer);
+    const QList<QImage> pyramid = createThumbnailPyramid(reader, imagePath);
+    if (pyramid.isEmpty()) {
+        return false;
+    }
+
+    savePyramidToDiskCache(sourceKey, pyramid);
+    return true;
+}
+
 // === Cache Management ===
 
 void ThumbnailService::clearCache()
 {
-    // Clear memory cache
+    // Clear memory caches
     m_memoryCache.clear();
+    m_compressedCache.clear();
 
     // Clear disk cache
     clearDiskCache();
@@ -106,8 +286,12 @@ void ThumbnailService::clearCache()
 
 void ThumbnailService::setCacheDirectory(const QString &directory)
 {
+    saveDiskIndex();
+
     m_cacheDirectory = directory;
     QDir().mkpath(m_cacheDirectory);
+
+    loadDiskIndex();
 }
 
 void ThumbnailService::setMaxMemoryCache(int maxItems)
@@ -116,9 +300,15 @@ void ThumbnailService::setMaxMemoryCache(int maxItems)
     cleanupMemoryCache();
 }
 
+void ThumbnailService::setMaxCompressedCacheSize(int maxSizeMB)
+{
+    m_compressedCache.setMaxCost(static_cast<qsizetype>(qMax(1, maxSizeMB)) * 1024 * 1024);
+}
+
 void ThumbnailService::setMaxDiskCacheSize(int maxSizeMB)
 {
     m_maxDiskCacheSizeMB = qMax(1, maxSizeMB);
+    cleanupOldCache();
 }
 
 void ThumbnailService::setThumbnailSize(int size)
@@ -130,55 +320,180 @@ void ThumbnailService::setThumbnailSize(int size)
 
 qint64 ThumbnailService::diskCacheSize() const
 {
-    const QDir cacheDir(m_cacheDirectory);
-    const QStringList files = cacheDir.entryList(QStringList() << "*.png", QDir::Files);
-
-    qint64 totalSize = 0;
-    for (const QString &fileName : files) {
-        const QFileInfo fileInfo(cacheDir.absoluteFilePath(fileName));
-        totalSize += fileInfo.size();
-    }
-
-    return totalSize;
+    QMutexLocker locker(&m_diskIndexMutex);
+    return m_diskCacheBytes;
 }
 
 // === Private Slots ===
 
 void ThumbnailService::cleanupOldCache()
 {
-    const qint64 currentSize = diskCacheSize();
-    const qint64 maxSize = static_cast<qint64>(m_maxDiskCacheSizeMB) * 1024 * 1024;
+    m_evictionRequested.storeRelaxed(0);
 
-    if (currentSize <= maxSize) {
+    // Persist access history periodically so it survives crashes
+    saveDiskIndex();
+
+    if (diskCacheSize() <= maxDiskCacheBytes()) {
         return; // No cleanup needed
     }
 
-    const QDir cacheDir(m_cacheDirectory);
-    QFileInfoList files = cacheDir.entryInfoList(
-        QStringList() << "*.png",
-        QDir::Files,
-        QDir::Time | QDir::Reversed // Oldest first
-        );
+    // Evict incrementally so the GUI thread is never blocked for long
+    if (!m_evictionTimer->isActive()) {
+        m_evictionTimer->start();
+    }
+}
+
+void ThumbnailService::evictionStep()
+{
+    // File removal is disk I/O: keep it off the GUI thread at idle priority
+    if (!m_evictionInFlight.testAndSetRelaxed(0, 1)) {
+        return;
+    }
+
+    TaskScheduler::instance()->submit(TaskScheduler::Priority::Maintenance, [this]() {
+        const bool finished = evictDiskEntries();
+        m_evictionInFlight.storeRelaxed(0);
+        if (finished) {
+            QMetaObject::invokeMethod(m_evictionTimer, &QTimer::stop, Qt::QueuedConnection);
+        }
+    });
+}
+
+// === Private Methods ===
+
+void ThumbnailService::dispatchThumbnailRequest(const QString &imagePath, int size,
+                                                TaskScheduler::Priority priority, int generation)
+{
+    TaskScheduler::instance()->submit(priority, [this, imagePath, size, priority, generation]() {
+        if (m_requestGeneration.loadRelaxed() != generation) {
+            return; // Canceled while queued
+        }
+
+        const WarmResult result = size > PYRAMID_MAX_LEVEL ? warmLargeThumbnail(imagePath, size)
+                                                           : warmThumbnail(imagePath);
+        QMetaObject::invokeMethod(this, [this, imagePath, size, priority, generation, result]() {
+            if (result != WarmResult::Deferred) {
+                finishThumbnailRequest(imagePath, result == WarmResult::Cached);
+                return;
+            }
+
+            // The source volume was busy: requeue after a pause, unless canceled
+            QTimer::singleShot(PERMIT_RETRY_MS, this, [this, imagePath, size, priority, generation]() {
+                if (m_requestGeneration.loadRelaxed() == generation &&
+                    m_pendingRequests.contains(imagePath)) {
+                    dispatchThumbnailRequest(imagePath, size, priority, generation);
+                }
+            });
+        }, Qt::QueuedConnection);
+    });
+}
+
+ThumbnailService::WarmResult ThumbnailService::warmLargeThumbnail(const QString &imagePath, int size)
+{
+    const QString cacheKey = getCacheKey(getSourceKey(imagePath), size);
+    if (isDiskCached(cacheKey)) {
+        return WarmResult::Cached;
+    }
+
+    // Decoded straight from the file; the permit covers the whole read
+    IoConcurrencyController::Permit permit(imagePath);
+    if (!permit.isGranted()) {
+        return WarmResult::Deferred;
+    }
+    permit.setBytes(QFileInfo(imagePath).size());
+
+    const QImage image = createThumbnail(imagePath, size);
+    if (image.isNull()) {
+        return WarmResult::Failed;
+    }
+
+    saveToDiskCache(cacheKey, image);
+    return WarmResult::Cached;
+}
+
+void ThumbnailService::finishThumbnailRequest(const QString &imagePath, bool warmed)
+{
+    const auto it = m_pendingRequests.constFind(imagePath);
+    if (it == m_pendingRequests.constEnd()) {
+        return; // Canceled
+    }
+
+    const int size = it.value();
+    m_pendingRequests.erase(it);
+
+    // Unreadable sources are not retried here, that would decode on this thread
+    if (!warmed) {
+        return;
+    }
+
+    const QPixmap thumbnail = getThumbnail(imagePath, size);
+    if (!thumbnail.isNull()) {
+        emit thumbnailReady(imagePath, thumbnail);
+    }
+}
 
-    // Remove oldest files until we're under the limit
+bool ThumbnailService::evictDiskEntries()
+{
+    QMutexLocker locker(&m_diskIndexMutex);
+
+    const qint64 targetSize = maxDiskCacheBytes() * EVICTION_LOW_WATER_PERCENT / 100;
     qint64 removedSize = 0;
-    for (const QFileInfo &fileInfo : files) {
-        if (currentSize - removedSize <= maxSize) {
-            break;
+    int examined = 0;
+    QStringList victims;
+
+    // CLOCK: referenced entries get a second chance, unreferenced ones are evicted
+    while (m_diskCacheBytes > targetSize &&
+           !m_clockRing.isEmpty() &&
+           examined < EVICTION_STEP_ENTRIES) {
+        if (m_clockHand >= m_clockRing.size()) {
+            m_clockHand = 0;
+        }
+        examined++;
+
+        const QString key = m_clockRing.at(m_clockHand);
+        auto it = m_diskIndex.find(key);
+        if (key.isEmpty() || it == m_diskIndex.end()) {
+            m_clockHand++;
+            continue; // Tombstone
         }
 
-        removedSize += fileInfo.size();
-        if (!QFile::remove(fileInfo.absoluteFilePath())) {
-            qWarning() << "Failed to remove cache file:" << fileInfo.absoluteFilePath();
+        if (it->referenced) {
+            it->referenced = false;
+            m_clockHand++;
+            continue;
+        }
+
+        victims.append(getDiskCachePath(key));
+        removedSize += it->bytes;
+        m_diskCacheBytes -= it->bytes;
+        m_diskIndex.erase(it);
+        m_clockRing[m_clockHand] = QString();
+        m_clockTombstones++;
+        m_clockHand++;
+    }
+
+    compactClockRing();
+
+    if (examined > 0) {
+        m_diskIndexDirty = true; // Access bits and hand position moved
+    }
+    const bool finished = m_diskCacheBytes <= targetSize || m_diskIndex.isEmpty();
+
+    // Files are deleted outside the lock, so lookups from the GUI thread
+    // never wait on a slow cache directory
+    locker.unlock();
+    for (const QString &filePath : std::as_const(victims)) {
+        if (!QFile::remove(filePath) && QFile::exists(filePath)) {
+            qWarning() << "Failed to remove cache file:" << filePath;
         }
     }
 
     if (removedSize > 0) {
-        qDebug() << "Cleaned up" << removedSize << "bytes from thumbnail cache";
+        qDebug() << "Evicted" << removedSize << "bytes from thumbnail cache";
     }
-}
 
-// === Private Methods ===
+    return finished;
+}
 
 void ThumbnailService::initializeCacheDirectory()
 {
@@ -195,29 +510,146 @@ void ThumbnailService::setupCleanupTimer()
     m_cleanupTimer = new QTimer(this);
     connect(m_cleanupTimer, &QTimer::timeout, this, &ThumbnailService::cleanupOldCache);
     m_cleanupTimer->start(CLEANUP_INTERVAL_MS);
+
+    m_evictionTimer = new QTimer(this);
+    m_evictionTimer->setInterval(EVICTION_STEP_INTERVAL_MS);
+    connect(m_evictionTimer, &QTimer::timeout, this, &ThumbnailService::evictionStep);
 }
 
-QString ThumbnailService::getCacheKey(const QString &imagePath, int size) const
+QString ThumbnailService::getSourceKey(const QString &imagePath) const
 {
     const QFileInfo fileInfo(imagePath);
-    const QString keyData = QString("%1_%2_%3_%4")
-                                .arg(fileInfo.fileName())
-                                .arg(fileInfo.size())
-                                .arg(fileInfo.lastModified().toSecsSinceEpoch())
-                                .arg(size);
+    return QString("%1_%2_%3")
+        .arg(fileInfo.fileName())
+        .arg(fileInfo.size())
+        .arg(fileInfo.lastModified().toSecsSinceEpoch());
+}
 
+QString ThumbnailService::getCacheKey(const QString &sourceKey, int size) const
+{
+    const QString keyData = QString("%1_%2").arg(sourceKey).arg(size);
     return QCryptographicHash::hash(keyData.toUtf8(), QCryptographicHash::Md5).toHex();
 }
 
-QPixmap ThumbnailService::createThumbnail(const QString &imagePath, int size)
+int ThumbnailService::pyramidLevelFor(int size) const
 {
-    QPixmap originalPixmap(imagePath);
-    if (originalPixmap.isNull()) {
-        qWarning() << "Failed to load image for thumbnail:" << imagePath;
+    for (int level : PYRAMID_LEVELS) {
+        if (level >= size) {
+            return level;
+        }
+    }
+    return PYRAMID_MAX_LEVEL;
+}
+
+QPixmap ThumbnailService::loadPyramidLevel(const QString &imagePath, const QString &sourceKey,
+                                           int level, bool &created)
+{
+    created = false;
+    const QString levelKey = getCacheKey(sourceKey, level);
+
+    const QPixmap memoryCached = loadFromMemoryCache(levelKey);
+    if (!memoryCached.isNull()) {
+        touchDiskEntry(levelKey);
+        return memoryCached;
+    }
+
+    QPixmap diskCached = loadFromDiskCache(levelKey);
+    if (!diskCached.isNull()) {
+        m_memoryCache[levelKey] = diskCached;
+        cleanupMemoryCache();
+        return diskCached;
+    }
+
+    // Level missing: decode the source once and store every level
+    const QList<QImage> pyramid = createThumbnailPyramid(imagePath);
+    if (pyramid.isEmpty()) {
         return QPixmap();
     }
 
-    return originalPixmap.scaled(
+    savePyramidToDiskCache(sourceKey, pyramid);
+
+    QPixmap levelPixmap;
+    for (int i = 0; i < PYRAMID_LEVEL_COUNT; ++i) {
+        if (PYRAMID_LEVELS[i] == level) {
+            levelPixmap = QPixmap::fromImage(pyramid.at(i));
+        }
+    }
+
+    m_memoryCache[levelKey] = levelPixmap;
+    touchDiskEntry(levelKey);
+    cleanupMemoryCache();
+    created = true;
+
+    return levelPixmap;
+}
+
+QList<QImage> ThumbnailService::createThumbnailPyramid(const QString &imagePath) const
+{
+    QImageReader reader(imagePath);
+    return createThumbnailPyramid(reader, imagePath);
+}
+
+QList<QImage> ThumbnailService::createThumbnailPyramid(QImageReader &reader,
+                                                       const QString &imagePath) const
+{
+    // Let the decoder downscale large sources (e.g. JPEG DCT scaling)
+    const QSize sourceSize = reader.size();
+    if (sourceSize.isValid() &&
+        (sourceSize.width() > PYRAMID_MAX_LEVEL || sourceSize.height() > PYRAMID_MAX_LEVEL)) {
+        reader.setScaledSize(sourceSize.scaled(PYRAMID_MAX_LEVEL, PYRAMID_MAX_LEVEL, Qt::KeepAspectRatio));
+    }
+
+    const QImage decoded = reader.read();
+    if (decoded.isNull()) {
+        qWarning() << "Failed to load image for thumbnail:" << imagePath << reader.errorString();
+        return QList<QImage>();
+    }
+
+    // Build from the top level down so each level is scaled from the next larger one
+    QList<QImage> pyramid(PYRAMID_LEVEL_COUNT);
+    QImage previous = decoded;
+    for (int i = PYRAMID_LEVEL_COUNT - 1; i >= 0; --i) {
+        const int level = PYRAMID_LEVELS[i];
+        pyramid[i] = previous.scaled(level, level, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        previous = pyramid[i];
+    }
+
+    return pyramid;
+}
+
+bool ThumbnailService::isPyramidCached(const QString &sourceKey) const
+{
+    QMutexLocker locker(&m_diskIndexMutex);
+    for (int level : PYRAMID_LEVELS) {
+        if (!m_diskIndex.contains(getCacheKey(sourceKey, level))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ThumbnailService::isDiskCached(const QString &cacheKey) const
+{
+    QMutexLocker locker(&m_diskIndexMutex);
+    return m_diskIndex.contains(cacheKey);
+}
+
+void ThumbnailService::savePyramidToDiskCache(const QString &sourceKey, const QList<QImage> &pyramid)
+{
+    for (int i = 0; i < PYRAMID_LEVEL_COUNT; ++i) {
+        saveToDiskCache(getCacheKey(sourceKey, PYRAMID_LEVELS[i]), pyramid.at(i));
+    }
+}
+
+QImage ThumbnailService::createThumbnail(const QString &imagePath, int size) const
+{
+    QImage originalImage(imagePath);
+    if (originalImage.isNull()) {
+        qWarning() << "Failed to load image for thumbnail:" << imagePath;
+        return QImage();
+    }
+
+    return originalImage.scaled(
         size, size,
         Qt::KeepAspectRatio,
         Qt::SmoothTransformation
@@ -229,32 +661,43 @@ QString ThumbnailService::getDiskCachePath(const QString &cacheKey) const
     return m_cacheDirectory + "/" + cacheKey + ".png";
 }
 
-QPixmap ThumbnailService::loadFromDiskCache(const QString &cacheKey) const
+QPixmap ThumbnailService::loadFromDiskCache(const QString &cacheKey)
 {
-    const QString filePath = getDiskCachePath(cacheKey);
-    if (!QFile::exists(filePath)) {
-        return QPixmap();
+    {
+        QMutexLocker locker(&m_diskIndexMutex);
+        if (!m_diskIndex.contains(cacheKey)) {
+            return QPixmap();
+        }
     }
 
+    const QString filePath = getDiskCachePath(cacheKey);
     QPixmap cached(filePath);
     if (cached.isNull()) {
-        // Corrupted cache file - remove it
+        // Missing or corrupted cache file - remove it
         QFile::remove(filePath);
+        forgetDiskEntry(cacheKey);
+        return cached;
     }
 
+    touchDiskEntry(cacheKey);
     return cached;
 }
 
-void ThumbnailService::saveToDiskCache(const QString &cacheKey, const QPixmap &thumbnail)
+void ThumbnailService::saveToDiskCache(const QString &cacheKey, const QImage &thumbnail)
 {
     const QString filePath = getDiskCachePath(cacheKey);
     if (!thumbnail.save(filePath, "PNG")) {
         qWarning() << "Failed to save thumbnail to cache:" << filePath;
+        return;
     }
+
+    recordDiskEntry(cacheKey, QFileInfo(filePath).size());
 }
 
 void ThumbnailService::cleanupMemoryCache()
 {
+    MemoryGovernor::instance()->notifyGrowth();
+
     if (m_memoryCache.size() <= m_maxMemoryCache) {
         return; // No cleanup needed
     }
@@ -265,8 +708,103 @@ void ThumbnailService::cleanupMemoryCache()
     auto it = m_memoryCache.begin();
 
     for (int i = 0; i < itemsToRemove && it != m_memoryCache.end(); ++i) {
+        demoteToCompressedCache(it.key(), it.value());
+        it = m_memoryCache.erase(it);
+    }
+}
+
+qint64 ThumbnailService::memoryCacheBytes() const
+{
+    qint64 bytes = 0;
+    for (const QPixmap &pixmap : m_memoryCache) {
+        bytes += qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    }
+    return bytes;
+}
+
+qint64 ThumbnailService::evictMemoryCache(qint64 bytes)
+{
+    // Demoted pixmaps grow the compressed tier; only the difference is freed
+    const qint64 compressedBefore = m_compressedCache.totalCost();
+    qint64 released = 0;
+    qint64 freed = 0;
+    auto it = m_memoryCache.begin();
+    while (freed < bytes && it != m_memoryCache.end()) {
+        const QPixmap &pixmap = it.value();
+        released += qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+        demoteToCompressedCache(it.key(), pixmap);
         it = m_memoryCache.erase(it);
+        freed = released - (m_compressedCache.totalCost() - compressedBefore);
+    }
+    return freed;
+}
+
+qint64 ThumbnailService::evictCompressedCache(qint64 bytes)
+{
+    // QCache trims its least recently used entries when the limit drops
+    const qsizetype before = m_compressedCache.totalCost();
+    const qsizetype maxCost = m_compressedCache.maxCost();
+    m_compressedCache.setMaxCost(qMax<qsizetype>(0, before - bytes));
+    m_compressedCache.setMaxCost(maxCost);
+    return before - m_compressedCache.totalCost();
+}
+
+QPixmap ThumbnailService::loadFromMemoryCache(const QString &cacheKey)
+{
+    auto it = m_memoryCache.constFind(cacheKey);
+    if (it != m_memoryCache.constEnd()) {
+        return it.value();
     }
+
+    // Second tier: encoded bytes, decoded on promotion.
+    // The encoded copy is kept so a later demotion costs nothing.
+    const QByteArray *encoded = m_compressedCache.object(cacheKey);
+    if (!encoded) {
+        return QPixmap();
+    }
+
+    QPixmap promoted;
+    if (!promoted.loadFromData(*encoded)) {
+        m_compressedCache.remove(cacheKey);
+        return QPixmap();
+    }
+
+    m_memoryCache[cacheKey] = promoted;
+    cleanupMemoryCache();
+    return promoted;
+}
+
+void ThumbnailService::demoteToCompressedCache(const QString &cacheKey, const QPixmap &thumbnail)
+{
+    if (thumbnail.isNull() || m_compressedCache.contains(cacheKey)) {
+        return;
+    }
+
+    const QImage image = thumbnail.toImage();
+
+    // JPEG has no alpha channel; keep transparent thumbnails lossless
+    const QByteArray format = (image.hasAlphaChannel() && m_compressedFormat == "jpg")
+                                  ? QByteArray("png")
+                                  : m_compressedFormat;
+
+    QByteArray *encoded = new QByteArray;
+    QBuffer buffer(encoded);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, format.constData(), COMPRESSED_QUALITY)) {
+        delete encoded;
+        return;
+    }
+    buffer.close();
+
+    // QCache takes ownership (and deletes the entry if it exceeds the budget)
+    m_compressedCache.insert(cacheKey, encoded, encoded->size());
+}
+
+QByteArray ThumbnailService::selectCompressedFormat()
+{
+    // WebP is noticeably smaller at equal quality when the plugin is present
+    const QList<QByteArray> formats = QImageWriter::supportedImageFormats();
+    return formats.contains("webp") ? QByteArray("webp") : QByteArray("jpg");
 }
 
 void ThumbnailService::clearDiskCache()
@@ -279,4 +817,224 @@ void ThumbnailService::clearDiskCache()
             qWarning() << "Failed to remove cache file:" << fileName;
         }
     }
+
+    QMutexLocker locker(&m_diskIndexMutex);
+    m_diskIndex.clear();
+    m_clockRing.clear();
+    m_clockHand = 0;
+    m_clockTombstones = 0;
+    m_diskCacheBytes = 0;
+    m_diskIndexDirty = true;
+}
+
+// === Private Methods - Disk Cache Index ===
+
+qint64 ThumbnailService::maxDiskCacheBytes() const
+{
+    return static_cast<qint64>(m_maxDiskCacheSizeMB) * 1024 * 1024;
+}
+
+void ThumbnailService::touchDiskEntry(const QString &cacheKey)
+{
+    QMutexLocker locker(&m_diskIndexMutex);
+    auto it = m_diskIndex.find(cacheKey);
+    if (it != m_diskIndex.end() && !it->referenced) {
+        it->referenced = true;
+        m_diskIndexDirty = true;
+    }
+}
+
+void ThumbnailService::recordDiskEntry(const QString &cacheKey, qint64 bytes)
+{
+    bool overBudget = false;
+    {
+        QMutexLocker locker(&m_diskIndexMutex);
+        auto it = m_diskIndex.find(cacheKey);
+        if (it != m_diskIndex.end()) {
+            m_diskCacheBytes += bytes - it->bytes;
+            it->bytes = bytes;
+        } else {
+            // New entries start unreferenced: prefetched thumbnails nobody
+            // looks at are the first to go
+            m_diskIndex.insert(cacheKey, DiskCacheEntry{bytes, false});
+            m_clockRing.append(cacheKey);
+            m_diskCacheBytes += bytes;
+        }
+        m_diskIndexDirty = true;
+        overBudget = m_diskCacheBytes > maxDiskCacheBytes();
+    }
+
+    // May run on a worker thread: hand eviction to the service's thread
+    if (overBudget && m_evictionRequested.testAndSetRelaxed(0, 1)) {
+        QMetaObject::invokeMethod(this, &ThumbnailService::cleanupOldCache, Qt::QueuedConnection);
+    }
+}
+
+void ThumbnailService::forgetDiskEntry(const QString &cacheKey)
+{
+    QMutexLocker locker(&m_diskIndexMutex);
+    auto it = m_diskIndex.find(cacheKey);
+    if (it == m_diskIndex.end()) {
+        return;
+    }
+
+    m_diskCacheBytes -= it->bytes;
+    m_diskIndex.erase(it);
+    m_diskIndexDirty = true;
+
+    // Blanked to a tombstone, so a key recorded again holds a single slot
+    const int slot = m_clockRing.indexOf(cacheKey);
+    if (slot >= 0) {
+        m_clockRing[slot] = QString();
+        m_clockTombstones++;
+    }
+    compactClockRing();
+}
+
+void ThumbnailService::compactClockRing()
+{
+    // Called with m_diskIndexMutex held
+    if (m_clockTombstones <= m_clockRing.size() / 2) {
+        return;
+    }
+
+    QList<QString> compacted;
+    compacted.reserve(m_diskIndex.size());
+    int newHand = 0;
+
+    for (int i = 0; i < m_clockRing.size(); ++i) {
+        if (i == m_clockHand) {
+            newHand = compacted.size();
+        }
+        const QString &key = m_clockRing.at(i);
+        if (!key.isEmpty() && m_diskIndex.contains(key)) {
+            compacted.append(key);
+        }
+    }
+
+    m_clockRing = compacted;
+    m_clockHand = newHand;
+    m_clockTombstones = 0;
+}
+
+void ThumbnailService::loadDiskIndex()
+{
+    QMutexLocker locker(&m_diskIndexMutex);
+
+    m_diskIndex.clear();
+    m_clockRing.clear();
+    m_clockHand = 0;
+    m_clockTombstones = 0;
+    m_diskCacheBytes = 0;
+    m_diskIndexDirty = false;
+
+    // 1. Restore entries in clock order (starting at the saved hand)
+    bool indexLoaded = false;
+    QFile indexFile(m_cacheDirectory + "/" + DISK_INDEX_FILENAME);
+    if (indexFile.open(QIODevice::ReadOnly)) {
+        QDataStream stream(&indexFile);
+        stream.setVersion(QDataStream::Qt_6_0);
+
+        QString version;
+        qint32 entryCount = 0;
+        stream >> version >> entryCount;
+
+        if (version == DISK_INDEX_VERSION && entryCount >= 0) {
+            for (qint32 i = 0; i < entryCount && stream.status() == QDataStream::Ok; ++i) {
+                QString key;
+                DiskCacheEntry entry = {0, false};
+                stream >> key >> entry.bytes >> entry.referenced;
+                if (!key.isEmpty() && !m_diskIndex.contains(key)) {
+                    m_diskIndex.insert(key, entry);
+                    m_clockRing.append(key);
+                    m_diskCacheBytes += entry.bytes;
+                }
+            }
+            indexLoaded = stream.status() == QDataStream::Ok;
+        }
+    }
+
+    if (!indexLoaded) {
+        m_diskIndex.clear();
+        m_clockRing.clear();
+        m_diskCacheBytes = 0;
+    }
+
+    // 2. Reconcile with the files actually on disk (first run or after a crash).
+    // Unknown files are added oldest first so they are evicted first.
+    const QDir cacheDir(m_cacheDirectory);
+    const QStringList files = cacheDir.entryList(
+        QStringList() << "*.png",
+        QDir::Files,
+        indexLoaded ? QDir::Unsorted : (QDir::Time | QDir::Reversed)
+        );
+
+    QSet<QString> keysOnDisk;
+    keysOnDisk.reserve(files.size());
+    for (const QString &fileName : files) {
+        const QString key = QFileInfo(fileName).completeBaseName();
+        keysOnDisk.insert(key);
+
+        if (!m_diskIndex.contains(key)) {
+            const qint64 bytes = QFileInfo(cacheDir.absoluteFilePath(fileName)).size();
+            m_diskIndex.insert(key, DiskCacheEntry{bytes, false});
+            m_clockRing.append(key);
+            m_diskCacheBytes += bytes;
+            m_diskIndexDirty = true;
+        }
+    }
+
+    for (int i = 0; i < m_clockRing.size(); ++i) {
+        const QString key = m_clockRing.at(i);
+        if (!keysOnDisk.contains(key)) {
+            m_diskCacheBytes -= m_diskIndex.value(key).bytes;
+            m_diskIndex.remove(key);
+            m_clockRing[i] = QString();
+            m_clockTombstones++;
+            m_diskIndexDirty = true;
+        }
+    }
+    compactClockRing();
+
+    qDebug() << "Thumbnail cache index:" << m_diskIndex.size() << "entries,"
+             << m_diskCacheBytes << "bytes";
+}
+
+void ThumbnailService::saveDiskIndex()
+{
+    QMutexLocker locker(&m_diskIndexMutex);
+    if (!m_diskIndexDirty) {
+        return;
+    }
+
+    // Written aside and renamed over the old index, so a crash never leaves a truncated one
+    QSaveFile indexFile(m_cacheDirectory + "/" + DISK_INDEX_FILENAME);
+    if (!indexFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to save thumbnail cache index:" << indexFile.fileName();
+        return;
+    }
+
+    QDataStream stream(&indexFile);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << DISK_INDEX_VERSION;
+    stream << static_cast<qint32>(m_diskIndex.size());
+
+    // Write in clock order starting at the hand so the position is preserved
+    const int ringSize = m_clockRing.size();
+    for (int offset = 0; offset < ringSize; ++offset) {
+        const QString &key = m_clockRing.at((m_clockHand + offset) % ringSize);
+        auto it = m_diskIndex.constFind(key);
+        if (key.isEmpty() || it == m_diskIndex.constEnd()) {
+            continue;
+        }
+        stream << key << it->bytes << it->referenced;
+    }
+
+    if (stream.status() != QDataStream::Ok || !indexFile.commit()) {
+        qWarning() << "Failed to save thumbnail cache index:" << indexFile.fileName()
+                   << indexFile.errorString();
+        return;
+    }
+
+    m_diskIndexDirty = false;
 }
@@ -3,15 +3,31 @@
 
 #include <QObject>
 #include <QPixmap>
+#include <QImage>
 #include <QHash>
+#include <QCache>
+#include <QByteArray>
 #include <QString>
 #include <QTimer>
+#include <QMutex>
+#include <QAtomicInt>
+#include "taskscheduler.h"
+
+class QImageReader;
 
 /**
  * @brief Service for generating, caching, and managing image thumbnails
  *
- * Provides efficient thumbnail generation with both memory and disk caching.
+ * Provides efficient thumbnail generation with memory and disk caching.
+ * The memory side has two tiers: decoded pixmaps, and behind them a
+ * byte-budgeted cache of compressed thumbnails that are decoded on promotion.
+ * Each source is decoded once into a small pyramid of levels; requests for
+ * any size are served by downscaling from the nearest larger cached level.
+ * The disk cache is bounded by a persisted index with CLOCK access bits,
+ * so eviction keeps the thumbnails that are actually browsed.
  * Supports asynchronous thumbnail loading and automatic cache cleanup.
+ * Asynchronous requests and disk eviction run on the TaskScheduler, so
+ * decoding for on-screen cells is never queued behind bulk work.
  */
 class ThumbnailService : public QObject
 {
@@ -31,6 +47,26 @@ public:
      */
     QPixmap getThumbnail(const QString &imagePath, int size = 120);
 
+    /**
+     * @brief Get a thumbnail without decoding on the calling thread
+     *
+     * Cached thumbnails (memory or disk pyramid) are returned at once.
+     * Otherwise the pyramid, or a size beyond it, is generated as a
+     * scheduler task of the given priority, thumbnailReady() is emitted once
+     * it is available, and a null pixmap is returned.
+     * @param imagePath Path to the source image
+     * @param size Thumbnail size (default: 120px)
+     * @param priority Scheduler class for the decode
+     * @return Thumbnail pixmap, or null pixmap if it is being generated
+     */
+    QPixmap requestThumbnail(const QString &imagePath, int size = 120,
+                             TaskScheduler::Priority priority = TaskScheduler::Priority::Interactive);
+
+    /**
+     * @brief Drop asynchronous requests that have not started decoding
+     */
+    void cancelThumbnailRequests();
+
     /**
      * @brief Preload thumbnails for multiple images
      * @param imagePaths List of image paths to preload
@@ -38,6 +74,37 @@ public:
      */
     void preloadThumbnails(const QStringList &imagePaths, int size = 120);
 
+    /**
+     * @brief Outcome of warming one image
+     */
+    enum class WarmResult {
+        Cached,                      ///< Pyramid is cached on disk
+        Failed,                      ///< Source could not be decoded
+        Deferred                     ///< Source volume at its I/O limit; retry later
+    };
+
+    /**
+     * @brief Generate the disk cache pyramid for an image if missing
+     *
+     * Thread-safe: touches only the disk cache and its (locked) index,
+     * never the memory cache, so it can run on background threads. Never
+     * waits for an I/O permit; the caller requeues deferred images.
+     * @param imagePath Path to the source image
+     * @return Whether the pyramid is cached, failed or must be retried
+     */
+    WarmResult warmThumbnail(const QString &imagePath);
+
+    /**
+     * @brief Generate the disk cache pyramid from already-read file contents
+     *
+     * Used by single-pass ingestion so the source file is not read again.
+     * Thread-safe under the same rules as warmThumbnail().
+     * @param imagePath Path to the source image (used for the cache key)
+     * @param contents Complete contents of the source file
+     * @return True if the pyramid is cached on disk
+     */
+    bool ingestThumbnail(const QString &imagePath, const QByteArray &contents);
+
     // === Cache Management ===
 
     /**
@@ -57,6 +124,12 @@ public:
      */
     void setMaxMemoryCache(int maxItems);
 
+    /**
+     * @brief Set budget of the compressed in-memory cache tier
+     * @param maxSizeMB Maximum encoded bytes to keep, in megabytes
+     */
+    void setMaxCompressedCacheSize(int maxSizeMB);
+
     /**
      * @brief Set maximum disk cache size
      * @param maxSizeMB Maximum cache size in megabytes
@@ -85,6 +158,18 @@ public:
      */
     int memoryCacheSize() const { return m_memoryCache.size(); }
 
+    /**
+     * @brief Get number of thumbnails in the compressed memory tier
+     * @return Number of cached items
+     */
+    int compressedCacheSize() const { return m_compressedCache.count(); }
+
+    /**
+     * @brief Get encoded bytes held by the compressed memory tier
+     * @return Size in bytes
+     */
+    qint64 compressedCacheBytes() const { return m_compressedCache.totalCost(); }
+
     /**
      * @brief Get cache directory path
      * @return Path to cache directory
@@ -92,7 +177,7 @@ public:
     QString cacheDirectory() const { return m_cacheDirectory; }
 
     /**
-     * @brief Calculate total disk cache size
+     * @brief Get total disk cache size tracked by the cache index
      * @return Cache size in bytes
      */
     qint64 diskCacheSize() const;
@@ -119,28 +204,127 @@ signals:
 
 private slots:
     /**
-     * @brief Periodic cleanup of old cache files
+     * @brief Periodic check of the disk cache budget; starts eviction if exceeded
      */
     void cleanupOldCache();
 
+    /**
+     * @brief Queue the next eviction step as a maintenance task
+     */
+    void evictionStep();
+
 private:
+    /**
+     * @brief Queue the decode of an asynchronous request
+     * @param imagePath Path to the source image
+     * @param size Requested thumbnail size
+     * @param priority Scheduler class for the decode
+     * @param generation Request generation the request belongs to
+     */
+    void dispatchThumbnailRequest(const QString &imagePath, int size,
+                                  TaskScheduler::Priority priority, int generation);
+
+    /**
+     * @brief Generate a thumbnail larger than the pyramid into the disk cache
+     *
+     * Thread-safe like warmThumbnail().
+     * @param imagePath Path to the source image
+     * @param size Thumbnail size (above the largest pyramid level)
+     * @return Whether the thumbnail is cached, failed or must be retried
+     */
+    WarmResult warmLargeThumbnail(const QString &imagePath, int size);
+
+    /**
+     * @brief Deliver a finished asynchronous request (service thread)
+     * @param imagePath Path to the source image
+     * @param warmed True if the pyramid was generated
+     */
+    void finishThumbnailRequest(const QString &imagePath, bool warmed);
+
+    /**
+     * @brief Evict a small number of least recently used disk cache entries
+     * @return True once the cache is below the low-water mark
+     */
+    bool evictDiskEntries();
+
     // === Cache Operations ===
 
     /**
-     * @brief Generate unique cache key for image and size
+     * @brief Generate key identifying the source file version
      * @param imagePath Source image path
+     * @return Key built from file name, size and modification time
+     */
+    QString getSourceKey(const QString &imagePath) const;
+
+    /**
+     * @brief Generate unique cache key for a source and size
+     * @param sourceKey Source key from getSourceKey()
      * @param size Thumbnail size
      * @return Unique cache key
      */
-    QString getCacheKey(const QString &imagePath, int size) const;
+    QString getCacheKey(const QString &sourceKey, int size) const;
+
+    /**
+     * @brief Find the smallest pyramid level that can serve a size
+     * @param size Requested thumbnail size
+     * @return Pyramid level size in pixels
+     */
+    int pyramidLevelFor(int size) const;
+
+    /**
+     * @brief Get a pyramid level, generating the whole pyramid if missing
+     * @param imagePath Source image path
+     * @param sourceKey Source key from getSourceKey()
+     * @param level Pyramid level size
+     * @param created Set to true if the source had to be decoded
+     * @return Level thumbnail or null pixmap if failed
+     */
+    QPixmap loadPyramidLevel(const QString &imagePath, const QString &sourceKey,
+                             int level, bool &created);
+
+    /**
+     * @brief Decode source once and build all pyramid levels
+     * @param imagePath Source image path
+     * @return Level images ordered smallest first, or empty list if failed
+     */
+    QList<QImage> createThumbnailPyramid(const QString &imagePath) const;
+
+    /**
+     * @brief Decode and build all pyramid levels from a prepared reader
+     * @param reader Reader on the source image
+     * @param imagePath Source image path (for diagnostics)
+     * @return Level images ordered smallest first, or empty list if failed
+     */
+    QList<QImage> createThumbnailPyramid(QImageReader &reader, const QString &imagePath) const;
 
     /**
-     * @brief Create thumbnail from source image
+     * @brief Check if all pyramid levels of a source are on disk
+     * @param sourceKey Source identity key
+     * @return True if every level is in the disk index
+     */
+    bool isPyramidCached(const QString &sourceKey) const;
+
+    /**
+     * @brief Check if a thumbnail is on disk
+     * @param cacheKey Cache key
+     * @return True if the key is in the disk index
+     */
+    bool isDiskCached(const QString &cacheKey) const;
+
+    /**
+     * @brief Write all pyramid levels of a source to the disk cache
+     * @param sourceKey Source identity key
+     * @param pyramid Level images ordered smallest first
+     */
+    void savePyramidToDiskCache(const QString &sourceKey, const QList<QImage> &pyramid);
+
+    /**
+     * @brief Create thumbnail directly from source image
      * @param imagePath Source image path
      * @param size Thumbnail size
      * @return Generated thumbnail
      */
-    QPixmap createThumbnail(const QString &imagePath, int size);
+    QImage createThumbnail(const QString &imagePath, int size) const;
 
     /**
      * @brief Get full path for disk cache file
@@ -154,20 +338,62 @@ private:
      * @param cacheKey Cache key
      * @return Cached thumbnail or null if not found
      */
-    QPixmap loadFromDiskCache(const QString &cacheKey) const;
+    QPixmap loadFromDiskCache(const QString &cacheKey);
 
     /**
      * @brief Save thumbnail to disk cache
      * @param cacheKey Cache key
      * @param thumbnail Thumbnail to save
      */
-    void saveToDiskCache(const QString &cacheKey, const QPixmap &thumbnail);
+    void saveToDiskCache(const QString &cacheKey, const QImage &thumbnail);
 
     /**
      * @brief Clean up memory cache when it exceeds limits
+     *
+     * Evicted pixmaps are demoted to the compressed tier.
      */
     void cleanupMemoryCache();
 
+    /**
+     * @brief Look up a thumbnail in the pixmap and compressed memory tiers
+     * @param cacheKey Cache key
+     * @return Cached thumbnail (promoted to the pixmap tier) or null pixmap
+     */
+    QPixmap loadFromMemoryCache(const QString &cacheKey);
+
+    /**
+     * @brief Encode a thumbnail into the compressed memory tier
+     * @param cacheKey Cache key
+     * @param thumbnail Thumbnail leaving the pixmap tier
+     */
+    void demoteToCompressedCache(const QString &cacheKey, const QPixmap &thumbnail);
+
+    /**
+     * @brief Get the bytes held by decoded pixmaps
+     * @return Memory used by the pixmap tier
+     */
+    qint64 memoryCacheBytes() const;
+
+    /**
+     * @brief Demote pixmaps to the compressed tier (memory governor callback)
+     * @param bytes Bytes to free
+     * @return Bytes of pixmaps released, less the growth of the compressed tier
+     */
+    qint64 evictMemoryCache(qint64 bytes);
+
+    /**
+     * @brief Drop least recently used compressed thumbnails (memory governor callback)
+     * @param bytes Bytes to free
+     * @return Bytes released
+     */
+    qint64 evictCompressedCache(qint64 bytes);
+
+    /**
+     * @brief Pick the encoding used by the compressed tier
+     * @return "webp" if supported, otherwise "jpg"
+     */
+    static QByteArray selectCompressedFormat();
+
     /**
      * @brief Initialize cache directory structure
      */
@@ -183,14 +409,89 @@ private:
      */
     void clearDiskCache();
 
+    // === Disk Cache Index ===
+
+    /**
+     * @brief Disk cache index entry
+     */
+    struct DiskCacheEntry {
+        qint64 bytes;                ///< Size of the cache file
+        bool referenced;             ///< CLOCK bit: accessed since the hand last passed
+    };
+
+    /**
+     * @brief Get the disk cache budget
+     * @return Maximum disk cache size in bytes
+     */
+    qint64 maxDiskCacheBytes() const;
+
+    /**
+     * @brief Mark a disk cache entry as recently used
+     * @param cacheKey Cache key
+     */
+    void touchDiskEntry(const QString &cacheKey);
+
+    /**
+     * @brief Add or update a disk cache entry after writing its file
+     * @param cacheKey Cache key
+     * @param bytes Size of the written file
+     */
+    void recordDiskEntry(const QString &cacheKey, qint64 bytes);
+
+    /**
+     * @brief Drop a disk cache entry whose file is gone or unusable
+     * @param cacheKey Cache key
+     */
+    void forgetDiskEntry(const QString &cacheKey);
+
+    /**
+     * @brief Remove tombstones from the clock ring once they dominate it
+     */
+    void compactClockRing();
+
+    /**
+     * @brief Load the persisted index and reconcile it with the cache directory
+     */
+    void loadDiskIndex();
+
+    /**
+     * @brief Persist the index (sizes, access bits and clock position)
+     */
+    void saveDiskIndex();
+
     // === Data Members ===
 
     QHash<QString, QPixmap> m_memoryCache;    ///< In-memory thumbnail cache
+    QCache<QString, QByteArray> m_compressedCache; ///< Encoded thumbnails, cost in bytes
     QString m_cacheDirectory;                 ///< Disk cache directory path
     int m_maxMemoryCache;                     ///< Maximum items in memory cache
     int m_maxDiskCacheSizeMB;                ///< Maximum disk cache size (MB)
+    QByteArray m_compressedFormat;           ///< Encoding of the compressed tier
     int m_defaultThumbnailSize;              ///< Default thumbnail size
     QTimer *m_cleanupTimer;                  ///< Timer for periodic cache cleanup
+    QTimer *m_evictionTimer;                 ///< Timer driving incremental eviction steps
+
+    // === Disk Cache Index (guarded by m_diskIndexMutex) ===
+
+    mutable QMutex m_diskIndexMutex;          ///< Guards index state (warmer writes from a worker)
+    QHash<QString, DiskCacheEntry> m_diskIndex; ///< Cache key -> entry
+    QList<QString> m_clockRing;               ///< Keys in clock order (empty string = tombstone)
+    qint64 m_diskCacheBytes;                  ///< Total size of indexed cache files
+    int m_clockHand;                          ///< Current clock hand position
+    int m_clockTombstones;                    ///< Number of dead ring slots
+    bool m_diskIndexDirty;                    ///< Index changed since last save
+    QAtomicInt m_evictionRequested;           ///< Eviction check already queued
+    QAtomicInt m_evictionInFlight;            ///< Eviction step queued or running
+
+    // === Asynchronous Requests ===
+
+    QHash<QString, int> m_pendingRequests;    ///< Image path -> requested size
+    QAtomicInt m_requestGeneration;           ///< Bumped to cancel queued requests
+
+    // === Memory Budget ===
+
+    int m_pixmapConsumerId;                   ///< MemoryGovernor ID of the pixmap tier
+    int m_compressedConsumerId;               ///< MemoryGovernor ID of the compressed tier
 };
 
 #endif // THUMBNAILSERVICE_H
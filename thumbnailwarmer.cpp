@@ -0,0 +1,198 @@
+#include "thumbnailwarmer.h"
+#include "thumbnailservice.h"
+#include "projectmanager.h"
+#include "taskscheduler.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QTimer>
+#include <QDebug>
+
+// === Constants ===
+namespace {
+const QString CURSOR_KEY = "thumbnail_warmer_cursor";
+
+constexpr int BATCH_SIZE = 200;
+constexpr int CURSOR_SAVE_INTERVAL = 50;
+constexpr int PROGRESS_UPDATE_INTERVAL = 10;
+constexpr int STEP_DELAY_MS = 0;
+constexpr int PERMIT_RETRY_MS = 20;      // Requeue delay while the volume is at its I/O limit
+constexpr int USER_IDLE_MS = 1500;       // Pause while input is more recent than this
+constexpr int IDLE_RECHECK_MS = 500;
+}
+
+// === Constructor & Destructor ===
+
+ThumbnailWarmer::ThumbnailWarmer(ThumbnailService *thumbnailService,
+                                 ProjectManager *projectManager,
+                                 QObject *parent)
+    : QObject(parent)
+    , m_thumbnailService(thumbnailService)
+    , m_projectManager(projectManager)
+    , m_cursor(0)
+    , m_inFlight(0, QString())
+    , m_warmedCount(0)
+    , m_running(false)
+{
+    m_stepTimer = new QTimer(this);
+    m_stepTimer->setSingleShot(true);
+    connect(m_stepTimer, &QTimer::timeout, this, &ThumbnailWarmer::processNext);
+    connect(&m_watcher, &QFutureWatcher<ThumbnailService::WarmResult>::finished,
+            this, &ThumbnailWarmer::onItemFinished);
+
+    m_lastInteraction.start();
+    QCoreApplication::instance()->installEventFilter(this);
+}
+
+ThumbnailWarmer::~ThumbnailWarmer()
+{
+    m_running = false;
+    m_watcher.waitForFinished();
+}
+
+// === Control ===
+
+void ThumbnailWarmer::start()
+{
+    if (m_running || !m_projectManager || !m_projectManager->hasOpenProject()) {
+        return;
+    }
+
+    m_running = true;
+    m_warmedCount = 0;
+    m_batch.clear();
+    m_cursor = m_projectManager->getProjectValue(CURSOR_KEY, 0).toInt();
+
+    qDebug() << "Thumbnail warmer starting after record" << m_cursor;
+    scheduleNext(IDLE_RECHECK_MS);
+}
+
+void ThumbnailWarmer::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_running = false;
+    m_stepTimer->stop();
+    m_batch.clear();
+
+    // The in-flight image only touches the disk cache; let it finish on its own
+    saveCursor();
+}
+
+// === Event Filter ===
+
+bool ThumbnailWarmer::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+        m_lastInteraction.restart();
+        break;
+    default:
+        break;
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
+// === Private Slots ===
+
+void ThumbnailWarmer::processNext()
+{
+    if (!m_running || m_watcher.isRunning()) {
+        return;
+    }
+
+    if (!isUserIdle()) {
+        scheduleNext(IDLE_RECHECK_MS);
+        return;
+    }
+
+    if (m_batch.isEmpty()) {
+        fetchNextBatch();
+    }
+
+    if (m_batch.isEmpty()) {
+        m_running = false;
+        saveCursor();
+        qDebug() << "Thumbnail warmer finished:" << m_warmedCount << "images";
+        emit warmingFinished(m_warmedCount);
+        return;
+    }
+
+    m_inFlight = m_batch.takeFirst();
+
+    ThumbnailService *service = m_thumbnailService;
+    const QString imagePath = m_inFlight.second;
+    m_watcher.setFuture(TaskScheduler::instance()->run(TaskScheduler::Priority::Background,
+                                                       [service, imagePath]() {
+        return service->warmThumbnail(imagePath);
+    }));
+}
+
+void ThumbnailWarmer::onItemFinished()
+{
+    // The volume was at its I/O limit: nothing was read, try the image again
+    const QFuture<ThumbnailService::WarmResult> future = m_watcher.future();
+    if (future.resultCount() > 0 && future.result() == ThumbnailService::WarmResult::Deferred) {
+        if (m_running) {
+            m_batch.prepend(m_inFlight);
+            scheduleNext(PERMIT_RETRY_MS);
+        }
+        return;
+    }
+
+    // Advance even on failure so unreadable files are not retried forever
+    m_cursor = m_inFlight.first;
+    m_warmedCount++;
+
+    if (!m_running) {
+        return;
+    }
+
+    if (m_warmedCount % CURSOR_SAVE_INTERVAL == 0) {
+        saveCursor();
+    }
+
+    if (m_warmedCount % PROGRESS_UPDATE_INTERVAL == 0) {
+        emit warmingProgress(m_warmedCount);
+    }
+
+    scheduleNext(STEP_DELAY_MS);
+}
+
+// === Private Methods ===
+
+void ThumbnailWarmer::fetchNextBatch()
+{
+    if (!m_projectManager->hasOpenProject()) {
+        return;
+    }
+
+    const QList<ProjectManager::ImageRecord> records =
+        m_projectManager->getImagesAfter(m_cursor, BATCH_SIZE);
+
+    for (const ProjectManager::ImageRecord &record : records) {
+        m_batch.append(qMakePair(record.id, record.filePath));
+    }
+}
+
+void ThumbnailWarmer::saveCursor()
+{
+    if (m_projectManager && m_projectManager->hasOpenProject()) {
+        m_projectManager->setProjectValue(CURSOR_KEY, m_cursor);
+    }
+}
+
+void ThumbnailWarmer::scheduleNext(int delayMs)
+{
+    m_stepTimer->start(delayMs);
+}
+
+bool ThumbnailWarmer::isUserIdle() const
+{
+    return m_lastInteraction.elapsed() >= USER_IDLE_MS;
+}
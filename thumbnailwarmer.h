@@ -0,0 +1,136 @@
+#ifndef THUMBNAILWARMER_H
+#define THUMBNAILWARMER_H
+
+#include <QObject>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include "thumbnailservice.h"
+
+class QTimer;
+class ProjectManager;
+
+/**
+ * @brief Background pre-generation of thumbnails for catalog images
+ *
+ * Walks newly imported or modified catalog rows and generates their
+ * thumbnail pyramids as Background tasks on the TaskScheduler:
+ * - One image in flight at a time, behind any interactive request
+ * - Pauses while the user interacts with the application
+ * - Resumes from a cursor persisted in the project catalog
+ */
+class ThumbnailWarmer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThumbnailWarmer(ThumbnailService *thumbnailService,
+                             ProjectManager *projectManager,
+                             QObject *parent = nullptr);
+    ~ThumbnailWarmer();
+
+    // === Control ===
+
+    /**
+     * @brief Start or resume warming from the persisted cursor
+     */
+    void start();
+
+    /**
+     * @brief Stop warming and persist the cursor
+     */
+    void stop();
+
+    // === Information ===
+
+    /**
+     * @brief Check if the warmer is active
+     * @return True if warming is in progress (possibly paused)
+     */
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief Get number of images warmed in the current run
+     * @return Number of processed images
+     */
+    int warmedCount() const { return m_warmedCount; }
+
+signals:
+    /**
+     * @brief Emitted periodically while warming
+     * @param warmed Number of images processed in the current run
+     */
+    void warmingProgress(int warmed);
+
+    /**
+     * @brief Emitted when all catalog rows have been warmed
+     * @param warmed Number of images processed in the current run
+     */
+    void warmingFinished(int warmed);
+
+protected:
+    /**
+     * @brief Track user input to pause warming during interaction
+     * @param watched Object receiving the event
+     * @param event Event being delivered
+     * @return Always false (events are never consumed)
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    /**
+     * @brief Dispatch the next image if the user is idle
+     */
+    void processNext();
+
+    /**
+     * @brief Handle completion of the in-flight image
+     */
+    void onItemFinished();
+
+private:
+    /**
+     * @brief Load the next batch of rows after the cursor
+     */
+    void fetchNextBatch();
+
+    /**
+     * @brief Persist the cursor in the project catalog
+     */
+    void saveCursor();
+
+    /**
+     * @brief Schedule the next processing step
+     * @param delayMs Delay before the step
+     */
+    void scheduleNext(int delayMs);
+
+    /**
+     * @brief Check if the user has been idle long enough
+     * @return True if no recent input was seen
+     */
+    bool isUserIdle() const;
+
+    // === Services ===
+
+    ThumbnailService *m_thumbnailService;   ///< Thumbnail generation service
+    ProjectManager *m_projectManager;       ///< Catalog access
+
+    // === Worker ===
+
+    QFutureWatcher<ThumbnailService::WarmResult> m_watcher; ///< Watches the in-flight image
+    QTimer *m_stepTimer;                    ///< Drives processing steps
+
+    // === State ===
+
+    QList<QPair<int, QString>> m_batch;     ///< Pending (record ID, path) pairs
+    QElapsedTimer m_lastInteraction;        ///< Time since last user input
+    int m_cursor;                           ///< Last fully processed record ID
+    QPair<int, QString> m_inFlight;         ///< (Record ID, path) currently being warmed
+    int m_warmedCount;                      ///< Images processed in current run
+    bool m_running;                         ///< True while warming is active
+};
+
+#endif // THUMBNAILWARMER_H
@@ -1,4 +1,5 @@
 #include "zoomableimagelabel.h"
+#include "memorygovernor.h"
 #include <QScrollArea>
 #include <QScrollBar>
 #include <QApplication>
@@ -9,29 +10,45 @@ namespace {
 constexpr int MIN_WIDGET_SIZE = 300;
 const QString DEFAULT_TEXT = "Select an image";
 const QString BACKGROUND_STYLE = "background-color: white;";
+
+constexpr double PIXMAP_MEMORY_WEIGHT = 4.0;
 }
 
 // === Constructor ===
 
 ZoomableImageLabel::ZoomableImageLabel(QWidget *parent)
     : QLabel(parent)
+    , m_memoryConsumerId(0)
     , m_scaleFactor(1.0)
     , m_dragging(false)
     , m_scrollArea(nullptr)
 {
     setupWidget();
     findScrollArea();
+
+    m_memoryConsumerId = MemoryGovernor::instance()->registerConsumer(
+        "Image viewer", PIXMAP_MEMORY_WEIGHT,
+        [this]() { return pixmapBytes(); },
+        [this](qint64 bytes) { return reduceOriginalPixmap(bytes); });
+}
+
+ZoomableImageLabel::~ZoomableImageLabel()
+{
+    MemoryGovernor::instance()->unregisterConsumer(m_memoryConsumerId);
 }
 
 // === Public Methods ===
 
-void ZoomableImageLabel::setImagePixmap(const QPixmap &pixmap)
+void ZoomableImageLabel::setImagePixmap(const QPixmap &pixmap, const QString &sourcePath)
 {
     m_originalPixmap = pixmap;
+    m_sourcePath = sourcePath;
+    m_imageSize = pixmap.size();
     m_scaleFactor = 1.0;
 
     if (hasImage()) {
         fitToWindow();
+        MemoryGovernor::instance()->notifyGrowth();
     } else {
         clearDisplay();
     }
@@ -60,7 +77,7 @@ void ZoomableImageLabel::fitToWindow()
     }
 
     const QSize availableSize = m_scrollArea->viewport()->size();
-    const QSize imageSize = m_originalPixmap.size();
+    const QSize imageSize = m_imageSize;
 
     // Calculate scale factor to fit image within available space
     const double scaleX = static_cast<double>(availableSize.width()) / imageSize.width();
@@ -168,13 +185,22 @@ void ZoomableImageLabel::updateDisplayedImage()
         return;
     }
 
-    if (qFuzzyCompare(m_scaleFactor, 1.0)) {
-        // Show original image at 100% scale
+    const QSize newSize = qFuzzyCompare(m_scaleFactor, 1.0) ? m_imageSize
+                                                             : m_imageSize * m_scaleFactor;
+    if (m_originalPixmap.isNull()) {
+        if (newSize == pixmap().size()) {
+            resize(newSize);
+            return;
+        }
+        reloadOriginalPixmap();
+    }
+
+    if (newSize == m_originalPixmap.size()) {
+        // Show the held pixmap as is
         setPixmap(m_originalPixmap);
-        resize(m_originalPixmap.size());
+        resize(newSize);
     } else {
         // Scale the image
-        const QSize newSize = m_originalPixmap.size() * m_scaleFactor;
         const QPixmap scaledPixmap = m_originalPixmap.scaled(
             newSize,
             Qt::KeepAspectRatio,
@@ -186,8 +212,49 @@ void ZoomableImageLabel::updateDisplayedImage()
     }
 }
 
+qint64 ZoomableImageLabel::pixmapBytes() const
+{
+    const QPixmap displayed = pixmap();
+    qint64 bytes = qint64(m_originalPixmap.width()) * m_originalPixmap.height() *
+                   m_originalPixmap.depth() / 8;
+
+    // Displaying at the held size shares the original's data
+    if (displayed.cacheKey() != m_originalPixmap.cacheKey()) {
+        bytes += qint64(displayed.width()) * displayed.height() * displayed.depth() / 8;
+    }
+    return bytes;
+}
+
+qint64 ZoomableImageLabel::reduceOriginalPixmap(qint64 bytes)
+{
+    Q_UNUSED(bytes)
+
+    // Keep what is on screen; the next zoom reloads the full image. An image
+    // shown at its own size shares the original's data, so nothing is freed.
+    if (m_originalPixmap.isNull() || m_sourcePath.isEmpty() ||
+        pixmap().cacheKey() == m_originalPixmap.cacheKey()) {
+        return 0;
+    }
+
+    const qint64 before = pixmapBytes();
+    m_originalPixmap = QPixmap();
+    return qMax<qint64>(0, before - pixmapBytes());
+}
+
+void ZoomableImageLabel::reloadOriginalPixmap()
+{
+    m_originalPixmap = QPixmap(m_sourcePath);
+    if (m_originalPixmap.isNull()) {
+        // The file is gone; keep zooming from what is displayed
+        m_originalPixmap = pixmap();
+        m_sourcePath.clear();
+    }
+    MemoryGovernor::instance()->notifyGrowth();
+}
+
 void ZoomableImageLabel::clearDisplay()
 {
+    m_imageSize = QSize();
     setPixmap(QPixmap());
     setText(DEFAULT_TEXT);
     resize(minimumSize());
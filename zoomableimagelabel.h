@@ -22,14 +22,17 @@ class ZoomableImageLabel : public QLabel
 
 public:
     explicit ZoomableImageLabel(QWidget *parent = nullptr);
+    ~ZoomableImageLabel();
 
     // === Image Display ===
 
     /**
      * @brief Set the image to display
      * @param pixmap Image pixmap to display
+     * @param sourcePath File the pixmap was loaded from; lets the original be
+     *        dropped under memory pressure and reloaded when the zoom changes
      */
-    void setImagePixmap(const QPixmap &pixmap);
+    void setImagePixmap(const QPixmap &pixmap, const QString &sourcePath = QString());
 
     /**
      * @brief Reset zoom to 100% (1:1 scale)
@@ -53,7 +56,7 @@ public:
      * @brief Check if an image is currently loaded
      * @return True if image is loaded
      */
-    bool hasImage() const { return !m_originalPixmap.isNull(); }
+    bool hasImage() const { return !m_imageSize.isEmpty(); }
 
 signals:
     /**
@@ -135,9 +138,32 @@ private:
      */
     void stopPanning();
 
+    // === Memory Budget ===
+
+    /**
+     * @brief Get the memory held by the original and displayed pixmaps
+     * @return Bytes held
+     */
+    qint64 pixmapBytes() const;
+
+    /**
+     * @brief Drop the original pixmap while a scaled copy is displayed
+     * @param bytes Bytes the memory governor asks for
+     * @return Bytes freed
+     */
+    qint64 reduceOriginalPixmap(qint64 bytes);
+
+    /**
+     * @brief Load the dropped original pixmap again from its file
+     */
+    void reloadOriginalPixmap();
+
     // === Data Members ===
 
-    QPixmap m_originalPixmap;        ///< Original full-size image
+    QPixmap m_originalPixmap;        ///< Original image (dropped under memory pressure)
+    QString m_sourcePath;            ///< File the original is reloaded from
+    QSize m_imageSize;               ///< True size of the image, used for zoom levels
+    int m_memoryConsumerId;          ///< Memory governor registration
     double m_scaleFactor;            ///< Current zoom level (1.0 = 100%)
     bool m_dragging;                 ///< True when panning is active
     QPoint m_lastPanPoint;           ///< Last mouse position during pan